@@ -112,10 +112,14 @@ void Engine::run() {
         Engine::lastTime = Engine::currentTime;
         Engine::currentTime = Device::getTicks();
 
+        Resource::update();
+
         Device::refreshWindows();
 
         ModuleRegistry::updateAll();
 
+        Resource::collectGarbage();
+
     } while (!Device::isWindowAboutToBeDestroyed(Engine::mainWindow));
 
     LOG_ENGINE.info("Exiting...");
@@ -4,6 +4,10 @@ if(APPLE)
     list(APPEND CHIRA_ENGINE_LINK_LIBRARIES ${CORE_LIB})
 endif()
 
+# Resource loader threads
+find_package(Threads REQUIRED)
+list(APPEND CHIRA_ENGINE_LINK_LIBRARIES Threads::Threads)
+
 # Basic ImGui sources
 list(APPEND IMGUI_HEADERS
         ${CMAKE_CURRENT_LIST_DIR}/thirdparty/imgui/imconfig.h
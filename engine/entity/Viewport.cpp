@@ -1,5 +1,9 @@
 #include "Viewport.h"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
 #include <core/Assertions.h>
 #include <render/shader/UBO.h>
 #include <utility/Types.h>
@@ -15,6 +19,27 @@
 
 using namespace chira;
 
+namespace {
+
+/// How many pixels tall the radius of a sphere is on screen.
+float getProjectedRadius(const CameraComponent& camera, glm::vec2i size, glm::vec3 center, float radius) {
+    switch (camera.projectionMode) {
+        using enum CameraComponent::ProjectionMode;
+        case PERSPECTIVE: {
+            const auto distance = glm::length(center - camera.transform->getPosition());
+            // The camera is inside it
+            if (distance <= radius)
+                return std::numeric_limits<float>::max();
+            return radius / (distance * std::tan(glm::radians(camera.fov) / 2)) * static_cast<float>(size.y) / 2;
+        }
+        case ORTHOGRAPHIC:
+            return radius / camera.orthoSize * static_cast<float>(size.y);
+        CHIRA_NO_DEFAULT;
+    }
+}
+
+} // namespace
+
 Viewport::Viewport(glm::vec2i size_, ColorRGB backgroundColor_, bool linearFiltering_)
         : size(size_)
         , backgroundColor(backgroundColor_)
@@ -134,42 +159,65 @@ void Viewport::render() {
     LightsUBO::get().update(directionalLightComponentArray, pointLightComponentArray, spotLightComponentArray,
                             {directionalLightsCount, pointLightsCount, spotLightsCount});
 
+    // Collect every mesh, then draw them sorted by layer, scene and state
+    std::vector<Scene*> views;
+    for (const auto& [uuid, scene] : this->scenes) {
+        views.push_back(scene.get());
+    }
+    auto* camera = this->getCamera();
+    const auto getDepth = [camera](glm::vec3 position) {
+        return camera ? glm::length(position - camera->transform->getPosition()) : 0.f;
+    };
+    this->renderQueue.clear();
     foreach(LAYER_COMPONENTS, [&](auto layer) {
-        if (!(this->getCamera()->activeLayers & layer.index)) {
+        if (!(camera->activeLayers & layer.index)) {
             return;
         }
 
         using CurrentLayer = decltype(layer);
-        for (const auto& [uuid, scene] : this->scenes) {
+        const auto layerIndex = static_cast<unsigned int>(std::countr_zero(layer.index));
+        for (unsigned int view = 0; view < views.size(); view++) {
+            auto* scene = views[view];
             auto& registry = scene->getRegistry();
 
-            // Set up camera
-            scene->setupForRender(this->size);
-
+            // Add MeshComponent, picking an LOD from how big the mesh is on screen
             auto meshView = scene->template getEntities<MeshComponent, CurrentLayer>(entt::exclude<NoRenderTagComponent>);
             for (auto entity : meshView) {
                 auto& transformComponent = registry.template get<TransformComponent>(entity);
                 auto& meshComponent = registry.template get<MeshComponent>(entity);
-                meshComponent.mesh->render(transformComponent.getMatrix());
+                const auto model = transformComponent.getMatrix();
+                const glm::vec3 center{model * glm::vec4{meshComponent.mesh->getBoundingCenter(), 1.f}};
+                std::size_t lod = 0;
+                if (camera && !meshComponent.mesh->getLODs().empty()) {
+                    const auto scale = std::max({glm::length(glm::vec3{model[0]}), glm::length(glm::vec3{model[1]}), glm::length(glm::vec3{model[2]})});
+                    lod = meshComponent.mesh->selectLOD(getProjectedRadius(*camera, this->size, center, meshComponent.mesh->getBoundingRadius() * scale));
+                }
+                this->renderQueue.add(layerIndex, view, meshComponent.mesh.get(), model, lod, getDepth(center));
             }
 
-            // Render MeshDynamicComponent
+            // Add MeshDynamicComponent
             auto meshDynamicView = scene->template getEntities<MeshDynamicComponent, CurrentLayer>(entt::exclude<NoRenderTagComponent>);
             for (auto entity : meshDynamicView) {
                 auto& transformComponent = registry.template get<TransformComponent>(entity);
                 auto& meshDynamicComponent = registry.template get<MeshDynamicComponent>(entity);
-                meshDynamicComponent.meshBuilder.render(transformComponent.getMatrix());
+                const auto model = transformComponent.getMatrix();
+                this->renderQueue.add(layerIndex, view, &meshDynamicComponent.meshBuilder, model, 0, getDepth(glm::vec3{model[3]}));
             }
 
-            // Render MeshSpriteComponent
+            // Add MeshSpriteComponent
             auto meshSpriteView = scene->template getEntities<MeshSpriteComponent, CurrentLayer>(entt::exclude<NoRenderTagComponent>);
             for (auto entity : meshSpriteView) {
                 auto& transformComponent = registry.template get<TransformComponent>(entity);
                 auto& meshSpriteComponent = registry.template get<MeshSpriteComponent>(entity);
-                meshSpriteComponent.sprite.render(transformComponent.getMatrix());
+                const auto model = transformComponent.getMatrix();
+                this->renderQueue.add(layerIndex, view, &meshSpriteComponent.sprite, model, 0, getDepth(glm::vec3{model[3]}));
             }
         }
     });
+    this->renderQueue.submit([&views, this](unsigned int view) {
+        // Set up camera
+        views[view]->setupForRender(this->size);
+    });
 
     // Render scenes
     for (const auto& [uuid, scene] : this->scenes) {
@@ -179,6 +227,8 @@ void Viewport::render() {
         auto skyboxView = registry.view<SkyboxComponent>();
         if (!skyboxView.empty()) {
             auto& skyboxComponent = skyboxView.get<SkyboxComponent>(skyboxView.front());
+            // The render queue only set up scenes that had meshes to draw
+            scene->setupForRender(this->size);
             skyboxComponent.skybox.render(glm::identity<glm::mat4>());
         }
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <render/backend/RenderBackend.h>
+#include <render/RenderQueue.h>
 #include "Scene.h"
 
 namespace chira {
@@ -68,6 +69,11 @@ public:
         this->recreateFrameBuffer();
     }
 
+    /// Draw calls and state changes of the last render.
+    [[nodiscard]] const RenderQueueStatistics& getRenderStatistics() const {
+        return this->renderQueue.getStatistics();
+    }
+
     [[nodiscard]] Renderer::FrameBufferHandle* getRawHandle() {
         return &this->frameBufferHandle;
     }
@@ -77,6 +83,8 @@ private:
 
 private:
     std::unordered_map<uuids::uuid, std::unique_ptr<Scene>> scenes;
+    /// Kept between frames so its memory is reused
+    RenderQueue renderQueue;
     Renderer::FrameBufferHandle frameBufferHandle;
     glm::vec2i size;
     ColorRGB backgroundColor;
@@ -16,6 +16,9 @@ Image::Image(std::string identifier_, bool vFlip)
     , verticalFlip(vFlip) {}
 
 void Image::compile(const byte buffer[], std::size_t bufferLen) {
+    if (this->image) {
+        stbi_image_free(this->image);
+    }
     int w, h, bd;
     this->image = Image::getUncompressedImage(buffer, static_cast<int>(bufferLen) - 1, &w, &h, &bd, 0, this->isVerticallyFlipped());
     this->width = w;
@@ -24,7 +27,8 @@ void Image::compile(const byte buffer[], std::size_t bufferLen) {
 }
 
 byte* Image::getUncompressedImage(const byte buffer[], int bufferLen, int* width, int* height, int* fileChannels, int desiredChannels, bool vflip) {
-    stbi_set_flip_vertically_on_load(vflip);
+    // Flip state is thread-local so images can be decoded on resource loader threads
+    stbi_set_flip_vertically_on_load_thread(vflip);
     return stbi_load_from_memory(buffer, bufferLen, width, height, fileChannels, desiredChannels);
 }
 
@@ -34,7 +38,7 @@ byte* Image::getUncompressedImage(const byte buffer[], int bufferLen, int desire
 }
 
 byte* Image::getUncompressedImage(std::string_view filepath, int* width, int* height, int* fileChannels, int desiredChannels, bool vflip) {
-    stbi_set_flip_vertically_on_load(vflip);
+    stbi_set_flip_vertically_on_load_thread(vflip);
     return stbi_load(filepath.data(), width, height, fileChannels, desiredChannels);
 }
 
@@ -15,6 +15,12 @@ public:
     Image& operator=(Image&& other) noexcept = default;
 
     void compile(const byte buffer[], std::size_t bufferLen) override;
+    [[nodiscard]] bool supportsAsyncCompile() const override {
+        return true;
+    }
+    [[nodiscard]] ResourceMemoryUsage getMemoryUsage() const override {
+        return {this->image ? static_cast<std::size_t>(this->width) * this->height * this->bitDepth : 0, 0};
+    }
     [[nodiscard]] inline byte* getData() const {
         return this->image;
     }
@@ -44,6 +50,7 @@ protected:
     bool verticalFlip = true;
 private:
     CHIRA_REGISTER_DEFAULT_RESOURCE(Image, "file://textures/missing.png");
+    CHIRA_REGISTER_RESOURCE_TYPE(Image);
 };
 
 } // namespace chira
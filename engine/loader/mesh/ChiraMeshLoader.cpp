@@ -1,7 +1,10 @@
 #include "ChiraMeshLoader.h"
 
 #include <cstring>
+#include <cmath>
+#include <cstddef>
 #include <algorithm>
+#include <glm/gtc/packing.hpp>
 #include <core/Logger.h>
 #include <resource/BinaryResource.h>
 #include <i18n/TranslationManager.h>
@@ -10,39 +13,444 @@ using namespace chira;
 
 CHIRA_CREATE_LOG(CMDL);
 
+namespace {
+
+/// Marks a zero vector in an octahedral normal, packSnorm never returns it
+constexpr std::uint16_t OCTAHEDRAL_ZERO = 0x8000;
+/// Files written before LODs were added end their header here
+constexpr std::size_t CHIRA_MESH_V2_MIN_HEADER_SIZE = offsetof(ChiraMeshHeaderV2, lodCount);
+
+std::size_t alignUp(std::size_t value) {
+    return (value + CHIRA_MESH_V2_ALIGNMENT - 1) / CHIRA_MESH_V2_ALIGNMENT * CHIRA_MESH_V2_ALIGNMENT;
+}
+
+std::size_t getAttributeSize(ChiraMeshAttributeFormat format) {
+    switch (format) {
+        using enum ChiraMeshAttributeFormat;
+        case FLOAT2:
+            return 8;
+        case FLOAT3:
+            return 12;
+        case UNORM16X3:
+            return 8;
+        case OCTAHEDRAL_SNORM16X2:
+        case HALF_FLOAT2:
+        case UNORM8X4:
+            return 4;
+    }
+    return 0;
+}
+
+float signNotZero(float value) {
+    return value >= 0.f ? 1.f : -1.f;
+}
+
+void encodeOctahedral(glm::vec3 normal, std::uint16_t out[2]) {
+    const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length == 0.f) {
+        out[0] = OCTAHEDRAL_ZERO;
+        out[1] = 0;
+        return;
+    }
+    float x = normal.x / length;
+    float y = normal.y / length;
+    if (normal.z < 0.f) {
+        const float folded = (1.f - std::abs(y)) * signNotZero(x);
+        y = (1.f - std::abs(x)) * signNotZero(y);
+        x = folded;
+    }
+    out[0] = glm::packSnorm1x16(x);
+    out[1] = glm::packSnorm1x16(y);
+}
+
+glm::vec3 decodeOctahedral(const std::uint16_t in[2]) {
+    if (in[0] == OCTAHEDRAL_ZERO)
+        return glm::vec3{0.f};
+    float x = glm::unpackSnorm1x16(in[0]);
+    float y = glm::unpackSnorm1x16(in[1]);
+    const float z = 1.f - std::abs(x) - std::abs(y);
+    if (z < 0.f) {
+        const float folded = (1.f - std::abs(y)) * signNotZero(x);
+        y = (1.f - std::abs(x)) * signNotZero(y);
+        x = folded;
+    }
+    const float length = std::sqrt(x * x + y * y + z * z);
+    return {x / length, y / length, z / length};
+}
+
+/// The vertex layout that matches Vertex exactly, so vertex data can be copied as is.
+constexpr ChiraMeshAttributeDescriptor LOSSLESS_LAYOUT[] = {
+        {ChiraMeshAttribute::POSITION, ChiraMeshAttributeFormat::FLOAT3, offsetof(Vertex, position)},
+        {ChiraMeshAttribute::NORMAL,   ChiraMeshAttributeFormat::FLOAT3, offsetof(Vertex, normal)},
+        {ChiraMeshAttribute::COLOR,    ChiraMeshAttributeFormat::FLOAT3, offsetof(Vertex, color)},
+        {ChiraMeshAttribute::UV,       ChiraMeshAttributeFormat::FLOAT2, offsetof(Vertex, uv)},
+};
+
+bool isLosslessLayout(const ChiraMeshAttributeDescriptor* attributes, std::size_t count, std::size_t stride) {
+    if (count != std::size(LOSSLESS_LAYOUT) || stride != sizeof(Vertex))
+        return false;
+    for (std::size_t i = 0; i < count; i++) {
+        const auto& expected = LOSSLESS_LAYOUT[i];
+        if (attributes[i].attribute != expected.attribute || attributes[i].format != expected.format || attributes[i].offset != expected.offset)
+            return false;
+    }
+    return true;
+}
+
+bool parseV1(const byte* data, std::size_t length, std::vector<Vertex>& vertices, std::vector<Index>& indices) {
+    ChiraMeshHeader header;
+    std::memcpy(&header, data, CHIRA_MESH_HEADER_SIZE);
+    const auto vertexSize = static_cast<std::size_t>(header.vertexCount) * sizeof(Vertex);
+    const auto indexSize = static_cast<std::size_t>(header.indexCount) * sizeof(Index);
+    if (length < CHIRA_MESH_HEADER_SIZE + vertexSize + indexSize)
+        return false;
+
+    const auto base = static_cast<Index>(vertices.size());
+    vertices.resize(vertices.size() + header.vertexCount);
+    std::memcpy(vertices.data() + base, data + CHIRA_MESH_HEADER_SIZE, vertexSize);
+    const auto firstIndex = indices.size();
+    indices.resize(indices.size() + header.indexCount);
+    std::memcpy(indices.data() + firstIndex, data + CHIRA_MESH_HEADER_SIZE + vertexSize, indexSize);
+    for (auto i = firstIndex; i < indices.size(); i++) {
+        if (indices[i] >= header.vertexCount) {
+            vertices.resize(base);
+            indices.resize(firstIndex);
+            return false;
+        }
+        indices[i] += base;
+    }
+    return true;
+}
+
+void decodeAttribute(const ChiraMeshHeaderV2& header, const ChiraMeshAttributeDescriptor& attribute, const byte* in, Vertex& vertex) {
+    float values[3]{};
+    switch (attribute.format) {
+        using enum ChiraMeshAttributeFormat;
+        case FLOAT2:
+            std::memcpy(values, in, sizeof(float) * 2);
+            break;
+        case FLOAT3:
+            std::memcpy(values, in, sizeof(float) * 3);
+            break;
+        case UNORM16X3: {
+            std::uint16_t packed[3];
+            std::memcpy(packed, in, sizeof(packed));
+            for (int i = 0; i < 3; i++) {
+                values[i] = header.boundsMin[i] + glm::unpackUnorm1x16(packed[i]) * (header.boundsMax[i] - header.boundsMin[i]);
+            }
+            break;
+        }
+        case OCTAHEDRAL_SNORM16X2: {
+            std::uint16_t packed[2];
+            std::memcpy(packed, in, sizeof(packed));
+            const auto normal = decodeOctahedral(packed);
+            values[0] = normal.x;
+            values[1] = normal.y;
+            values[2] = normal.z;
+            break;
+        }
+        case HALF_FLOAT2: {
+            std::uint16_t packed[2];
+            std::memcpy(packed, in, sizeof(packed));
+            values[0] = glm::unpackHalf1x16(packed[0]);
+            values[1] = glm::unpackHalf1x16(packed[1]);
+            break;
+        }
+        case UNORM8X4:
+            for (int i = 0; i < 3; i++) {
+                values[i] = glm::unpackUnorm1x8(in[i]);
+            }
+            break;
+    }
+    switch (attribute.attribute) {
+        using enum ChiraMeshAttribute;
+        case POSITION:
+            vertex.position = {values[0], values[1], values[2]};
+            break;
+        case NORMAL:
+            vertex.normal = {values[0], values[1], values[2]};
+            break;
+        case COLOR:
+            vertex.color = {values[0], values[1], values[2]};
+            break;
+        case UV:
+            vertex.uv = {values[0], values[1]};
+            break;
+    }
+}
+
+void encodeAttribute(const ChiraMeshHeaderV2& header, const ChiraMeshAttributeDescriptor& attribute, const Vertex& vertex, byte* out) {
+    float values[3]{};
+    switch (attribute.attribute) {
+        using enum ChiraMeshAttribute;
+        case POSITION:
+            values[0] = vertex.position.x;
+            values[1] = vertex.position.y;
+            values[2] = vertex.position.z;
+            break;
+        case NORMAL:
+            values[0] = vertex.normal.r;
+            values[1] = vertex.normal.g;
+            values[2] = vertex.normal.b;
+            break;
+        case COLOR:
+            values[0] = vertex.color.r;
+            values[1] = vertex.color.g;
+            values[2] = vertex.color.b;
+            break;
+        case UV:
+            values[0] = vertex.uv.r;
+            values[1] = vertex.uv.g;
+            break;
+    }
+    switch (attribute.format) {
+        using enum ChiraMeshAttributeFormat;
+        case FLOAT2:
+            std::memcpy(out, values, sizeof(float) * 2);
+            break;
+        case FLOAT3:
+            std::memcpy(out, values, sizeof(float) * 3);
+            break;
+        case UNORM16X3: {
+            std::uint16_t packed[4]{};
+            for (int i = 0; i < 3; i++) {
+                const float extent = header.boundsMax[i] - header.boundsMin[i];
+                packed[i] = glm::packUnorm1x16(extent > 0.f ? (values[i] - header.boundsMin[i]) / extent : 0.f);
+            }
+            std::memcpy(out, packed, sizeof(packed));
+            break;
+        }
+        case OCTAHEDRAL_SNORM16X2: {
+            std::uint16_t packed[2];
+            encodeOctahedral({values[0], values[1], values[2]}, packed);
+            std::memcpy(out, packed, sizeof(packed));
+            break;
+        }
+        case HALF_FLOAT2: {
+            const std::uint16_t packed[2] = {glm::packHalf1x16(values[0]), glm::packHalf1x16(values[1])};
+            std::memcpy(out, packed, sizeof(packed));
+            break;
+        }
+        case UNORM8X4:
+            for (int i = 0; i < 3; i++) {
+                out[i] = glm::packUnorm1x8(values[i]);
+            }
+            out[3] = 0xff;
+            break;
+    }
+}
+
+bool parseV2(const byte* data, std::size_t length, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>* lods) {
+    ChiraMeshHeaderV2 header;
+    std::uint32_t headerSize = 0;
+    std::memcpy(&headerSize, data + offsetof(ChiraMeshHeaderV2, headerSize), sizeof(headerSize));
+    if (headerSize < CHIRA_MESH_V2_MIN_HEADER_SIZE || headerSize > length)
+        return false;
+    std::memcpy(&header, data, std::min<std::size_t>(headerSize, sizeof(ChiraMeshHeaderV2)));
+
+    const auto lodsSize = static_cast<std::size_t>(header.lodCount) * sizeof(ChiraMeshLODDescriptor);
+    if (header.lodOffset > length || lodsSize > length - header.lodOffset)
+        return false;
+    std::vector<ChiraMeshLODDescriptor> lodDescriptors(header.lodCount);
+    if (lodsSize)
+        std::memcpy(lodDescriptors.data(), data + header.lodOffset, lodsSize);
+    for (const auto& lod : lodDescriptors) {
+        if (static_cast<std::uint64_t>(lod.firstIndex) + lod.indexCount > header.indexCount)
+            return false;
+    }
+    if (!lodDescriptors.empty() && lodDescriptors[0].firstIndex != 0)
+        return false;
+
+    const auto attributesSize = static_cast<std::size_t>(header.attributeCount) * sizeof(ChiraMeshAttributeDescriptor);
+    const auto vertexSize = static_cast<std::size_t>(header.vertexCount) * header.vertexStride;
+    const auto indexSize = static_cast<std::size_t>(header.indexCount) * header.indexSize;
+    if ((header.indexSize != 2 && header.indexSize != 4)
+        || header.attributeOffset > length || attributesSize > length - header.attributeOffset
+        || header.vertexDataOffset > length || vertexSize > length - header.vertexDataOffset
+        || header.indexDataOffset > length || indexSize > length - header.indexDataOffset)
+        return false;
+
+    std::vector<ChiraMeshAttributeDescriptor> attributes(header.attributeCount);
+    std::memcpy(attributes.data(), data + header.attributeOffset, attributesSize);
+    // Attributes added later are skipped, but the ones we know have to make sense
+    std::erase_if(attributes, [](const ChiraMeshAttributeDescriptor& attribute) {
+        return attribute.attribute > ChiraMeshAttribute::UV;
+    });
+    for (const auto& attribute : attributes) {
+        const auto size = getAttributeSize(attribute.format);
+        if (!size || attribute.offset + size > header.vertexStride)
+            return false;
+    }
+
+    const auto base = static_cast<Index>(vertices.size());
+    const auto* vertexData = data + header.vertexDataOffset;
+    if (isLosslessLayout(attributes.data(), attributes.size(), header.vertexStride)) {
+        vertices.resize(vertices.size() + header.vertexCount);
+        std::memcpy(vertices.data() + base, vertexData, vertexSize);
+    } else {
+        vertices.reserve(vertices.size() + header.vertexCount);
+        for (std::uint32_t i = 0; i < header.vertexCount; i++) {
+            Vertex vertex;
+            for (const auto& attribute : attributes) {
+                decodeAttribute(header, attribute, vertexData + static_cast<std::size_t>(i) * header.vertexStride + attribute.offset, vertex);
+            }
+            vertices.push_back(vertex);
+        }
+    }
+
+    // The LODs after the full mesh are only read if they're wanted
+    const auto indexCount = lods || lodDescriptors.empty() ? header.indexCount : lodDescriptors[0].indexCount;
+    const auto firstIndex = indices.size();
+    indices.resize(indices.size() + indexCount);
+    const auto* indexData = data + header.indexDataOffset;
+    // Out of range indices would make the GPU read past the vertex buffer
+    bool indicesValid = true;
+    if (header.indexSize == sizeof(Index) && !base) {
+        std::memcpy(indices.data() + firstIndex, indexData, static_cast<std::size_t>(indexCount) * sizeof(Index));
+        for (auto i = firstIndex; i < indices.size(); i++)
+            indicesValid &= indices[i] < header.vertexCount;
+    } else {
+        for (std::uint32_t i = 0; i < indexCount; i++) {
+            std::uint32_t index;
+            if (header.indexSize == 2) {
+                std::uint16_t narrow;
+                std::memcpy(&narrow, indexData + static_cast<std::size_t>(i) * 2, 2);
+                index = narrow;
+            } else {
+                std::memcpy(&index, indexData + static_cast<std::size_t>(i) * 4, 4);
+            }
+            indicesValid &= index < header.vertexCount;
+            indices[firstIndex + i] = base + index;
+        }
+    }
+    if (!indicesValid) {
+        vertices.resize(base);
+        indices.resize(firstIndex);
+        return false;
+    }
+
+    if (lods) {
+        for (const auto& lod : lodDescriptors)
+            lods->push_back({static_cast<Index>(firstIndex + lod.firstIndex), lod.indexCount, lod.error});
+    }
+    return true;
+}
+
+} // namespace
+
 void ChiraMeshLoader::loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const {
     auto meshData = Resource::getResource<BinaryResource>(identifier);
-    if (meshData->getBufferLength() < CHIRA_MESH_HEADER_SIZE) {
+    if (!meshData || !ChiraMeshLoader::parse(meshData->getBuffer(), meshData->getBufferLength(), vertices, indices)) {
         // die
         LOG_CMDL.error(TRF("error.cmdl_loader.invalid_data", identifier));
-        return;
     }
-    ChiraMeshHeader header;
-    std::memcpy(&header, meshData->getBuffer(), CHIRA_MESH_HEADER_SIZE);
+}
 
-    // read mesh data
-    if (header.version == 1) {
-        vertices.resize(header.vertexCount);
-        std::memcpy(vertices.data(), meshData->getBuffer() + CHIRA_MESH_HEADER_SIZE, header.vertexCount * sizeof(Vertex));
-        indices.resize(header.indexCount);
-        std::memcpy(indices.data(), meshData->getBuffer() + CHIRA_MESH_HEADER_SIZE + (header.vertexCount * sizeof(Vertex)), header.indexCount * sizeof(Index));
+void ChiraMeshLoader::loadMeshWithLODs(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>& lods) const {
+    auto meshData = Resource::getResource<BinaryResource>(identifier);
+    if (!meshData || !ChiraMeshLoader::parse(meshData->getBuffer(), meshData->getBufferLength(), vertices, indices, &lods)) {
+        LOG_CMDL.error(TRF("error.cmdl_loader.invalid_data", identifier));
+    }
+}
+
+bool ChiraMeshLoader::parse(const byte* data, std::size_t length, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>* lods /*= nullptr*/) {
+    if (length < CHIRA_MESH_HEADER_SIZE)
+        return false;
+    std::uint32_t version = 0;
+    std::memcpy(&version, data, sizeof(version));
+    switch (version) {
+        case 1:
+            return parseV1(data, length, vertices, indices);
+        case 2:
+            return parseV2(data, length, vertices, indices, lods);
+        default:
+            return false;
     }
 }
 
 std::vector<byte> ChiraMeshLoader::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const {
-    std::vector<byte> bytebuffer;
-    ChiraMeshHeader header;
-    header.version = 1;
-    header.vertexCount = static_cast<Index>(vertices.size());
-    header.indexCount = static_cast<Index>(indices.size());
-    const unsigned int VERTEX_SIZE = (sizeof(Vertex) * header.vertexCount);
-    const unsigned int INDEX_SIZE = (sizeof(Index) * header.indexCount);
-
-    // Since each element in bytebuffer is one byte wide, this works
-    bytebuffer.resize(CHIRA_MESH_HEADER_SIZE + VERTEX_SIZE + INDEX_SIZE);
-    std::memcpy(bytebuffer.data(), &header, CHIRA_MESH_HEADER_SIZE);
-    std::memcpy(bytebuffer.data() + CHIRA_MESH_HEADER_SIZE, vertices.data(), VERTEX_SIZE);
-    std::memcpy(bytebuffer.data() + CHIRA_MESH_HEADER_SIZE + VERTEX_SIZE, indices.data(), INDEX_SIZE);
-
-    return bytebuffer;
+    return this->createMeshWithLODs(vertices, indices, {});
+}
+
+std::vector<byte> ChiraMeshLoader::createMeshWithLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<MeshLOD>& lods) const {
+    ChiraMeshHeaderV2 header;
+    header.vertexCount = static_cast<std::uint32_t>(vertices.size());
+    header.indexCount = static_cast<std::uint32_t>(indices.size());
+    header.indexSize = vertices.size() <= 0x10000 ? 2 : 4;
+
+    // Bounds
+    if (!vertices.empty()) {
+        glm::vec3 min = vertices[0].position;
+        glm::vec3 max = vertices[0].position;
+        for (const auto& vertex : vertices) {
+            for (int i = 0; i < 3; i++) {
+                min[i] = std::min(min[i], vertex.position[i]);
+                max[i] = std::max(max[i], vertex.position[i]);
+            }
+        }
+        float radius = 0.f;
+        const glm::vec3 center{(min.x + max.x) / 2, (min.y + max.y) / 2, (min.z + max.z) / 2};
+        for (const auto& vertex : vertices) {
+            const glm::vec3 offset{vertex.position.x - center.x, vertex.position.y - center.y, vertex.position.z - center.z};
+            radius = std::max(radius, offset.x * offset.x + offset.y * offset.y + offset.z * offset.z);
+        }
+        for (int i = 0; i < 3; i++) {
+            header.boundsMin[i] = min[i];
+            header.boundsMax[i] = max[i];
+            header.sphereCenter[i] = center[i];
+        }
+        header.sphereRadius = std::sqrt(radius);
+    }
+
+    // Vertex layout
+    std::vector<ChiraMeshAttributeDescriptor> attributes;
+    const auto addAttribute = [&attributes, &header](ChiraMeshAttribute attribute, ChiraMeshAttributeFormat format) {
+        attributes.push_back({attribute, format, static_cast<std::uint16_t>(header.vertexStride)});
+        header.vertexStride += static_cast<std::uint32_t>(getAttributeSize(format));
+    };
+    using enum ChiraMeshAttributeFormat;
+    // Only the default layout can be copied as is, see isLosslessLayout()
+    addAttribute(ChiraMeshAttribute::POSITION, this->options.quantizePositions ? UNORM16X3 : FLOAT3);
+    addAttribute(ChiraMeshAttribute::NORMAL, this->options.octahedralNormals ? OCTAHEDRAL_SNORM16X2 : FLOAT3);
+    addAttribute(ChiraMeshAttribute::COLOR, this->options.compactColors ? UNORM8X4 : FLOAT3);
+    addAttribute(ChiraMeshAttribute::UV, this->options.halfFloatUVs ? HALF_FLOAT2 : FLOAT2);
+    header.attributeCount = static_cast<std::uint32_t>(attributes.size());
+
+    std::vector<ChiraMeshLODDescriptor> lodDescriptors;
+    for (const auto& lod : lods)
+        lodDescriptors.push_back({lod.firstIndex, lod.indexCount, lod.error});
+    header.lodCount = static_cast<std::uint32_t>(lodDescriptors.size());
+
+    header.attributeOffset = sizeof(ChiraMeshHeaderV2);
+    header.lodOffset = static_cast<std::uint32_t>(header.attributeOffset + attributes.size() * sizeof(ChiraMeshAttributeDescriptor));
+    header.vertexDataOffset = alignUp(header.lodOffset + lodDescriptors.size() * sizeof(ChiraMeshLODDescriptor));
+    header.indexDataOffset = alignUp(header.vertexDataOffset + static_cast<std::size_t>(header.vertexCount) * header.vertexStride);
+    std::vector<byte> out(alignUp(header.indexDataOffset + static_cast<std::size_t>(header.indexCount) * header.indexSize));
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::memcpy(out.data() + header.attributeOffset, attributes.data(), attributes.size() * sizeof(ChiraMeshAttributeDescriptor));
+    if (!lodDescriptors.empty())
+        std::memcpy(out.data() + header.lodOffset, lodDescriptors.data(), lodDescriptors.size() * sizeof(ChiraMeshLODDescriptor));
+
+    auto* vertexData = out.data() + header.vertexDataOffset;
+    if (isLosslessLayout(attributes.data(), attributes.size(), header.vertexStride)) {
+        std::memcpy(vertexData, vertices.data(), vertices.size() * sizeof(Vertex));
+    } else {
+        for (const auto& vertex : vertices) {
+            for (const auto& attribute : attributes) {
+                encodeAttribute(header, attribute, vertex, vertexData + attribute.offset);
+            }
+            vertexData += header.vertexStride;
+        }
+    }
+
+    auto* indexData = out.data() + header.indexDataOffset;
+    if (header.indexSize == sizeof(Index)) {
+        std::memcpy(indexData, indices.data(), indices.size() * sizeof(Index));
+    } else {
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            const auto index = static_cast<std::uint16_t>(indices[i]);
+            std::memcpy(indexData + i * 2, &index, 2);
+        }
+    }
+    return out;
 }
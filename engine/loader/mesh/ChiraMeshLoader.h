@@ -1,15 +1,42 @@
 #pragma once
 
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include "IMeshLoader.h"
 
 namespace chira {
 
+/// How vertices are stored when writing CMDL files. Everything is stored losslessly by default.
+struct ChiraMeshWriteOptions {
+    /// 16 bits per component, relative to the bounding box
+    bool quantizePositions = false;
+    /// Two 16-bit components, normals are expected to be unit length
+    bool octahedralNormals = false;
+    bool halfFloatUVs = false;
+    /// 8 bits per channel
+    bool compactColors = false;
+};
+
 class ChiraMeshLoader : public IMeshLoader {
 public:
+    explicit ChiraMeshLoader(ChiraMeshWriteOptions options_ = {}) : options(options_) {}
     void loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const override;
+    /// Always writes the latest version.
     [[nodiscard]] std::vector<byte> createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const override;
+    void loadMeshWithLODs(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>& lods) const override;
+    [[nodiscard]] std::vector<byte> createMeshWithLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<MeshLOD>& lods) const override;
+
+    /// Reads a CMDL file of any version and appends it to the mesh. Returns false if the data is invalid.
+    /// Without a list to put LODs in, only the full mesh is read.
+    static bool parse(const byte* data, std::size_t length, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>* lods = nullptr);
+private:
+    ChiraMeshWriteOptions options;
 };
 
+// Every version is copied in and out as is, byte swapping isn't worth it for hosts nobody ships on
+static_assert(std::endian::native == std::endian::little, "CMDL files are little endian, and are read and written in host byte order!");
+
 struct ChiraMeshHeader {
     unsigned int version = 0;
     unsigned int vertexCount = 0;
@@ -17,4 +44,67 @@ struct ChiraMeshHeader {
 };
 constexpr unsigned short CHIRA_MESH_HEADER_SIZE = sizeof(ChiraMeshHeader);
 
+/// Vertex and index data in version 2 files start at a multiple of this, so they can be used straight from a file mapping.
+constexpr std::size_t CHIRA_MESH_V2_ALIGNMENT = 16;
+
+enum class ChiraMeshAttribute : std::uint8_t {
+    POSITION,
+    NORMAL,
+    COLOR,
+    UV,
+};
+
+enum class ChiraMeshAttributeFormat : std::uint8_t {
+    FLOAT2,
+    FLOAT3,
+    /// Relative to the bounding box, padded to 8 bytes
+    UNORM16X3,
+    /// Octahedral encoding of a unit vector. An X of -32768 is a zero vector
+    OCTAHEDRAL_SNORM16X2,
+    HALF_FLOAT2,
+    UNORM8X4,
+};
+
+/// Where one attribute is in each vertex. Readers skip attributes they don't know.
+struct ChiraMeshAttributeDescriptor {
+    ChiraMeshAttribute attribute = ChiraMeshAttribute::POSITION;
+    ChiraMeshAttributeFormat format = ChiraMeshAttributeFormat::FLOAT3;
+    std::uint16_t offset = 0;
+};
+static_assert(sizeof(ChiraMeshAttributeDescriptor) == 4);
+
+/// A range of the index data. The first one is always the full mesh.
+struct ChiraMeshLODDescriptor {
+    std::uint32_t firstIndex = 0;
+    std::uint32_t indexCount = 0;
+    /// Relative to the bounding sphere radius
+    float error = 0.f;
+};
+static_assert(sizeof(ChiraMeshLODDescriptor) == 12);
+
+/// Starts with the version like the first header. Followed by the attribute descriptors, the LOD descriptors, the vertex
+/// data and the index data, each at the offset given here. All values are little endian.
+struct ChiraMeshHeaderV2 {
+    std::uint32_t version = 2;
+    /// Fields added later go at the end, older readers skip them
+    std::uint32_t headerSize = sizeof(ChiraMeshHeaderV2);
+    std::uint32_t vertexCount = 0;
+    std::uint32_t indexCount = 0;
+    std::uint32_t vertexStride = 0;
+    /// 2 or 4 bytes
+    std::uint32_t indexSize = 4;
+    std::uint32_t attributeCount = 0;
+    std::uint32_t attributeOffset = 0;
+    std::uint64_t vertexDataOffset = 0;
+    std::uint64_t indexDataOffset = 0;
+    float boundsMin[3]{};
+    float boundsMax[3]{};
+    float sphereCenter[3]{};
+    float sphereRadius = 0;
+    /// Zero if the index data is only the full mesh
+    std::uint32_t lodCount = 0;
+    std::uint32_t lodOffset = 0;
+};
+static_assert(sizeof(ChiraMeshHeaderV2) == 96);
+
 } // namespace chira
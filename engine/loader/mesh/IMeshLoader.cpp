@@ -2,6 +2,17 @@
 
 using namespace chira;
 
+void IMeshLoader::loadMeshWithLODs(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>& /*lods*/) const {
+    this->loadMesh(identifier, vertices, indices);
+}
+
+std::vector<byte> IMeshLoader::createMeshWithLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<MeshLOD>& lods) const {
+    if (lods.empty())
+        return this->createMesh(vertices, indices);
+    const auto first = indices.begin() + lods[0].firstIndex;
+    return this->createMesh(vertices, {first, first + lods[0].indexCount});
+}
+
 void IMeshLoader::addMeshLoader(const std::string& name, IMeshLoader* meshLoader) {
     IMeshLoader::meshLoaders[name] = std::unique_ptr<IMeshLoader>(meshLoader);
 }
@@ -9,11 +9,23 @@
 
 namespace chira {
 
+/// A level of detail of a mesh, as a range of its indices. Every level uses the same vertices.
+struct MeshLOD {
+    Index firstIndex = 0;
+    Index indexCount = 0;
+    /// How far the surface moved when simplifying it, relative to the radius of the mesh
+    float error = 0.f;
+};
+
 class IMeshLoader {
 public:
     virtual ~IMeshLoader() = default;
     virtual void loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const = 0;
     [[nodiscard]] virtual std::vector<byte> createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const = 0;
+    /// Loaders for formats that can store LODs override these. If a mesh has LODs, the first one is the full mesh.
+    /// By default, no LODs are loaded, and only the full mesh is written.
+    virtual void loadMeshWithLODs(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>& lods) const;
+    [[nodiscard]] virtual std::vector<byte> createMeshWithLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<MeshLOD>& lods) const;
     static void addMeshLoader(const std::string& name, IMeshLoader* meshLoader);
     static IMeshLoader* getMeshLoader(const std::string& name);
 private:
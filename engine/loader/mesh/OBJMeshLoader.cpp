@@ -1,7 +1,14 @@
 #include "OBJMeshLoader.h"
 
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <thread>
 #include <core/Logger.h>
+#include <render/mesh/VertexWelder.h>
 #include <resource/StringResource.h>
 #include <i18n/TranslationManager.h>
 #include <sstream>
@@ -10,87 +17,278 @@ using namespace chira;
 
 CHIRA_CREATE_LOG(OBJ);
 
-void OBJMeshLoader::loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const {
-    std::vector<glm::vec3> vertexBuffer;
-    std::vector<ColorRG> uvBuffer;
-    std::vector<ColorRGB> normalBuffer;
+namespace {
 
-    auto meshData = Resource::getResource<StringResource>(identifier);
-    std::istringstream meshDataStream{meshData->getString()};
-
-    std::string line;
-    Index currentIndex = 0;
-    while (std::getline(meshDataStream, line)) {
-        if (line.substr(0,2) == "v ") {
-            glm::vec3 pos;
-            std::istringstream iss(line.substr(2));
-            iss >> pos.x >> pos.y >> pos.z;
-            vertexBuffer.push_back(pos);
-        } else if (line.substr(0,3) == "vt ") {
-            ColorRG uv;
-            std::istringstream iss(line.substr(2));
-            iss >> uv.r >> uv.g;
-            uvBuffer.push_back(uv);
-        } else if (line.substr(0,3) == "vn ") {
-            ColorRGB normal;
-            std::istringstream iss(line.substr(2));
-            iss >> normal.r >> normal.g >> normal.b;
-            normalBuffer.push_back(normal);
-        } else if (line.substr(0,2) == "f ") {
-            // this line has 10 zeroes to check if OBJ is triangulated concisely
-            int objIndices[10];
-            std::string data = line.substr(2);
-            std::replace(data.begin(), data.end(), '/', ' ');
-            std::istringstream iss(data);
-            unsigned short counter = 0;
-            bool includeUVs = false;
-            while (iss >> objIndices[counter]) {
-                objIndices[counter] -= 1;
-                if (counter >= 9) {
-                    LOG_OBJ.warning(TRF("warn.obj_loader.not_triangulated", identifier));
+/// Files are only split into chunks this big or bigger, smaller files aren't worth starting threads for
+constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
+
+/// The index wasn't given, like the UV in "f 1//1"
+constexpr std::int64_t MISSING_INDEX = std::numeric_limits<std::int64_t>::min();
+/// The index is 0 or isn't a number
+constexpr std::int64_t INVALID_INDEX = std::numeric_limits<std::int64_t>::max();
+
+/// A zero-based index into the positions, UVs or normals. Negative indices in the file count back from the last
+/// element defined before them, but a chunk doesn't know how many came before it, so those are stored relative
+/// to the start of the chunk and resolved when the chunks are merged.
+struct OBJIndex {
+    std::int64_t value = MISSING_INDEX;
+    bool relative = false;
+};
+
+struct OBJCorner {
+    OBJIndex position;
+    OBJIndex uv;
+    OBJIndex normal;
+};
+
+struct OBJChunk {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<OBJCorner> corners;
+    /// The number of corners of each face, in order
+    std::vector<std::uint32_t> faces;
+};
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+void skipBlanks(const char*& p, const char* end) {
+    while (p < end && isBlank(*p))
+        p++;
+}
+
+bool parseFloat(const char*& p, const char* end, float& out) {
+    skipBlanks(p, end);
+    // from_chars doesn't take a leading plus
+    if (p < end && *p == '+')
+        p++;
+    const auto [next, error] = std::from_chars(p, end, out);
+    if (error != std::errc{})
+        return false;
+    p = next;
+    return true;
+}
+
+/// Reads up to count numbers, anything that's missing is left alone.
+void parseFloats(const char*& p, const char* end, float* out, int count) {
+    for (int i = 0; i < count && parseFloat(p, end, out[i]); i++) {}
+}
+
+OBJIndex parseIndex(const char*& p, const char* end, std::size_t count) {
+    if (p < end && *p == '+')
+        p++;
+    std::int64_t value = 0;
+    const auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc{} || value == 0)
+        return {INVALID_INDEX, false};
+    p = next;
+    if (value < 0)
+        return {static_cast<std::int64_t>(count) + value, true};
+    return {value - 1, false};
+}
+
+/// Parses whole lines, the chunk has to start at the start of a line.
+void parseChunk(std::string_view text, OBJChunk& chunk) {
+    const char* p = text.data();
+    const char* const end = text.data() + text.size();
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!lineEnd)
+            lineEnd = end;
+        skipBlanks(p, lineEnd);
+
+        if (lineEnd - p >= 2 && p[0] == 'v' && isBlank(p[1])) {
+            p += 2;
+            glm::vec3 position{0.f};
+            parseFloats(p, lineEnd, &position[0], 3);
+            chunk.positions.push_back(position);
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && isBlank(p[2])) {
+            p += 3;
+            glm::vec2 uv{0.f};
+            parseFloats(p, lineEnd, &uv[0], 2);
+            chunk.uvs.push_back(uv);
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && isBlank(p[2])) {
+            p += 3;
+            glm::vec3 normal{0.f};
+            parseFloats(p, lineEnd, &normal[0], 3);
+            chunk.normals.push_back(normal);
+        } else if (lineEnd - p >= 2 && p[0] == 'f' && isBlank(p[1])) {
+            p += 2;
+            std::uint32_t cornerCount = 0;
+            while (true) {
+                skipBlanks(p, lineEnd);
+                if (p == lineEnd)
                     break;
-                } else if (counter >= 6) {
-                    includeUVs = true;
+                // v, v/vt, v//vn or v/vt/vn
+                OBJCorner corner;
+                corner.position = parseIndex(p, lineEnd, chunk.positions.size());
+                if (p < lineEnd && *p == '/') {
+                    p++;
+                    if (p < lineEnd && *p != '/')
+                        corner.uv = parseIndex(p, lineEnd, chunk.uvs.size());
+                    if (p < lineEnd && *p == '/') {
+                        p++;
+                        corner.normal = parseIndex(p, lineEnd, chunk.normals.size());
+                    }
                 }
-                counter++;
-            }
-            if (includeUVs) {
-                addVertex({{vertexBuffer[objIndices[0]].x, vertexBuffer[objIndices[0]].y, vertexBuffer[objIndices[0]].z},
-                           {normalBuffer[objIndices[2]].r, normalBuffer[objIndices[2]].g, normalBuffer[objIndices[2]].b},
-                           {uvBuffer[objIndices[1]].r, uvBuffer[objIndices[1]].g}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[3]].x, vertexBuffer[objIndices[3]].y, vertexBuffer[objIndices[3]].z},
-                           {normalBuffer[objIndices[5]].r, normalBuffer[objIndices[5]].g, normalBuffer[objIndices[5]].b},
-                           {uvBuffer[objIndices[4]].r, uvBuffer[objIndices[4]].g}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[6]].x, vertexBuffer[objIndices[6]].y, vertexBuffer[objIndices[6]].z},
-                           {normalBuffer[objIndices[8]].r, normalBuffer[objIndices[8]].g, normalBuffer[objIndices[8]].b},
-                           {uvBuffer[objIndices[7]].r, uvBuffer[objIndices[7]].g}},
-                          &currentIndex, vertices, indices);
-            } else {
-                addVertex({{vertexBuffer[objIndices[0]].x, vertexBuffer[objIndices[0]].y, vertexBuffer[objIndices[0]].z},
-                           {normalBuffer[objIndices[1]].r, normalBuffer[objIndices[1]].g, normalBuffer[objIndices[1]].b}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[2]].x, vertexBuffer[objIndices[2]].y, vertexBuffer[objIndices[2]].z},
-                           {normalBuffer[objIndices[3]].r, normalBuffer[objIndices[3]].g, normalBuffer[objIndices[3]].b}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[4]].x, vertexBuffer[objIndices[4]].y, vertexBuffer[objIndices[4]].z},
-                           {normalBuffer[objIndices[5]].r, normalBuffer[objIndices[5]].g, normalBuffer[objIndices[5]].b}},
-                          &currentIndex, vertices, indices);
+                chunk.corners.push_back(corner);
+                cornerCount++;
+                if (corner.position.value == INVALID_INDEX || corner.uv.value == INVALID_INDEX || corner.normal.value == INVALID_INDEX)
+                    break;
             }
+            chunk.faces.push_back(cornerCount);
+        }
+        // Anything else (comments, groups, materials, lines...) doesn't affect the mesh
+
+        p = lineEnd + 1;
+    }
+}
+
+/// Splits the text into roughly equal chunks that start at the start of a line.
+std::vector<std::string_view> splitChunks(std::string_view text, unsigned int threadCount) {
+    if (!threadCount)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    const auto chunkCount = std::clamp<std::size_t>(text.size() / MIN_CHUNK_SIZE, 1, threadCount);
+    std::vector<std::string_view> chunks;
+    std::size_t begin = 0;
+    for (std::size_t i = 1; i <= chunkCount && (begin < text.size() || chunks.empty()); i++) {
+        auto split = text.size();
+        if (i < chunkCount) {
+            split = text.find('\n', std::max(begin, text.size() * i / chunkCount));
+            split = split == std::string_view::npos ? text.size() : split + 1;
         }
+        chunks.push_back(text.substr(begin, split - begin));
+        begin = split;
     }
+    return chunks;
+}
+
+} // namespace
+
+void OBJMeshLoader::loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const {
+    auto meshData = Resource::getResource<StringResource>(identifier);
+    if (!meshData)
+        return;
+    if (const auto skipped = OBJMeshLoader::parse(meshData->getString(), vertices, indices))
+        LOG_OBJ.warning(TRF("warn.obj_loader.invalid_faces", identifier, skipped));
 }
 
-void OBJMeshLoader::addVertex(Vertex v, Index* currentIndex, std::vector<Vertex>& vertices, std::vector<Index>& indices) {
-    auto position = std::find(vertices.begin(), vertices.end(), v);
-    if (position != vertices.end()) {
-        indices.push_back(static_cast<Index>(position - vertices.begin()));
-    } else {
-        vertices.push_back(v);
-        indices.push_back(*currentIndex);
-        *currentIndex += 1;
+std::size_t OBJMeshLoader::parse(std::string_view data, std::vector<Vertex>& vertices, std::vector<Index>& indices, unsigned int threadCount) {
+    const auto chunkTexts = splitChunks(data, threadCount);
+    std::vector<OBJChunk> chunks(chunkTexts.size());
+    {
+        // The first chunk is parsed on this thread
+        std::vector<std::future<void>> parsing;
+        for (std::size_t i = 1; i < chunkTexts.size(); i++) {
+            parsing.push_back(std::async(std::launch::async, [&chunkTexts, &chunks, i] {
+                parseChunk(chunkTexts[i], chunks[i]);
+            }));
+        }
+        parseChunk(chunkTexts[0], chunks[0]);
+        for (auto& chunk : parsing) {
+            chunk.get();
+        }
+    }
+
+    // Merge the vertex data of each chunk in order, so relative indices can be resolved
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    struct ChunkStart {
+        std::size_t position = 0;
+        std::size_t uv = 0;
+        std::size_t normal = 0;
+    };
+    std::vector<ChunkStart> starts;
+    std::size_t cornerCount = 0;
+    for (auto& chunk : chunks) {
+        starts.push_back({positions.size(), uvs.size(), normals.size()});
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        cornerCount += chunk.corners.size();
+        chunk.positions = {};
+        chunk.uvs = {};
+        chunk.normals = {};
+    }
+
+    // Returns the index into the merged elements, MISSING_INDEX if there isn't one, or INVALID_INDEX if it's out of range
+    const auto resolve = [](const OBJIndex& index, std::size_t start, std::size_t count) {
+        if (index.value == MISSING_INDEX || index.value == INVALID_INDEX)
+            return index.value;
+        const auto resolved = index.relative ? static_cast<std::int64_t>(start) + index.value : index.value;
+        if (resolved < 0 || resolved >= static_cast<std::int64_t>(count))
+            return INVALID_INDEX;
+        return resolved;
+    };
+
+    // Corners with the same position, UV and normal indices are the same vertex, which is much cheaper to find
+    // than comparing the vertex itself. Only the first corner with each combination goes through the welder.
+    // The combinations seen so far are kept in a list per position
+    struct CornerVertex {
+        std::int64_t uv;
+        std::int64_t normal;
+        Index vertex;
+        std::uint32_t next;
+    };
+    constexpr auto NO_CORNER_VERTEX = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> cornerVertexLists(positions.size(), NO_CORNER_VERTEX);
+    std::vector<CornerVertex> cornerVertices;
+    cornerVertices.reserve(positions.size());
+
+    VertexWelder welder;
+    welder.reserve(vertices.size() + positions.size());
+    indices.reserve(indices.size() + cornerCount * 3 / 2);
+    std::vector<Index> faceIndices;
+    std::size_t skipped = 0;
+    for (std::size_t c = 0; c < chunks.size(); c++) {
+        const auto& chunk = chunks[c];
+        const auto& start = starts[c];
+        std::size_t corner = 0;
+        for (const auto faceSize : chunk.faces) {
+            const auto* face = chunk.corners.data() + corner;
+            corner += faceSize;
+            bool valid = faceSize >= 3;
+            faceIndices.clear();
+            for (std::uint32_t i = 0; valid && i < faceSize; i++) {
+                const auto position = resolve(face[i].position, start.position, positions.size());
+                const auto uv = resolve(face[i].uv, start.uv, uvs.size());
+                const auto normal = resolve(face[i].normal, start.normal, normals.size());
+                valid = position != MISSING_INDEX && position != INVALID_INDEX && uv != INVALID_INDEX && normal != INVALID_INDEX;
+                if (!valid)
+                    break;
+
+                auto& list = cornerVertexLists[static_cast<std::size_t>(position)];
+                auto entry = list;
+                while (entry != NO_CORNER_VERTEX && (cornerVertices[entry].uv != uv || cornerVertices[entry].normal != normal))
+                    entry = cornerVertices[entry].next;
+                if (entry != NO_CORNER_VERTEX) {
+                    faceIndices.push_back(cornerVertices[entry].vertex);
+                    continue;
+                }
+
+                const auto& p = positions[static_cast<std::size_t>(position)];
+                const auto t = uv == MISSING_INDEX ? glm::vec2{0.f} : uvs[static_cast<std::size_t>(uv)];
+                const auto n = normal == MISSING_INDEX ? glm::vec3{0.f} : normals[static_cast<std::size_t>(normal)];
+                const auto vertex = welder.weld({{p.x, p.y, p.z}, {n.x, n.y, n.z}, {t.x, t.y}}, vertices);
+                cornerVertices.push_back({uv, normal, vertex, list});
+                list = static_cast<std::uint32_t>(cornerVertices.size() - 1);
+                faceIndices.push_back(vertex);
+            }
+            if (!valid) {
+                skipped++;
+                continue;
+            }
+            for (std::size_t i = 1; i + 1 < faceIndices.size(); i++) {
+                indices.push_back(faceIndices[0]);
+                indices.push_back(faceIndices[i]);
+                indices.push_back(faceIndices[i + 1]);
+            }
+        }
     }
+    return skipped;
 }
 
 std::vector<byte> OBJMeshLoader::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string_view>
 #include "IMeshLoader.h"
 
 namespace chira {
@@ -8,8 +9,12 @@ class OBJMeshLoader : public IMeshLoader {
 public:
     void loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const override;
     [[nodiscard]] std::vector<byte> createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const override;
-private:
-    static void addVertex(Vertex v, Index* currentIndex, std::vector<Vertex>& vertices, std::vector<Index>& indices);
+
+    /// Parses the contents of an OBJ file and appends its faces to the mesh. Faces with more than three corners
+    /// are triangulated as a fan, and missing normals or UVs are left at zero. Large files are split into chunks
+    /// that are parsed on up to threadCount threads, 0 picks the number of hardware threads.
+    /// Returns the number of faces that were skipped because they refer to vertex data that doesn't exist.
+    static std::size_t parse(std::string_view data, std::vector<Vertex>& vertices, std::vector<Index>& indices, unsigned int threadCount = 0);
 };
 
 } // namespace chira
@@ -0,0 +1,77 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <bit>
+#include <render/material/MaterialFactory.h>
+#include <render/mesh/MeshData.h>
+
+using namespace chira;
+
+namespace {
+
+/// Values past the end of the field share the last one
+[[nodiscard]] constexpr std::uint64_t getKeyField(unsigned int value, int bits) {
+    return std::min<std::uint64_t>(value, (1ull << bits) - 1);
+}
+
+/// Fibonacci hashing, so nearby addresses still land in different fields
+[[nodiscard]] std::uint64_t getKeyField(const void* pointer, int bits) {
+    if (!pointer)
+        return 0;
+    return (static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(pointer)) * 0x9e3779b97f4a7c15ull) >> (64 - bits);
+}
+
+} // namespace
+
+std::uint64_t RenderQueue::makeKey(unsigned int layer, unsigned int view, const void* shader, const void* material, const void* mesh, float depth) {
+    // Positive floats sort the same as their bits, the top of which still has the exponent and some of the mantissa
+    const std::uint64_t depthBits = depth > 0.f ? std::bit_cast<std::uint32_t>(depth) >> (32 - DEPTH_BITS) : 0;
+
+    std::uint64_t key = getKeyField(layer, LAYER_BITS);
+    key = (key << VIEW_BITS) | getKeyField(view, VIEW_BITS);
+    key = (key << SHADER_BITS) | getKeyField(shader, SHADER_BITS);
+    key = (key << MATERIAL_BITS) | getKeyField(material, MATERIAL_BITS);
+    key = (key << MESH_BITS) | getKeyField(mesh, MESH_BITS);
+    key = (key << DEPTH_BITS) | depthBits;
+    return key;
+}
+
+void RenderQueue::add(unsigned int layer, unsigned int view, MeshData* mesh, glm::mat4 model, std::size_t lod /*= 0*/, float depth /*= 0.f*/) {
+    // The mesh holds onto its material and the material holds onto its shader, so these stay valid until submitted
+    IMaterial* material = mesh->getMaterial().get();
+    Shader* shader = material ? material->getShader().get() : nullptr;
+    this->packets.push_back({makeKey(layer, view, shader, material, mesh, depth), mesh, material, shader, model, lod, view});
+}
+
+void RenderQueue::submit(const std::function<void(unsigned int)>& setupView) {
+    this->statistics = {};
+    this->order.clear();
+    this->order.reserve(this->packets.size());
+    for (std::uint32_t i = 0; i < this->packets.size(); i++) {
+        this->order.emplace_back(this->packets[i].key, i);
+    }
+    // Ties keep the order they were added in
+    std::sort(this->order.begin(), this->order.end());
+
+    const Packet* last = nullptr;
+    for (const auto& [key, index] : this->order) {
+        const auto& packet = this->packets[index];
+        if (!last || packet.view != last->view) {
+            setupView(packet.view);
+            this->statistics.viewChanges++;
+        }
+        if (packet.material && (!last || packet.material != last->material)) {
+            if (!last || packet.shader != last->shader)
+                this->statistics.shaderChanges++;
+            packet.material->use();
+            this->statistics.materialChanges++;
+        }
+        packet.mesh->draw(packet.model, MeshCullType::BACK, packet.lod);
+        this->statistics.drawCalls++;
+        last = &packet;
+    }
+}
+
+void RenderQueue::clear() {
+    this->packets.clear();
+}
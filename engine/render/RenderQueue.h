@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace chira {
+
+class IMaterial;
+class MeshData;
+class Shader;
+
+/// What the last submit of a render queue did.
+struct RenderQueueStatistics {
+    std::size_t drawCalls = 0;
+    std::size_t viewChanges = 0;
+    std::size_t shaderChanges = 0;
+    std::size_t materialChanges = 0;
+};
+
+/// Collects the draws of a frame and sorts them by state, so each view, shader and material is only set up once per
+/// run of draws that share it.
+class RenderQueue {
+public:
+    /// Sort key fields, from the most to the least significant bits
+    static constexpr int LAYER_BITS = 4;
+    static constexpr int VIEW_BITS = 6;
+    static constexpr int SHADER_BITS = 12;
+    static constexpr int MATERIAL_BITS = 14;
+    static constexpr int MESH_BITS = 12;
+    static constexpr int DEPTH_BITS = 16;
+    static_assert(LAYER_BITS + VIEW_BITS + SHADER_BITS + MATERIAL_BITS + MESH_BITS + DEPTH_BITS == 64);
+
+    struct Packet {
+        std::uint64_t key;
+        MeshData* mesh;
+        IMaterial* material;
+        Shader* shader;
+        glm::mat4 model;
+        std::size_t lod;
+        unsigned int view;
+    };
+
+    /// Shaders, materials and meshes are hashed into their fields. Submitting compares the objects themselves, so
+    /// two of them sharing bits only costs an extra state change. Closer draws go first when everything else matches.
+    [[nodiscard]] static std::uint64_t makeKey(unsigned int layer, unsigned int view, const void* shader, const void* material, const void* mesh, float depth);
+
+    /// The mesh and its material must outlive the next submit. depth is the distance from the camera.
+    void add(unsigned int layer, unsigned int view, MeshData* mesh, glm::mat4 model, std::size_t lod = 0, float depth = 0.f);
+    /// Draws everything added since the last clear in key order. setupView is called before the first draw in each view.
+    void submit(const std::function<void(unsigned int)>& setupView);
+    /// Keeps the memory for the next frame.
+    void clear();
+
+    [[nodiscard]] const std::vector<Packet>& getPackets() const {
+        return this->packets;
+    }
+    [[nodiscard]] const RenderQueueStatistics& getStatistics() const {
+        return this->statistics;
+    }
+
+private:
+    std::vector<Packet> packets;
+    /// Sort keys and packet indices, so sorting doesn't move the matrices around
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> order;
+    RenderQueueStatistics statistics;
+};
+
+} // namespace chira
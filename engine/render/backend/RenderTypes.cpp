@@ -108,3 +108,11 @@ MeshCullType chira::getMeshCullTypeFromString(std::string_view type) {
     LOG_RENDERTYPES.warning("Invalid string passed to getMeshCullTypeFromString: \"{}\"", type);
     return MeshCullType::BACK;
 }
+
+VertexLayoutType chira::getVertexLayoutTypeFromString(std::string_view type) {
+    if (auto value = magic_enum::enum_cast<VertexLayoutType>(type)) {
+        return *value;
+    }
+    LOG_RENDERTYPES.warning("Invalid string passed to getVertexLayoutTypeFromString: \"{}\"", type);
+    return VertexLayoutType::FULL;
+}
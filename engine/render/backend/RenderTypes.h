@@ -100,7 +100,36 @@ enum class MeshCullType {
     NONE,
 };
 
+/// Matches the attribute locations in shaders
+enum class VertexAttribute : unsigned char {
+    POSITION = 0,
+    NORMAL = 1,
+    COLOR = 2,
+    UV = 3,
+};
+
+enum class VertexAttributeFormat : unsigned char {
+    FLOAT2,
+    FLOAT3,
+    /// Two half floats
+    HALF2,
+    /// Three normalized signed shorts, padded to four
+    SNORM16X4,
+    /// Three normalized unsigned bytes, padded with 255
+    UNORM8X4,
+};
+
+enum class VertexLayoutType {
+    /// Full precision, the same as Vertex (44 bytes)
+    FULL,
+    /// Packed normals, colors and UVs (28 bytes)
+    COMPACT,
+    /// Packed normals and UVs, colors are always white (24 bytes)
+    COMPACT_NO_COLOR,
+};
+
 [[nodiscard]] MeshDepthFunction getMeshDepthFunctionFromString(std::string_view function);
 [[nodiscard]] MeshCullType getMeshCullTypeFromString(std::string_view type);
+[[nodiscard]] VertexLayoutType getVertexLayoutTypeFromString(std::string_view type);
 
 } // namespace chira
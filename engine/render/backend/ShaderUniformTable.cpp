@@ -0,0 +1,34 @@
+#include "ShaderUniformTable.h"
+
+#include <algorithm>
+
+using namespace chira;
+
+void ShaderUniformTable::add(std::string name, int location) {
+    const auto hash = Hash::xxh64(name);
+    auto entry = std::lower_bound(this->entries.begin(), this->entries.end(), hash, [](const Entry& e, std::uint64_t h) {
+        return e.hash < h;
+    });
+    for (auto it = entry; it != this->entries.end() && it->hash == hash; it++) {
+        if (it->name == name) {
+            it->location = location;
+            return;
+        }
+    }
+    this->entries.insert(entry, {hash, location, std::move(name)});
+}
+
+void ShaderUniformTable::clear() {
+    this->entries.clear();
+}
+
+int ShaderUniformTable::find(std::string_view name, std::uint64_t hash) const {
+    auto entry = std::lower_bound(this->entries.begin(), this->entries.end(), hash, [](const Entry& e, std::uint64_t h) {
+        return e.hash < h;
+    });
+    for (; entry != this->entries.end() && entry->hash == hash; entry++) {
+        if (entry->name == name)
+            return entry->location;
+    }
+    return INVALID_LOCATION;
+}
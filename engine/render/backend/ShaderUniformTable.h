@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility/Hash.h>
+
+namespace chira {
+
+/// Uniform locations of a linked shader program, keyed by the hash of their names.
+class ShaderUniformTable {
+public:
+    static constexpr int INVALID_LOCATION = -1;
+
+    void add(std::string name, int location);
+    void clear();
+    /// INVALID_LOCATION if the program has no active uniform with this name.
+    [[nodiscard]] int find(std::string_view name) const {
+        return this->find(name, Hash::xxh64(name));
+    }
+    /// Takes a hash of the name made with Hash::xxh64, so it can be computed at compile time.
+    [[nodiscard]] int find(std::string_view name, std::uint64_t hash) const;
+    [[nodiscard]] std::size_t size() const {
+        return this->entries.size();
+    }
+    [[nodiscard]] bool empty() const {
+        return this->entries.empty();
+    }
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        int location;
+        std::string name;
+    };
+    /// Sorted by hash
+    std::vector<Entry> entries;
+};
+
+} // namespace chira
@@ -0,0 +1,69 @@
+#include "UniformBufferSlices.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <core/Assertions.h>
+#include <utility/Hash.h>
+
+using namespace chira;
+
+UniformBufferSlices::UniformBufferSlices(std::size_t dataSize_, std::size_t alignment, Slice capacity)
+        : dataSize(dataSize_)
+        , sliceSize((dataSize_ + alignment - 1) & ~(alignment - 1)) {
+    runtime_assert(alignment && !(alignment & (alignment - 1)), "Uniform buffer alignment has to be a power of two!");
+    capacity = std::max(capacity, 1u);
+    this->data.resize(capacity * this->sliceSize);
+    this->users.resize(capacity);
+    // Hand out the lowest slices first
+    for (Slice slice = capacity; slice > 0; slice--) {
+        this->freeSlices.push_back(slice - 1);
+    }
+}
+
+UniformBufferSlices::Acquired UniformBufferSlices::acquire(const void* contents) {
+    const auto contentsHash = this->hash(contents);
+    for (auto [it, end] = this->slicesByHash.equal_range(contentsHash); it != end; ++it) {
+        if (std::memcmp(this->data.data() + this->getOffset(it->second), contents, this->dataSize) == 0) {
+            this->users[it->second]++;
+            return {.slice = it->second};
+        }
+    }
+
+    Acquired acquired{};
+    if (this->freeSlices.empty()) {
+        const auto oldCapacity = this->getCapacity();
+        this->data.resize(oldCapacity * 2 * this->sliceSize);
+        this->users.resize(oldCapacity * 2);
+        for (Slice slice = oldCapacity * 2; slice > oldCapacity; slice--) {
+            this->freeSlices.push_back(slice - 1);
+        }
+        acquired.grew = true;
+    }
+    acquired.slice = this->freeSlices.back();
+    acquired.written = true;
+    this->freeSlices.pop_back();
+
+    std::memcpy(this->data.data() + this->getOffset(acquired.slice), contents, this->dataSize);
+    this->users[acquired.slice] = 1;
+    this->slicesByHash.emplace(contentsHash, acquired.slice);
+    return acquired;
+}
+
+void UniformBufferSlices::release(Slice slice) {
+    runtime_assert(slice < this->getCapacity() && this->users[slice] > 0, "Released a uniform buffer slice that isn't in use!");
+    if (--this->users[slice] > 0) {
+        return;
+    }
+    for (auto [it, end] = this->slicesByHash.equal_range(this->hash(this->data.data() + this->getOffset(slice))); it != end; ++it) {
+        if (it->second == slice) {
+            this->slicesByHash.erase(it);
+            break;
+        }
+    }
+    this->freeSlices.push_back(slice);
+}
+
+std::uint64_t UniformBufferSlices::hash(const void* contents) const {
+    return Hash::xxh64(std::string_view{static_cast<const char*>(contents), this->dataSize});
+}
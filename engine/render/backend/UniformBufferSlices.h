@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace chira {
+
+/// The CPU side of a uniform buffer split into slices of the same size, each holding one copy of a block.
+/// Slices with the same contents are shared, and shared slices are never written, so changing one owner's
+/// contents means acquiring a new slice and releasing the old one.
+class UniformBufferSlices {
+public:
+    using Slice = unsigned int;
+    static constexpr Slice INVALID_SLICE = ~0u;
+
+    struct Acquired {
+        Slice slice = INVALID_SLICE;
+        /// The slice is new, and its contents have to be uploaded
+        bool written = false;
+        /// There were no free slices left, the whole buffer has to be uploaded again
+        bool grew = false;
+    };
+
+    /// Slices start at multiples of alignment, which has to be a power of two.
+    UniformBufferSlices(std::size_t dataSize, std::size_t alignment, Slice capacity);
+
+    /// Reads getDataSize() bytes from data.
+    [[nodiscard]] Acquired acquire(const void* data);
+    void release(Slice slice);
+
+    [[nodiscard]] std::size_t getOffset(Slice slice) const {
+        return slice * this->sliceSize;
+    }
+    [[nodiscard]] std::size_t getDataSize() const {
+        return this->dataSize;
+    }
+    [[nodiscard]] std::size_t getSliceSize() const {
+        return this->sliceSize;
+    }
+    [[nodiscard]] Slice getCapacity() const {
+        return static_cast<Slice>(this->users.size());
+    }
+    [[nodiscard]] unsigned int getUsers(Slice slice) const {
+        return this->users[slice];
+    }
+    /// What the whole buffer should hold, getCapacity() * getSliceSize() bytes.
+    [[nodiscard]] const std::byte* getData() const {
+        return this->data.data();
+    }
+    [[nodiscard]] std::size_t getSize() const {
+        return this->data.size();
+    }
+
+private:
+    std::size_t dataSize;
+    std::size_t sliceSize;
+    std::vector<std::byte> data;
+    std::vector<unsigned int> users;
+    std::vector<Slice> freeSlices;
+    /// Used slices by the hash of their contents
+    std::unordered_multimap<std::uint64_t, Slice> slicesByHash;
+
+    [[nodiscard]] std::uint64_t hash(const void* contents) const;
+};
+
+} // namespace chira
@@ -0,0 +1,149 @@
+#include "VertexLayout.h"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+using namespace chira;
+
+namespace {
+
+void packAttribute(VertexAttributeFormat format, const float* values, byte* out) {
+    switch (format) {
+        using enum VertexAttributeFormat;
+        case FLOAT2:
+            std::memcpy(out, values, sizeof(float) * 2);
+            break;
+        case FLOAT3:
+            std::memcpy(out, values, sizeof(float) * 3);
+            break;
+        case HALF2: {
+            const std::uint16_t packed[2]{glm::packHalf1x16(values[0]), glm::packHalf1x16(values[1])};
+            std::memcpy(out, packed, sizeof(packed));
+            break;
+        }
+        case SNORM16X4: {
+            const std::uint16_t packed[4]{glm::packSnorm1x16(values[0]), glm::packSnorm1x16(values[1]), glm::packSnorm1x16(values[2]), 0};
+            std::memcpy(out, packed, sizeof(packed));
+            break;
+        }
+        case UNORM8X4: {
+            const std::uint8_t packed[4]{glm::packUnorm1x8(values[0]), glm::packUnorm1x8(values[1]), glm::packUnorm1x8(values[2]), 0xff};
+            std::memcpy(out, packed, sizeof(packed));
+            break;
+        }
+    }
+}
+
+} // namespace
+
+VertexLayout::VertexLayout()
+        : VertexLayout(VertexLayoutType::FULL) {}
+
+VertexLayout::VertexLayout(VertexLayoutType type) {
+    using enum VertexAttribute;
+    using enum VertexAttributeFormat;
+    switch (type) {
+        case VertexLayoutType::FULL:
+            this->add(POSITION, FLOAT3);
+            this->add(NORMAL, FLOAT3);
+            this->add(COLOR, FLOAT3);
+            this->add(UV, FLOAT2);
+            break;
+        case VertexLayoutType::COMPACT:
+            this->add(POSITION, FLOAT3);
+            this->add(NORMAL, SNORM16X4);
+            this->add(COLOR, UNORM8X4);
+            this->add(UV, HALF2);
+            break;
+        case VertexLayoutType::COMPACT_NO_COLOR:
+            this->add(POSITION, FLOAT3);
+            this->add(NORMAL, SNORM16X4);
+            this->add(UV, HALF2);
+            break;
+    }
+}
+
+VertexLayout::VertexLayout(std::initializer_list<std::pair<VertexAttribute, VertexAttributeFormat>> attributes) {
+    for (const auto& [attribute, format] : attributes)
+        this->add(attribute, format);
+}
+
+void VertexLayout::add(VertexAttribute attribute, VertexAttributeFormat format) {
+    this->elements.push_back({attribute, format, this->stride});
+    this->stride += VertexLayout::getSize(format);
+}
+
+bool VertexLayout::has(VertexAttribute attribute) const {
+    return std::any_of(this->elements.begin(), this->elements.end(), [attribute](const Element& element) {
+        return element.attribute == attribute;
+    });
+}
+
+bool VertexLayout::matchesVertex() const {
+    return *this == VertexLayout{} && this->stride == sizeof(Vertex)
+           && this->elements[1].offset == offsetof(Vertex, normal)
+           && this->elements[2].offset == offsetof(Vertex, color)
+           && this->elements[3].offset == offsetof(Vertex, uv);
+}
+
+std::vector<byte> VertexLayout::pack(const std::vector<Vertex>& vertices) const {
+    std::vector<byte> out(vertices.size() * this->stride);
+    if (this->matchesVertex()) {
+        if (!vertices.empty())
+            std::memcpy(out.data(), vertices.data(), out.size());
+        return out;
+    }
+    auto* data = out.data();
+    for (const auto& vertex : vertices) {
+        for (const auto& element : this->elements) {
+            float values[3]{};
+            switch (element.attribute) {
+                using enum VertexAttribute;
+                case POSITION:
+                    values[0] = vertex.position.x;
+                    values[1] = vertex.position.y;
+                    values[2] = vertex.position.z;
+                    break;
+                case NORMAL:
+                    values[0] = vertex.normal.r;
+                    values[1] = vertex.normal.g;
+                    values[2] = vertex.normal.b;
+                    break;
+                case COLOR:
+                    values[0] = vertex.color.r;
+                    values[1] = vertex.color.g;
+                    values[2] = vertex.color.b;
+                    break;
+                case UV:
+                    values[0] = vertex.uv.r;
+                    values[1] = vertex.uv.g;
+                    break;
+            }
+            packAttribute(element.format, values, data + element.offset);
+        }
+        data += this->stride;
+    }
+    return out;
+}
+
+std::size_t VertexLayout::getSize(VertexAttributeFormat format) {
+    switch (format) {
+        using enum VertexAttributeFormat;
+        case FLOAT2:
+        case SNORM16X4:
+            return 8;
+        case FLOAT3:
+            return 12;
+        case HALF2:
+        case UNORM8X4:
+            return 4;
+    }
+    return 0;
+}
+
+bool VertexLayout::operator==(const VertexLayout& other) const {
+    return this->stride == other.stride && std::equal(this->elements.begin(), this->elements.end(), other.elements.begin(), other.elements.end(), [](const Element& lhs, const Element& rhs) {
+        return lhs.attribute == rhs.attribute && lhs.format == rhs.format && lhs.offset == rhs.offset;
+    });
+}
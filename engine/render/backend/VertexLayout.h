@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include <math/Vertex.h>
+#include "RenderTypes.h"
+
+namespace chira {
+
+/// How vertices are stored on the GPU. Vertex is always used to build meshes, and gets packed into this on upload.
+class VertexLayout {
+public:
+    struct Element {
+        VertexAttribute attribute;
+        VertexAttributeFormat format;
+        std::size_t offset;
+    };
+
+    /// The same as Vertex, so meshes can be uploaded without packing them.
+    VertexLayout();
+    explicit VertexLayout(VertexLayoutType type);
+    /// Attributes are stored in this order. Missing attributes get the default value of Vertex in shaders.
+    VertexLayout(std::initializer_list<std::pair<VertexAttribute, VertexAttributeFormat>> attributes);
+
+    [[nodiscard]] const std::vector<Element>& getElements() const {
+        return this->elements;
+    }
+    [[nodiscard]] std::size_t getStride() const {
+        return this->stride;
+    }
+    [[nodiscard]] bool has(VertexAttribute attribute) const;
+    /// If true, vertices can be copied as is.
+    [[nodiscard]] bool matchesVertex() const;
+    [[nodiscard]] std::vector<byte> pack(const std::vector<Vertex>& vertices) const;
+
+    [[nodiscard]] static std::size_t getSize(VertexAttributeFormat format);
+
+    bool operator==(const VertexLayout& other) const;
+private:
+    std::vector<Element> elements;
+    std::size_t stride = 0;
+
+    void add(VertexAttribute attribute, VertexAttributeFormat format);
+};
+
+} // namespace chira
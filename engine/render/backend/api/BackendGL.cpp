@@ -1,12 +1,17 @@
 #include "BackendGL.h"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
-#include <map>
+#include <cstdint>
 #include <stack>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <imgui.h>
 #include <ImGuizmo.h>
+#include <magic_enum.hpp>
 #include <SDL.h>
 #include <backends/imgui_impl_sdl2.h>
 #include <backends/imgui_impl_opengl3.h>
@@ -15,6 +20,7 @@
 #include <glad/gl.h>
 #include <glad/glversion.h>
 
+#include <config/ConEntry.h>
 #include <core/Assertions.h>
 #include <core/Logger.h>
 
@@ -28,6 +34,86 @@ enum class RenderMode {
     TEXTURE_CUBE_MAP_SEAMLESS,
 };
 
+/// The kinds of state changes counted by r_gl_count_state_changes
+enum class GLStateChange {
+    PROGRAM,
+    ACTIVE_TEXTURE,
+    TEXTURE,
+    VERTEX_ARRAY,
+    BUFFER,
+    RENDER_MODE,
+    DEPTH_FUNCTION,
+    CULL_FACE,
+};
+
+static constexpr auto GL_RENDER_MODE_COUNT = magic_enum::enum_count<RenderMode>();
+static constexpr auto GL_TEXTURE_UNIT_COUNT = magic_enum::enum_count<TextureUnit>();
+static constexpr auto GL_STATE_CHANGE_COUNT = magic_enum::enum_count<GLStateChange>();
+
+/// Shadow of the GL state this backend changes, indexed by enum or texture unit so a redundant change costs one compare.
+/// Objects the backend hasn't bound yet (or that something else may have rebound) are UNKNOWN, which never matches.
+struct GLStateCache {
+    static constexpr unsigned int UNKNOWN = ~0u;
+
+    /// Each render mode's pushed values, the last one is what GL currently has
+    std::array<std::vector<bool>, GL_RENDER_MODE_COUNT> renderModes{};
+    int depthFunction = -1;
+    int cullFace = -1;
+
+    unsigned int program = UNKNOWN;
+    unsigned int vertexArray = UNKNOWN;
+    unsigned int arrayBuffer = UNKNOWN;
+    unsigned int uniformBuffer = UNKNOWN;
+    unsigned int activeTexture = UNKNOWN;
+    std::array<unsigned int, GL_TEXTURE_UNIT_COUNT> textures2D{};
+    std::array<unsigned int, GL_TEXTURE_UNIT_COUNT> texturesCubemap{};
+
+    GLStateCache() {
+        this->invalidateBindings();
+    }
+
+    /// Render modes are only changed here, but bindings are also changed by ImGui
+    void invalidateBindings() {
+        this->depthFunction = -1;
+        this->cullFace = -1;
+        this->program = UNKNOWN;
+        this->vertexArray = UNKNOWN;
+        this->arrayBuffer = UNKNOWN;
+        this->uniformBuffer = UNKNOWN;
+        this->activeTexture = UNKNOWN;
+        this->textures2D.fill(UNKNOWN);
+        this->texturesCubemap.fill(UNKNOWN);
+    }
+} g_GLState{};
+
+/// Counters are only touched when r_gl_count_state_changes is on, checking a bool is cheaper than parsing the ConVar
+bool g_GLCountStateChanges = false;
+std::array<std::uint64_t, GL_STATE_CHANGE_COUNT> g_GLStateChangesIssued{};
+std::array<std::uint64_t, GL_STATE_CHANGE_COUNT> g_GLStateChangesSkipped{};
+
+[[maybe_unused]] ConVar r_gl_count_state_changes{"r_gl_count_state_changes", false, "Count GL state changes that were issued or skipped as redundant. See r_gl_state_change_report.", CON_FLAG_NONE, [](ConVar::CallbackArg newValue) {
+    g_GLCountStateChanges = std::stoi(newValue.data());
+}};
+
+[[maybe_unused]] ConCommand r_gl_state_change_report{"r_gl_state_change_report", "Log the GL state changes counted by r_gl_count_state_changes and reset the counts.", [] {
+    if (!g_GLCountStateChanges) {
+        LOG_GL.warning("r_gl_count_state_changes is off, nothing was counted");
+    }
+    for (std::size_t i = 0; i < GL_STATE_CHANGE_COUNT; i++) {
+        LOG_GL.info("{}: {} issued, {} skipped", magic_enum::enum_name(static_cast<GLStateChange>(i)), g_GLStateChangesIssued[i], g_GLStateChangesSkipped[i]);
+    }
+    g_GLStateChangesIssued.fill(0);
+    g_GLStateChangesSkipped.fill(0);
+}};
+
+/// Returns true if the state is different and has to be changed
+[[nodiscard]] static inline bool shouldChangeState(GLStateChange change, bool different) {
+    if (g_GLCountStateChanges) {
+        (different ? g_GLStateChangesIssued : g_GLStateChangesSkipped)[static_cast<std::size_t>(change)]++;
+    }
+    return different;
+}
+
 static void changeRenderMode(RenderMode mode, bool enable) {
     constexpr auto changeRenderModeGL = [](int mode, bool enable) -> void {
         if (enable) {
@@ -46,48 +132,118 @@ static void changeRenderMode(RenderMode mode, bool enable) {
     }
 }
 
-/// State controller to avoid redundant state changes: each state is false by default
-std::map<RenderMode, std::stack<bool>> g_GLStates{
-        { RenderMode::CULL_FACE, {}, },
-        { RenderMode::DEPTH_TEST, {}, },
-        { RenderMode::TEXTURE_CUBE_MAP_SEAMLESS, {}, },
-};
 static void initStates() {
-    g_GLStates[RenderMode::CULL_FACE].push(true);
-    g_GLStates[RenderMode::DEPTH_TEST].push(true);
+    static bool initedStates = false;
+    if (initedStates) {
+        return;
+    }
+    initedStates = true;
+
+    auto& renderModes = g_GLState.renderModes;
+    renderModes[static_cast<std::size_t>(RenderMode::CULL_FACE)].push_back(true);
+    renderModes[static_cast<std::size_t>(RenderMode::DEPTH_TEST)].push_back(true);
 
     // Wiki says modern hardware is fine with this and it looks better
-    g_GLStates[RenderMode::TEXTURE_CUBE_MAP_SEAMLESS].push(true);
+    renderModes[static_cast<std::size_t>(RenderMode::TEXTURE_CUBE_MAP_SEAMLESS)].push_back(true);
 
-    for (const auto& [renderMode, stack] : g_GLStates) {
-        changeRenderMode(renderMode, stack.top());
+    for (std::size_t i = 0; i < GL_RENDER_MODE_COUNT; i++) {
+        runtime_assert(!renderModes[i].empty(), "This render mode was not added to initStates()!!");
+        changeRenderMode(static_cast<RenderMode>(i), renderModes[i].back());
     }
 }
 
 static void pushState(RenderMode mode, bool enable) {
-    static bool initedStates = false;
-    if (!initedStates) {
-        initStates();
-        initedStates = true;
-    }
-    runtime_assert(g_GLStates.contains(mode), "This render mode was not added to initStates()!!");
-    auto& stack = g_GLStates[mode];
-    bool current = stack.top();
-    stack.push(enable);
-    if (enable != current) {
+    initStates();
+    auto& stack = g_GLState.renderModes[static_cast<std::size_t>(mode)];
+    const bool current = stack.back();
+    stack.push_back(enable);
+    if (shouldChangeState(GLStateChange::RENDER_MODE, enable != current)) {
         changeRenderMode(mode, enable);
     }
 }
 
 static void popState(RenderMode mode) {
-    if(!g_GLStates.contains(mode) || g_GLStates[mode].size() <= 1) {
+    auto& stack = g_GLState.renderModes[static_cast<std::size_t>(mode)];
+    if (stack.size() <= 1) {
         runtime_assert(false, "Attempted to pop render state without a corresponding push!");
+        return;
+    }
+    const bool old = stack.back();
+    stack.pop_back();
+    if (shouldChangeState(GLStateChange::RENDER_MODE, stack.back() != old)) {
+        changeRenderMode(mode, stack.back());
+    }
+}
+
+/// Replaces the current value instead of pushing one, for modes set on every draw
+static void setRenderModeGL(RenderMode mode, bool enable) {
+    initStates();
+    auto& stack = g_GLState.renderModes[static_cast<std::size_t>(mode)];
+    if (shouldChangeState(GLStateChange::RENDER_MODE, stack.back() != enable)) {
+        changeRenderMode(mode, enable);
+        stack.back() = enable;
+    }
+}
+
+static void useProgramGL(unsigned int program) {
+    if (shouldChangeState(GLStateChange::PROGRAM, g_GLState.program != program)) {
+        glUseProgram(program);
+        g_GLState.program = program;
+    }
+}
+
+static void bindVertexArrayGL(unsigned int vertexArray) {
+    if (shouldChangeState(GLStateChange::VERTEX_ARRAY, g_GLState.vertexArray != vertexArray)) {
+        glBindVertexArray(vertexArray);
+        g_GLState.vertexArray = vertexArray;
+    }
+}
+
+/// Only GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER, the element buffer binding is part of the bound VAO
+static void bindBufferGL(GLenum target, unsigned int buffer) {
+    runtime_assert(target == GL_ARRAY_BUFFER || target == GL_UNIFORM_BUFFER, "Buffer target is not cached!");
+    auto& bound = target == GL_ARRAY_BUFFER ? g_GLState.arrayBuffer : g_GLState.uniformBuffer;
+    if (shouldChangeState(GLStateChange::BUFFER, bound != buffer)) {
+        glBindBuffer(target, buffer);
+        bound = buffer;
+    }
+}
+
+static void activeTextureGL(unsigned int unit) {
+    if (shouldChangeState(GLStateChange::ACTIVE_TEXTURE, g_GLState.activeTexture != unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        g_GLState.activeTexture = unit;
+    }
+}
+
+/// Only GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP. Doesn't change the active texture unit if the texture is already bound.
+static void bindTextureGL(GLenum target, TextureUnit unit, unsigned int texture) {
+    const auto index = static_cast<unsigned int>(unit);
+    auto& bound = (target == GL_TEXTURE_CUBE_MAP ? g_GLState.texturesCubemap : g_GLState.textures2D)[index];
+    if (shouldChangeState(GLStateChange::TEXTURE, bound != texture)) {
+        activeTextureGL(index);
+        glBindTexture(target, texture);
+        bound = texture;
+    }
+}
+
+/// Deleted textures are unbound from every unit
+static void forgetTextureGL(unsigned int texture) {
+    std::replace(g_GLState.textures2D.begin(), g_GLState.textures2D.end(), texture, 0u);
+    std::replace(g_GLState.texturesCubemap.begin(), g_GLState.texturesCubemap.end(), texture, 0u);
+}
+
+static void setDepthFunctionGL(int function) {
+    if (shouldChangeState(GLStateChange::DEPTH_FUNCTION, g_GLState.depthFunction != function)) {
+        glDepthFunc(function);
+        g_GLState.depthFunction = function;
     }
-    auto& stack = g_GLStates[mode];
-    bool old = stack.top();
-    stack.pop();
-    if (stack.top() != old) {
-        changeRenderMode(mode, stack.top());
+}
+
+static void setCullFaceGL(int face) {
+    if (shouldChangeState(GLStateChange::CULL_FACE, g_GLState.cullFace != face)) {
+        glCullFace(face);
+        g_GLState.cullFace = face;
     }
 }
 
@@ -235,8 +391,7 @@ Renderer::TextureHandle Renderer::createTexture2D(const Image& image, WrapMode w
     const auto glFilter = getFilterModeGL(filter);
     const auto glFormat = getTextureFormatGL(getTextureFormatFromBitDepth(image.getBitDepth()));
 
-    glActiveTexture(GL_TEXTURE0 + static_cast<int>(activeTextureUnit));
-    glBindTexture(GL_TEXTURE_2D, handle.handle);
+    bindTextureGL(GL_TEXTURE_2D, activeTextureUnit, handle.handle);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, getWrapModeGL(wrapS));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, getWrapModeGL(wrapT));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, glFilter);
@@ -262,8 +417,7 @@ Renderer::TextureHandle Renderer::createTextureCubemap(const Image& imageRT, con
 
     const auto glFilter = getFilterModeGL(filter);
 
-    glActiveTexture(GL_TEXTURE0 + static_cast<int>(activeTextureUnit));
-    glBindTexture(GL_TEXTURE_CUBE_MAP, handle.handle);
+    bindTextureGL(GL_TEXTURE_CUBE_MAP, activeTextureUnit, handle.handle);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, getWrapModeGL(wrapS));
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, getWrapModeGL(wrapT));
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, getWrapModeGL(wrapR));
@@ -284,13 +438,12 @@ Renderer::TextureHandle Renderer::createTextureCubemap(const Image& imageRT, con
 
 void Renderer::useTexture(TextureHandle handle, TextureUnit activeTextureUnit) {
     runtime_assert(static_cast<bool>(handle), "Invalid texture handle given to GL renderer!");
-    glActiveTexture(GL_TEXTURE0 + static_cast<int>(activeTextureUnit));
     switch (handle.type) {
         case TextureType::TWO_DIMENSIONAL:
-            glBindTexture(GL_TEXTURE_2D, handle.handle);
+            bindTextureGL(GL_TEXTURE_2D, activeTextureUnit, handle.handle);
             break;
         case TextureType::CUBEMAP:
-            glBindTexture(GL_TEXTURE_CUBE_MAP, handle.handle);
+            bindTextureGL(GL_TEXTURE_CUBE_MAP, activeTextureUnit, handle.handle);
             break;
     }
 }
@@ -302,6 +455,7 @@ void* Renderer::getImGuiTextureHandle(Renderer::TextureHandle handle) {
 
 void Renderer::destroyTexture(Renderer::TextureHandle handle) {
     runtime_assert(static_cast<bool>(handle), "Invalid texture handle given to GL renderer!");
+    forgetTextureGL(handle.handle);
     glDeleteTextures(1, &handle.handle);
 }
 
@@ -315,13 +469,13 @@ Renderer::FrameBufferHandle Renderer::createFrameBuffer(int width, int height, W
     const auto glFilter = getFilterModeGL(filter);
 
     glGenTextures(1, &handle.colorHandle);
-    glBindTexture(GL_TEXTURE_2D, handle.colorHandle);
+    bindTextureGL(GL_TEXTURE_2D, TextureUnit::G0, handle.colorHandle);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, getWrapModeGL(wrapS));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, getWrapModeGL(wrapT));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, glFilter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, glFilter);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    bindTextureGL(GL_TEXTURE_2D, TextureUnit::G0, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, handle.colorHandle, 0);
 
     if (hasDepth) {
@@ -372,8 +526,7 @@ void Renderer::popFrameBuffer() {
 
 void Renderer::useFrameBufferTexture(const Renderer::FrameBufferHandle handle, TextureUnit activeTextureUnit) {
     if (handle.colorHandle != 0) {
-        glActiveTexture(GL_TEXTURE0 + static_cast<int>(activeTextureUnit));
-        glBindTexture(GL_TEXTURE_2D, handle.colorHandle);
+        bindTextureGL(GL_TEXTURE_2D, activeTextureUnit, handle.colorHandle);
     } else if (!handle) {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
@@ -390,6 +543,7 @@ void Renderer::destroyFrameBuffer(Renderer::FrameBufferHandle handle) {
     if (handle.hasDepth) {
         glDeleteRenderbuffers(1, &handle.rboHandle);
     }
+    forgetTextureGL(handle.colorHandle);
     glDeleteTextures(1, &handle.colorHandle);
     glDeleteFramebuffers(1, &handle.fboHandle);
 }
@@ -454,6 +608,41 @@ static void destroyShaderModule(Renderer::ShaderModuleHandle handle) {
     glDeleteShader(handle.handle);
 }
 
+/// Active uniforms of every linked program, so setting one doesn't ask the driver for its location.
+std::unordered_map<int, ShaderUniformTable> g_GLShaderUniforms{};
+
+static void reflectShaderUniforms(int program) {
+    auto& table = g_GLShaderUniforms[program];
+    table.clear();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+    for (int i = 0; i < count; i++) {
+        int length = 0, size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+        std::string uniformName{name.data(), static_cast<std::size_t>(length)};
+        // Uniforms in blocks don't have a location, they're set through uniform buffers
+        const auto location = glGetUniformLocation(program, uniformName.c_str());
+        if (location < 0)
+            continue;
+        if (!uniformName.ends_with("[0]")) {
+            table.add(std::move(uniformName), location);
+            continue;
+        }
+        // Arrays are reported once, add each element and the name without a subscript
+        uniformName.resize(uniformName.size() - 3);
+        table.add(uniformName, location);
+        for (int element = 0; element < size; element++) {
+            auto elementName = uniformName + '[' + std::to_string(element) + ']';
+            if (const auto elementLocation = glGetUniformLocation(program, elementName.c_str()); elementLocation >= 0)
+                table.add(std::move(elementName), elementLocation);
+        }
+    }
+}
+
 Renderer::ShaderHandle Renderer::createShader(std::string_view vertex, std::string_view fragment) {
     ShaderHandle handle{};
     handle.handle = glCreateProgram();
@@ -480,104 +669,176 @@ Renderer::ShaderHandle Renderer::createShader(std::string_view vertex, std::stri
     }
 #endif
 
+    reflectShaderUniforms(handle.handle);
     return handle;
 }
 
 void Renderer::useShader(Renderer::ShaderHandle handle) {
     runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUseProgram(handle.handle);
+    useProgramGL(static_cast<unsigned int>(handle.handle));
 }
 
 void Renderer::destroyShader(Renderer::ShaderHandle handle) {
     runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
     destroyShaderModule(handle.vertex);
     destroyShaderModule(handle.fragment);
+    g_GLShaderUniforms.erase(handle.handle);
+    if (g_GLState.program == static_cast<unsigned int>(handle.handle)) {
+        // A program in use is only deleted once it stops being used, and its name could be given to a new program
+        g_GLState.program = GLStateCache::UNKNOWN;
+    }
     glDeleteProgram(handle.handle);
 }
 
-void Renderer::setShaderUniform1b(Renderer::ShaderHandle handle, std::string_view name, bool value) {
+std::size_t Renderer::getShaderSize(Renderer::ShaderHandle handle) {
     runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform1i(glGetUniformLocation(handle.handle, name.data()), static_cast<int>(value));
+    GLint length = 0;
+    glGetProgramiv(handle.handle, GL_PROGRAM_BINARY_LENGTH, &length);
+    return static_cast<std::size_t>(std::max(length, 0));
 }
 
-void Renderer::setShaderUniform1u(Renderer::ShaderHandle handle, std::string_view name, unsigned int value) {
+Renderer::ShaderUniformHandle Renderer::getShaderUniform(Renderer::ShaderHandle handle, std::string_view name) {
     runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform1ui(glGetUniformLocation(handle.handle, name.data()), value);
+    const auto table = g_GLShaderUniforms.find(handle.handle);
+    if (table == g_GLShaderUniforms.end())
+        return {};
+    return { .location = table->second.find(name) };
+}
+
+void Renderer::setShaderUniform1b(Renderer::ShaderHandle handle, std::string_view name, bool value) {
+    Renderer::setShaderUniform1b(Renderer::getShaderUniform(handle, name), value);
+}
+
+void Renderer::setShaderUniform1u(Renderer::ShaderHandle handle, std::string_view name, unsigned int value) {
+    Renderer::setShaderUniform1u(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform1i(Renderer::ShaderHandle handle, std::string_view name, int value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform1i(glGetUniformLocation(handle.handle, name.data()), value);
+    Renderer::setShaderUniform1i(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform1f(Renderer::ShaderHandle handle, std::string_view name, float value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform1f(glGetUniformLocation(handle.handle, name.data()), value);
+    Renderer::setShaderUniform1f(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform2b(Renderer::ShaderHandle handle, std::string_view name, glm::vec2b value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform2i(glGetUniformLocation(handle.handle, name.data()), static_cast<int>(value.x), static_cast<int>(value.y));
+    Renderer::setShaderUniform2b(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform2u(Renderer::ShaderHandle handle, std::string_view name, glm::vec2u value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform2ui(glGetUniformLocation(handle.handle, name.data()), value.x, value.y);
+    Renderer::setShaderUniform2u(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform2i(Renderer::ShaderHandle handle, std::string_view name, glm::vec2i value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform2i(glGetUniformLocation(handle.handle, name.data()), value.x, value.y);
+    Renderer::setShaderUniform2i(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform2f(Renderer::ShaderHandle handle, std::string_view name, glm::vec2f value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform2f(glGetUniformLocation(handle.handle, name.data()), value.x, value.y);
+    Renderer::setShaderUniform2f(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform3b(Renderer::ShaderHandle handle, std::string_view name, glm::vec3b value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform3i(glGetUniformLocation(handle.handle, name.data()), static_cast<int>(value.x), static_cast<int>(value.y), static_cast<int>(value.z));
+    Renderer::setShaderUniform3b(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform3u(Renderer::ShaderHandle handle, std::string_view name, glm::vec3u value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform3ui(glGetUniformLocation(handle.handle, name.data()), value.x, value.y, value.z);
+    Renderer::setShaderUniform3u(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform3i(Renderer::ShaderHandle handle, std::string_view name, glm::vec3i value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform3i(glGetUniformLocation(handle.handle, name.data()), value.x, value.y, value.z);
+    Renderer::setShaderUniform3i(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform3f(Renderer::ShaderHandle handle, std::string_view name, glm::vec3f value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform3f(glGetUniformLocation(handle.handle, name.data()), value.x, value.y, value.z);
+    Renderer::setShaderUniform3f(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform4b(Renderer::ShaderHandle handle, std::string_view name, glm::vec4b value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform4i(glGetUniformLocation(handle.handle, name.data()), static_cast<int>(value.x), static_cast<int>(value.y), static_cast<int>(value.z), static_cast<int>(value.w));
+    Renderer::setShaderUniform4b(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform4u(Renderer::ShaderHandle handle, std::string_view name, glm::vec4u value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform4ui(glGetUniformLocation(handle.handle, name.data()), value.x, value.y, value.z, value.w);
+    Renderer::setShaderUniform4u(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform4i(Renderer::ShaderHandle handle, std::string_view name, glm::vec4i value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform4i(glGetUniformLocation(handle.handle, name.data()), value.x, value.y, value.z, value.w);
+    Renderer::setShaderUniform4i(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform4f(Renderer::ShaderHandle handle, std::string_view name, glm::vec4f value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniform4f(glGetUniformLocation(handle.handle, name.data()), value.x, value.y, value.z, value.w);
+    Renderer::setShaderUniform4f(Renderer::getShaderUniform(handle, name), value);
 }
 
 void Renderer::setShaderUniform4m(Renderer::ShaderHandle handle, std::string_view name, glm::mat4 value) {
-    runtime_assert(static_cast<bool>(handle), "Invalid shader handle given to GL renderer!");
-    glUniformMatrix4fv(glGetUniformLocation(handle.handle, name.data()), 1, GL_FALSE, glm::value_ptr(value));
+    Renderer::setShaderUniform4m(Renderer::getShaderUniform(handle, name), value);
+}
+
+void Renderer::setShaderUniform1b(Renderer::ShaderUniformHandle uniform, bool value) {
+    glUniform1i(uniform.location, static_cast<int>(value));
+}
+
+void Renderer::setShaderUniform1u(Renderer::ShaderUniformHandle uniform, unsigned int value) {
+    glUniform1ui(uniform.location, value);
+}
+
+void Renderer::setShaderUniform1i(Renderer::ShaderUniformHandle uniform, int value) {
+    glUniform1i(uniform.location, value);
+}
+
+void Renderer::setShaderUniform1f(Renderer::ShaderUniformHandle uniform, float value) {
+    glUniform1f(uniform.location, value);
+}
+
+void Renderer::setShaderUniform2b(Renderer::ShaderUniformHandle uniform, glm::vec2b value) {
+    glUniform2i(uniform.location, static_cast<int>(value.x), static_cast<int>(value.y));
+}
+
+void Renderer::setShaderUniform2u(Renderer::ShaderUniformHandle uniform, glm::vec2u value) {
+    glUniform2ui(uniform.location, value.x, value.y);
+}
+
+void Renderer::setShaderUniform2i(Renderer::ShaderUniformHandle uniform, glm::vec2i value) {
+    glUniform2i(uniform.location, value.x, value.y);
+}
+
+void Renderer::setShaderUniform2f(Renderer::ShaderUniformHandle uniform, glm::vec2f value) {
+    glUniform2f(uniform.location, value.x, value.y);
+}
+
+void Renderer::setShaderUniform3b(Renderer::ShaderUniformHandle uniform, glm::vec3b value) {
+    glUniform3i(uniform.location, static_cast<int>(value.x), static_cast<int>(value.y), static_cast<int>(value.z));
+}
+
+void Renderer::setShaderUniform3u(Renderer::ShaderUniformHandle uniform, glm::vec3u value) {
+    glUniform3ui(uniform.location, value.x, value.y, value.z);
+}
+
+void Renderer::setShaderUniform3i(Renderer::ShaderUniformHandle uniform, glm::vec3i value) {
+    glUniform3i(uniform.location, value.x, value.y, value.z);
+}
+
+void Renderer::setShaderUniform3f(Renderer::ShaderUniformHandle uniform, glm::vec3f value) {
+    glUniform3f(uniform.location, value.x, value.y, value.z);
+}
+
+void Renderer::setShaderUniform4b(Renderer::ShaderUniformHandle uniform, glm::vec4b value) {
+    glUniform4i(uniform.location, static_cast<int>(value.x), static_cast<int>(value.y), static_cast<int>(value.z), static_cast<int>(value.w));
+}
+
+void Renderer::setShaderUniform4u(Renderer::ShaderUniformHandle uniform, glm::vec4u value) {
+    glUniform4ui(uniform.location, value.x, value.y, value.z, value.w);
+}
+
+void Renderer::setShaderUniform4i(Renderer::ShaderUniformHandle uniform, glm::vec4i value) {
+    glUniform4i(uniform.location, value.x, value.y, value.z, value.w);
+}
+
+void Renderer::setShaderUniform4f(Renderer::ShaderUniformHandle uniform, glm::vec4f value) {
+    glUniform4f(uniform.location, value.x, value.y, value.z, value.w);
+}
+
+void Renderer::setShaderUniform4m(Renderer::ShaderUniformHandle uniform, glm::mat4 value) {
+    glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 Renderer::UniformBufferHandle Renderer::createUniformBuffer(std::ptrdiff_t size) {
@@ -588,9 +849,9 @@ Renderer::UniformBufferHandle Renderer::createUniformBuffer(std::ptrdiff_t size)
     handle.bindingPoint = UBO_BINDING_POINT++;
 
     glGenBuffers(1, &handle.handle);
-    glBindBuffer(GL_UNIFORM_BUFFER, handle.handle);
+    bindBufferGL(GL_UNIFORM_BUFFER, handle.handle);
     glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, handle.bindingPoint);
+    // Also binds the buffer to the generic binding point, which is already what the cache has
     glBindBufferRange(GL_UNIFORM_BUFFER, handle.bindingPoint, handle.handle, 0, size);
 
     return handle;
@@ -599,25 +860,48 @@ Renderer::UniformBufferHandle Renderer::createUniformBuffer(std::ptrdiff_t size)
 void Renderer::bindUniformBufferToShader(Renderer::ShaderHandle shaderHandle, Renderer::UniformBufferHandle uniformBufferHandle, std::string_view name) {
     runtime_assert(static_cast<bool>(shaderHandle), "Invalid shader handle given to GL renderer!");
     runtime_assert(static_cast<bool>(uniformBufferHandle), "Invalid uniform buffer handle given to GL renderer!");
-    glUniformBlockBinding(shaderHandle.handle, glGetUniformBlockIndex(shaderHandle.handle, name.data()), uniformBufferHandle.bindingPoint);
+    const auto index = glGetUniformBlockIndex(shaderHandle.handle, name.data());
+    if (index == GL_INVALID_INDEX) {
+        // The block isn't used by this shader
+        return;
+    }
+    glUniformBlockBinding(shaderHandle.handle, index, uniformBufferHandle.bindingPoint);
 }
 
 void Renderer::updateUniformBuffer(Renderer::UniformBufferHandle handle, const void* buffer, std::ptrdiff_t length) {
     runtime_assert(static_cast<bool>(handle), "Invalid uniform buffer handle given to GL renderer!");
-    glBindBuffer(GL_UNIFORM_BUFFER, handle.handle);
+    bindBufferGL(GL_UNIFORM_BUFFER, handle.handle);
     glBufferData(GL_UNIFORM_BUFFER, length, buffer, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void Renderer::updateUniformBufferPart(Renderer::UniformBufferHandle handle, std::ptrdiff_t start, const void* buffer, std::ptrdiff_t length) {
     runtime_assert(static_cast<bool>(handle), "Invalid uniform buffer handle given to GL renderer!");
-    glBindBuffer(GL_UNIFORM_BUFFER, handle.handle);
+    bindBufferGL(GL_UNIFORM_BUFFER, handle.handle);
     glBufferSubData(GL_UNIFORM_BUFFER, start, length, buffer);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Renderer::bindUniformBufferRange(Renderer::UniformBufferHandle handle, std::ptrdiff_t start, std::ptrdiff_t length) {
+    runtime_assert(static_cast<bool>(handle), "Invalid uniform buffer handle given to GL renderer!");
+    glBindBufferRange(GL_UNIFORM_BUFFER, handle.bindingPoint, handle.handle, start, length);
+    // Also binds the generic binding point
+    g_GLState.uniformBuffer = handle.handle;
+}
+
+std::ptrdiff_t Renderer::getUniformBufferOffsetAlignment() {
+    static const std::ptrdiff_t alignment = [] {
+        int value = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+        // The spec allows at most 256
+        return static_cast<std::ptrdiff_t>(value > 0 ? value : 256);
+    }();
+    return alignment;
 }
 
 void Renderer::destroyUniformBuffer(Renderer::UniformBufferHandle handle) {
     runtime_assert(static_cast<bool>(handle), "Invalid uniform buffer handle given to GL renderer!");
+    if (g_GLState.uniformBuffer == handle.handle) {
+        g_GLState.uniformBuffer = 0;
+    }
     glDeleteBuffers(1, &handle.handle);
 }
 
@@ -665,61 +949,127 @@ void Renderer::destroyUniformBuffer(Renderer::UniformBufferHandle handle) {
     return GL_BACK;
 }
 
-Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
-    MeshHandle handle{ .numIndices = static_cast<int>(indices.size()) };
+[[nodiscard]] static constexpr int getVertexAttributeComponentsGL(VertexAttributeFormat format) {
+    switch (format) {
+        case VertexAttributeFormat::FLOAT2:
+        case VertexAttributeFormat::HALF2:
+            return 2;
+        case VertexAttributeFormat::FLOAT3:
+        case VertexAttributeFormat::SNORM16X4:
+        case VertexAttributeFormat::UNORM8X4:
+            // The padding of packed formats isn't read
+            return 3;
+    }
+    return 3;
+}
+
+[[nodiscard]] static constexpr int getVertexAttributeTypeGL(VertexAttributeFormat format) {
+    switch (format) {
+        case VertexAttributeFormat::FLOAT2:
+        case VertexAttributeFormat::FLOAT3:
+            return GL_FLOAT;
+        case VertexAttributeFormat::HALF2:
+            return GL_HALF_FLOAT;
+        case VertexAttributeFormat::SNORM16X4:
+            return GL_SHORT;
+        case VertexAttributeFormat::UNORM8X4:
+            return GL_UNSIGNED_BYTE;
+    }
+    return GL_FLOAT;
+}
+
+[[nodiscard]] static constexpr bool isVertexAttributeNormalizedGL(VertexAttributeFormat format) {
+    return format == VertexAttributeFormat::SNORM16X4 || format == VertexAttributeFormat::UNORM8X4;
+}
+
+/// Expects the VAO and VBO to be bound.
+static void setVertexAttributesGL(const VertexLayout& layout) {
+    for (auto attribute : {VertexAttribute::POSITION, VertexAttribute::NORMAL, VertexAttribute::COLOR, VertexAttribute::UV}) {
+        if (!layout.has(attribute))
+            glDisableVertexAttribArray(static_cast<GLuint>(attribute));
+    }
+    const auto stride = static_cast<GLsizei>(layout.getStride());
+    for (const auto& element : layout.getElements()) {
+        const auto location = static_cast<GLuint>(element.attribute);
+        glVertexAttribPointer(location, getVertexAttributeComponentsGL(element.format), getVertexAttributeTypeGL(element.format),
+                              isVertexAttributeNormalizedGL(element.format) ? GL_TRUE : GL_FALSE, stride, reinterpret_cast<void*>(element.offset));
+        glEnableVertexAttribArray(location);
+    }
+}
+
+static void uploadVerticesGL(const std::vector<Vertex>& vertices, const VertexLayout& layout, int glDrawMode) {
+    if (layout.matchesVertex()) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), glDrawMode);
+        return;
+    }
+    const auto packed = layout.pack(vertices);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(packed.size()), packed.data(), glDrawMode);
+}
+
+Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode, const VertexLayout& layout /*= {}*/) {
+    MeshHandle handle{ .numIndices = static_cast<int>(indices.size()), .hasColors = layout.has(VertexAttribute::COLOR) };
     glGenVertexArrays(1, &handle.vaoHandle);
     glGenBuffers(1, &handle.vboHandle);
     glGenBuffers(1, &handle.eboHandle);
 
-    glBindVertexArray(handle.vaoHandle);
+    bindVertexArrayGL(handle.vaoHandle);
 
     const auto glDrawMode = getMeshDrawModeGL(drawMode);
 
-    glBindBuffer(GL_ARRAY_BUFFER, handle.vboHandle);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), glDrawMode);
+    bindBufferGL(GL_ARRAY_BUFFER, handle.vboHandle);
+    uploadVerticesGL(vertices, layout, glDrawMode);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle.eboHandle);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(Index)), indices.data(), glDrawMode);
 
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
-    glEnableVertexAttribArray(0);
-    // normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
-    glEnableVertexAttribArray(2);
-    // texture coord attribute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, uv)));
-    glEnableVertexAttribArray(3);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    setVertexAttributesGL(layout);
+
+    bindBufferGL(GL_ARRAY_BUFFER, 0);
+    bindVertexArrayGL(0);
     return handle;
 }
 
-void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
+void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode, const VertexLayout& layout /*= {}*/) {
     runtime_assert(static_cast<bool>(*handle), "Invalid mesh handle given to GL renderer!");
     const auto glDrawMode = getMeshDrawModeGL(drawMode);
-    glBindBuffer(GL_ARRAY_BUFFER, handle->vboHandle);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), glDrawMode);
+    // The layout may have changed, so the attributes are set again
+    bindVertexArrayGL(handle->vaoHandle);
+    bindBufferGL(GL_ARRAY_BUFFER, handle->vboHandle);
+    uploadVerticesGL(vertices, layout, glDrawMode);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle->eboHandle);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(Index)), indices.data(), glDrawMode);
+    setVertexAttributesGL(layout);
+    bindBufferGL(GL_ARRAY_BUFFER, 0);
+    bindVertexArrayGL(0);
     handle->numIndices = static_cast<int>(indices.size());
+    handle->hasColors = layout.has(VertexAttribute::COLOR);
 }
 
 void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType) {
+    Renderer::drawMesh(handle, depthFunction, cullType, 0, handle.numIndices);
+}
+
+void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType, int firstIndex, int indexCount) {
     runtime_assert(static_cast<bool>(handle), "Invalid mesh handle given to GL renderer!");
-    pushState(RenderMode::CULL_FACE, true);
-    glDepthFunc(getMeshDepthFunctionGL(depthFunction));
-    glCullFace(getMeshCullTypeGL(cullType));
-    glBindVertexArray(handle.vaoHandle);
-    glDrawElements(GL_TRIANGLES, handle.numIndices, GL_UNSIGNED_INT, nullptr);
-    popState(RenderMode::CULL_FACE);
+    runtime_assert(firstIndex >= 0 && indexCount >= 0 && firstIndex + indexCount <= handle.numIndices, "Index range is outside of the mesh!");
+    setRenderModeGL(RenderMode::CULL_FACE, true);
+    setDepthFunctionGL(getMeshDepthFunctionGL(depthFunction));
+    setCullFaceGL(getMeshCullTypeGL(cullType));
+    if (!handle.hasColors) {
+        // Disabled attributes read the current value instead, so meshes without colors are white like Vertex
+        glVertexAttrib3f(static_cast<GLuint>(VertexAttribute::COLOR), 1.f, 1.f, 1.f);
+    }
+    bindVertexArrayGL(handle.vaoHandle);
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(static_cast<std::size_t>(firstIndex) * sizeof(Index)));
 }
 
 void Renderer::destroyMesh(MeshHandle handle) {
     runtime_assert(static_cast<bool>(handle), "Invalid mesh handle given to GL renderer!");
+    if (g_GLState.vertexArray == handle.vaoHandle) {
+        g_GLState.vertexArray = 0;
+    }
+    if (g_GLState.arrayBuffer == handle.vboHandle) {
+        g_GLState.arrayBuffer = 0;
+    }
     glDeleteVertexArrays(1, &handle.vaoHandle);
     glDeleteBuffers(1, &handle.vboHandle);
     glDeleteBuffers(1, &handle.eboHandle);
@@ -741,6 +1091,8 @@ void Renderer::startImGuiFrame() {
 void Renderer::endImGuiFrame() {
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    // ImGui restores what it changes, but it doesn't go through the cache
+    g_GLState.invalidateBindings();
 }
 
 void Renderer::destroyImGui() {
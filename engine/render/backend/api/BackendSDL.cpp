@@ -311,6 +311,10 @@ void Renderer::destroyShader(Renderer::ShaderHandle handle) {
     UNSUPPORTED(destroyShader);
 }
 
+std::size_t Renderer::getShaderSize(Renderer::ShaderHandle handle) {
+    return 0;
+}
+
 void Renderer::setShaderUniform1b(Renderer::ShaderHandle handle, std::string_view name, bool value) {
     // Don't print unsupported on this as it spams the console
     //UNSUPPORTED(setShaderUniform1b);
@@ -396,6 +400,97 @@ void Renderer::setShaderUniform4m(Renderer::ShaderHandle handle, std::string_vie
     //UNSUPPORTED(setShaderUniform4m);
 }
 
+Renderer::ShaderUniformHandle Renderer::getShaderUniform(Renderer::ShaderHandle handle, std::string_view name) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(getShaderUniform);
+    return {};
+}
+
+void Renderer::setShaderUniform1b(Renderer::ShaderUniformHandle uniform, bool value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform1b);
+}
+
+void Renderer::setShaderUniform1u(Renderer::ShaderUniformHandle uniform, unsigned int value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform1u);
+}
+
+void Renderer::setShaderUniform1i(Renderer::ShaderUniformHandle uniform, int value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform1i);
+}
+
+void Renderer::setShaderUniform1f(Renderer::ShaderUniformHandle uniform, float value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform1f);
+}
+
+void Renderer::setShaderUniform2b(Renderer::ShaderUniformHandle uniform, glm::vec2b value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform2b);
+}
+
+void Renderer::setShaderUniform2u(Renderer::ShaderUniformHandle uniform, glm::vec2u value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform2u);
+}
+
+void Renderer::setShaderUniform2i(Renderer::ShaderUniformHandle uniform, glm::vec2i value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform2i);
+}
+
+void Renderer::setShaderUniform2f(Renderer::ShaderUniformHandle uniform, glm::vec2f value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform2f);
+}
+
+void Renderer::setShaderUniform3b(Renderer::ShaderUniformHandle uniform, glm::vec3b value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform3b);
+}
+
+void Renderer::setShaderUniform3u(Renderer::ShaderUniformHandle uniform, glm::vec3u value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform3u);
+}
+
+void Renderer::setShaderUniform3i(Renderer::ShaderUniformHandle uniform, glm::vec3i value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform3i);
+}
+
+void Renderer::setShaderUniform3f(Renderer::ShaderUniformHandle uniform, glm::vec3f value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform3f);
+}
+
+void Renderer::setShaderUniform4b(Renderer::ShaderUniformHandle uniform, glm::vec4b value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform4b);
+}
+
+void Renderer::setShaderUniform4u(Renderer::ShaderUniformHandle uniform, glm::vec4u value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform4u);
+}
+
+void Renderer::setShaderUniform4i(Renderer::ShaderUniformHandle uniform, glm::vec4i value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform4i);
+}
+
+void Renderer::setShaderUniform4f(Renderer::ShaderUniformHandle uniform, glm::vec4f value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform4f);
+}
+
+void Renderer::setShaderUniform4m(Renderer::ShaderUniformHandle uniform, glm::mat4 value) {
+    // Don't print unsupported on this as it spams the console
+    //UNSUPPORTED(setShaderUniform4m);
+}
+
 Renderer::UniformBufferHandle Renderer::createUniformBuffer(std::ptrdiff_t size) {
     UniformBufferHandle handle{};
 
@@ -416,11 +511,19 @@ void Renderer::updateUniformBufferPart(Renderer::UniformBufferHandle handle, std
     //STUBFUNC(updateUniformBufferPart);
 }
 
+void Renderer::bindUniformBufferRange(Renderer::UniformBufferHandle handle, std::ptrdiff_t start, std::ptrdiff_t length) {
+    //STUBFUNC(bindUniformBufferRange);
+}
+
+std::ptrdiff_t Renderer::getUniformBufferOffsetAlignment() {
+    return 1;
+}
+
 void Renderer::destroyUniformBuffer(Renderer::UniformBufferHandle handle) {
     STUBFUNC(destroyUniformBuffer);
 }
 
-Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
+Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode, const VertexLayout& layout /*= {}*/) {
     MeshHandle handle{ 
         .numIndices = static_cast<int>(indices.size()),
         .numVertices = static_cast<int>(vertices.size())
@@ -435,7 +538,7 @@ Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, c
     return handle;
 }
 
-void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
+void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode, const VertexLayout& layout /*= {}*/) {
     runtime_assert(static_cast<bool>(*handle), "Invalid mesh handle given to SDL renderer!");
     handle->indices.clear();
     for (Index i : indices) {
@@ -450,7 +553,12 @@ void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertice
 }
 
 void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType) {
+    Renderer::drawMesh(handle, depthFunction, cullType, 0, handle.numIndices);
+}
+
+void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType, int firstIndex, int indexCount) {
     runtime_assert(static_cast<bool>(handle), "Invalid mesh handle given to SDL renderer!");
+    runtime_assert(firstIndex >= 0 && indexCount >= 0 && firstIndex + indexCount <= handle.numIndices, "Index range is outside of the mesh!");
     std::vector<SDL_Vertex> vertices;
 
     for (Vertex v : handle.vertices) {
@@ -471,7 +579,7 @@ void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, Mesh
 
     SDL_RenderGeometry(g_Renderer, nullptr, 
         vertices.data(), handle.numVertices,
-        handle.indices.data(), handle.numIndices
+        handle.indices.data() + firstIndex, indexCount
     );
 }
 
@@ -7,6 +7,8 @@
 #include <math/Color.h>
 #include <math/Vertex.h>
 #include "../RenderTypes.h"
+#include "../ShaderUniformTable.h"
+#include "../VertexLayout.h"
 
 struct SDL_Window;
 struct SDL_Renderer;
@@ -53,6 +55,13 @@ struct ShaderHandle {
     inline bool operator!() const { return !handle || !vertex || !fragment; }
 };
 
+struct ShaderUniformHandle {
+    int location = ShaderUniformTable::INVALID_LOCATION;
+
+    explicit inline operator bool() const { return location >= 0; }
+    inline bool operator!() const { return location < 0; }
+};
+
 struct UniformBufferHandle {
     unsigned int handle = 0;
     unsigned int bindingPoint = 0;
@@ -99,6 +108,8 @@ void destroyFrameBuffer(FrameBufferHandle handle);
 [[nodiscard]] ShaderHandle createShader(std::string_view vertex, std::string_view fragment);
 void useShader(ShaderHandle handle);
 void destroyShader(ShaderHandle handle);
+/// The size of the linked program's binary, the closest thing to its GPU memory the driver reports. 0 if it doesn't.
+[[nodiscard]] std::size_t getShaderSize(ShaderHandle handle);
 
 void setShaderUniform1b(ShaderHandle handle, std::string_view name, bool value);
 void setShaderUniform1u(ShaderHandle handle, std::string_view name, unsigned int value);
@@ -118,15 +129,42 @@ void setShaderUniform4i(ShaderHandle handle, std::string_view name, glm::vec4i v
 void setShaderUniform4f(ShaderHandle handle, std::string_view name, glm::vec4f value);
 void setShaderUniform4m(ShaderHandle handle, std::string_view name, glm::mat4 value);
 
+/// Looked up in the uniforms reflected when the shader was linked, not in the driver.
+[[nodiscard]] ShaderUniformHandle getShaderUniform(ShaderHandle handle, std::string_view name);
+/// The shader the uniform came from must be in use.
+void setShaderUniform1b(ShaderUniformHandle uniform, bool value);
+void setShaderUniform1u(ShaderUniformHandle uniform, unsigned int value);
+void setShaderUniform1i(ShaderUniformHandle uniform, int value);
+void setShaderUniform1f(ShaderUniformHandle uniform, float value);
+void setShaderUniform2b(ShaderUniformHandle uniform, glm::vec2b value);
+void setShaderUniform2u(ShaderUniformHandle uniform, glm::vec2u value);
+void setShaderUniform2i(ShaderUniformHandle uniform, glm::vec2i value);
+void setShaderUniform2f(ShaderUniformHandle uniform, glm::vec2f value);
+void setShaderUniform3b(ShaderUniformHandle uniform, glm::vec3b value);
+void setShaderUniform3u(ShaderUniformHandle uniform, glm::vec3u value);
+void setShaderUniform3i(ShaderUniformHandle uniform, glm::vec3i value);
+void setShaderUniform3f(ShaderUniformHandle uniform, glm::vec3f value);
+void setShaderUniform4b(ShaderUniformHandle uniform, glm::vec4b value);
+void setShaderUniform4u(ShaderUniformHandle uniform, glm::vec4u value);
+void setShaderUniform4i(ShaderUniformHandle uniform, glm::vec4i value);
+void setShaderUniform4f(ShaderUniformHandle uniform, glm::vec4f value);
+void setShaderUniform4m(ShaderUniformHandle uniform, glm::mat4 value);
+
 [[nodiscard]] UniformBufferHandle createUniformBuffer(std::ptrdiff_t size);
 void bindUniformBufferToShader(ShaderHandle shaderHandle, UniformBufferHandle uniformBufferHandle, std::string_view name);
 void updateUniformBuffer(UniformBufferHandle handle, const void* buffer, std::ptrdiff_t length);
 void updateUniformBufferPart(UniformBufferHandle handle, std::ptrdiff_t start, const void* buffer, std::ptrdiff_t length);
+/// Points the buffer's binding point at part of it, start has to be a multiple of getUniformBufferOffsetAlignment().
+void bindUniformBufferRange(UniformBufferHandle handle, std::ptrdiff_t start, std::ptrdiff_t length);
+[[nodiscard]] std::ptrdiff_t getUniformBufferOffsetAlignment();
 void destroyUniformBuffer(UniformBufferHandle handle);
 
-[[nodiscard]] MeshHandle createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode);
-void updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode);
+/// The vertex layout is ignored, vertices are kept as they are.
+[[nodiscard]] MeshHandle createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode, const VertexLayout& layout = {});
+void updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode, const VertexLayout& layout = {});
 void drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType);
+/// Only draws the given range of indices.
+void drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType, int firstIndex, int indexCount);
 void destroyMesh(MeshHandle handle);
 
 void initImGui(SDL_Window* window, SDL_Renderer* renderer);
@@ -41,7 +41,8 @@ using MaterialFactory = AbstractFactory<SharedPointer<IMaterial>>;
                 return chira::Resource::getResource<ResourceClassName>(materialId)           \
                        .cast<chira::IMaterial>();                                            \
             }                                                                                \
-        )
+        );                                                                                   \
+    CHIRA_REGISTER_RESOURCE_TYPE(ResourceClassName)
 
 #define CHIRA_GET_MATERIAL(type, identifier) \
     chira::MaterialFactory::getTypeFactory(type)(identifier)
@@ -4,22 +4,45 @@
 
 using namespace chira;
 
+namespace {
+
+/// Matches the std140 layout of PHONG_MATERIAL, padded to a vec4 so the bound range covers the whole block
+struct PhongMaterialParameters {
+    float shininess;
+    float lambertFactor;
+    float padding[2];
+};
+
+} // namespace
+
+MaterialPhong::~MaterialPhong() {
+    if (this->parametersSlice != UniformBufferPool::INVALID_SLICE) {
+        MaterialPhong::getParameterPool().release(this->parametersSlice);
+    }
+}
+
 void MaterialPhong::compile(const byte buffer[], std::size_t bufferLength) {
     Serial::loadFromBuffer(this, buffer, bufferLength);
 
     this->shader = Resource::getResource<Shader>(this->shaderPath);
     this->setTextureDiffuse(this->diffusePath);
     this->setTextureSpecular(this->specularPath);
-    this->setShininess(this->shininess);
-    this->setLambertFactor(this->lambertFactor);
+    this->updateParameters();
 }
 
 void MaterialPhong::use() const {
     IMaterial::use();
     this->diffuse->use(TextureUnit::G0);
     this->specular->use(TextureUnit::G1);
-    this->shader->setUniform("material.shininess", this->shininess);
-    this->shader->setUniform("material.lambertFactor", this->lambertFactor);
+    auto& pool = MaterialPhong::getParameterPool();
+    if (this->uniformRevision != this->shader->getRevision()) {
+        // Reloading the shader resets the texture units and block bindings too
+        this->shader->setUniform("material.diffuse", 0);
+        this->shader->setUniform("material.specular", 1);
+        pool.bindToShader(this->shader->getHandle());
+        this->uniformRevision = this->shader->getRevision();
+    }
+    pool.bind(this->parametersSlice);
 }
 
 SharedPointer<Texture> MaterialPhong::getTextureDiffuse() const {
@@ -29,8 +52,6 @@ SharedPointer<Texture> MaterialPhong::getTextureDiffuse() const {
 void MaterialPhong::setTextureDiffuse(std::string path) {
     this->diffusePath = std::move(path);
     this->diffuse = Resource::getResource<Texture>(this->diffusePath);
-    this->shader->use();
-    this->shader->setUniform("material.diffuse", 0);
 }
 
 SharedPointer<Texture> MaterialPhong::getTextureSpecular() const {
@@ -40,8 +61,6 @@ SharedPointer<Texture> MaterialPhong::getTextureSpecular() const {
 void MaterialPhong::setTextureSpecular(std::string path) {
     this->specularPath = std::move(path);
     this->specular = Resource::getResource<Texture>(this->specularPath);
-    this->shader->use();
-    this->shader->setUniform("material.specular", 1);
 }
 
 float MaterialPhong::getShininess() const {
@@ -50,8 +69,7 @@ float MaterialPhong::getShininess() const {
 
 void MaterialPhong::setShininess(float shininess_) {
     this->shininess = shininess_;
-    this->shader->use();
-    this->shader->setUniform("material.shininess", this->shininess);
+    this->updateParameters();
 }
 
 float MaterialPhong::getLambertFactor() const {
@@ -60,6 +78,19 @@ float MaterialPhong::getLambertFactor() const {
 
 void MaterialPhong::setLambertFactor(float lambertFactor_) {
     this->lambertFactor = lambertFactor_;
-    this->shader->use();
-    this->shader->setUniform("material.lambertFactor", this->lambertFactor);
+    this->updateParameters();
+}
+
+void MaterialPhong::updateParameters() {
+    const PhongMaterialParameters parameters{
+        .shininess = this->shininess,
+        .lambertFactor = this->lambertFactor,
+        .padding = {},
+    };
+    this->parametersSlice = MaterialPhong::getParameterPool().update(this->parametersSlice, &parameters);
+}
+
+UniformBufferPool& MaterialPhong::getParameterPool() {
+    static UniformBufferPool pool{"PHONG_MATERIAL", sizeof(PhongMaterialParameters), 64};
+    return pool;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <render/shader/UBO.h>
 #include <render/texture/Texture.h>
 #include "MaterialUntextured.h"
 
@@ -8,6 +9,7 @@ namespace chira {
 class MaterialPhong final : public IMaterial {
 public:
     explicit MaterialPhong(std::string identifier_) : IMaterial(std::move(identifier_)) {}
+    ~MaterialPhong() override;
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const override;
     [[nodiscard]] SharedPointer<Texture> getTextureDiffuse() const;
@@ -26,6 +28,14 @@ protected:
     std::string specularPath{"file://textures/missing.json"};
     float shininess = 32.f;
     float lambertFactor = 1.f;
+    /// The shader revision the samplers and parameter block were set up for.
+    mutable unsigned int uniformRevision = 0;
+    /// Where shininess and lambertFactor are stored in the parameter pool.
+    UniformBufferPool::Slice parametersSlice = UniformBufferPool::INVALID_SLICE;
+
+    void updateParameters();
+    /// Every phong material's parameters, the PHONG_MATERIAL block in phonglit.fsh
+    static UniformBufferPool& getParameterPool();
 
 public:
     template<typename Archive>
@@ -1,37 +1,56 @@
 #include "MeshData.h"
 
 #include <algorithm>
+#include <limits>
 #include <string>
 #include <config/ConEntry.h>
 #include <math/Matrix.h>
+#include <resource/ResourceLoadProfiler.h>
+#include "MeshSimplifier.h"
 
 using namespace chira;
 
+ConVar r_lod_bias{"r_lod_bias", 1.0, "How many pixels mesh LODs may differ from the full mesh on screen. 0 always draws the full mesh.", CON_FLAG_CACHE};
+
 void MeshData::setupForRendering() {
-    this->handle = Renderer::createMesh(this->vertices, this->indices, MeshDrawMode::STATIC);
+    this->updateBounds();
+    ResourceLoadProfiler::StageScope backend{ResourceLoadStage::BACKEND};
+    this->handle = Renderer::createMesh(this->vertices, this->indices, MeshDrawMode::STATIC, this->vertexLayout);
     this->initialized = true;
 }
 
 void MeshData::updateMeshData() {
+    this->updateBounds();
     if (!this->initialized)
         return;
-    Renderer::updateMesh(&this->handle, this->vertices, this->indices, this->drawMode);
+    ResourceLoadProfiler::StageScope backend{ResourceLoadStage::BACKEND};
+    Renderer::updateMesh(&this->handle, this->vertices, this->indices, this->drawMode, this->vertexLayout);
 }
 
-void MeshData::render(glm::mat4 model, MeshCullType cullType /*= MeshCullType::BACK*/) {
+void MeshData::render(glm::mat4 model, MeshCullType cullType /*= MeshCullType::BACK*/, std::size_t lod /*= 0*/) {
+    if (this->material)
+        this->material->use();
+    this->draw(model, cullType, lod);
+}
+
+void MeshData::draw(glm::mat4 model, MeshCullType cullType /*= MeshCullType::BACK*/, std::size_t lod /*= 0*/) {
     if (!this->initialized)
         this->setupForRendering();
-    if (this->material) {
-        this->material->use();
-        if (this->material->getShader()->usesModelMatrix())
-            this->material->getShader()->setUniform("m", model);
+    if (this->material && this->material->getShader()->usesModelMatrix())
+        this->material->getShader()->setModelMatrix(model);
+    if (this->lods.empty()) {
+        Renderer::drawMesh(this->handle, this->depthFunction, cullType);
+    } else {
+        const auto& level = this->lods[std::min(lod, this->lods.size() - 1)];
+        Renderer::drawMesh(this->handle, this->depthFunction, cullType, static_cast<int>(level.firstIndex), static_cast<int>(level.indexCount));
     }
-    Renderer::drawMesh(this->handle, this->depthFunction, cullType);
 }
 
 MeshData::~MeshData() {
     if (this->initialized) {
-        Renderer::destroyMesh(this->handle);
+        Resource::deferDestruction([handle = this->handle] {
+            Renderer::destroyMesh(handle);
+        });
     }
 }
 
@@ -51,15 +70,138 @@ void MeshData::setDepthFunction(MeshDepthFunction function) {
     this->depthFunction = function;
 }
 
+const VertexLayout& MeshData::getVertexLayout() const {
+    return this->vertexLayout;
+}
+
+void MeshData::setVertexLayout(const VertexLayout& layout) {
+    if (this->vertexLayout == layout)
+        return;
+    this->vertexLayout = layout;
+    this->updateMeshData();
+}
+
 std::vector<byte> MeshData::getMeshData(const std::string& meshLoader) const {
-    return IMeshLoader::getMeshLoader(meshLoader)->createMesh(this->vertices, this->indices);
+    return IMeshLoader::getMeshLoader(meshLoader)->createMeshWithLODs(this->vertices, this->indices, this->lods);
 }
 
 void MeshData::appendMeshData(const std::string& loader, const std::string& identifier) {
-    IMeshLoader::getMeshLoader(loader)->loadMesh(identifier, this->vertices, this->indices);
+    // LODs are only kept for a single mesh, appending to one keeps the full detail of both
+    if (!this->indices.empty())
+        this->removeLODs();
+    const auto firstIndex = this->indices.size();
+    std::vector<MeshLOD> loadedLODs;
+    IMeshLoader::getMeshLoader(loader)->loadMeshWithLODs(identifier, this->vertices, this->indices, loadedLODs);
+    if (!firstIndex)
+        this->lods = std::move(loadedLODs);
+    else if (!loadedLODs.empty())
+        this->indices.resize(firstIndex + loadedLODs[0].indexCount);
+}
+
+void MeshData::optimizeMeshData(unsigned int cacheSize /*= MeshOptimizer::DEFAULT_CACHE_SIZE*/) {
+    if (this->lods.empty()) {
+        MeshOptimizer::optimize(this->vertices, this->indices, cacheSize);
+    } else {
+        // Each LOD is drawn on its own
+        for (const auto& lod : this->lods) {
+            const auto first = this->indices.begin() + lod.firstIndex;
+            std::vector<Index> range{first, first + lod.indexCount};
+            MeshOptimizer::optimizeVertexCache(range, this->vertices.size(), cacheSize);
+            MeshOptimizer::optimizeOverdraw(range, this->vertices, cacheSize);
+            std::copy(range.begin(), range.end(), first);
+        }
+        MeshOptimizer::optimizeVertexFetch(this->vertices, this->indices);
+    }
+    this->updateMeshData();
+}
+
+VertexCacheStatistics MeshData::getVertexCacheStatistics(unsigned int cacheSize /*= MeshOptimizer::DEFAULT_CACHE_SIZE*/) const {
+    if (this->lods.empty())
+        return MeshOptimizer::analyzeVertexCache(this->indices, this->vertices.size(), cacheSize);
+    const auto first = this->indices.begin() + this->lods[0].firstIndex;
+    return MeshOptimizer::analyzeVertexCache({first, first + this->lods[0].indexCount}, this->vertices.size(), cacheSize);
+}
+
+void MeshData::generateLODs(std::size_t count, float reduction /*= 0.5f*/) {
+    this->removeLODs();
+    this->updateBounds();
+    if (this->indices.empty() || !count)
+        return;
+
+    const std::vector<Index> fullMesh = this->indices;
+    this->lods.push_back({0, static_cast<Index>(fullMesh.size()), 0.f});
+    auto targetIndexCount = static_cast<float>(fullMesh.size());
+    for (std::size_t i = 0; i < count; i++) {
+        targetIndexCount *= reduction;
+        // Always from the full mesh, so the error is measured against it
+        float error = 0.f;
+        const auto simplified = MeshSimplifier::simplify(this->vertices, fullMesh, static_cast<std::size_t>(targetIndexCount), std::numeric_limits<float>::max(), &error);
+        if (simplified.empty() || simplified.size() >= this->lods.back().indexCount)
+            break;
+        const auto relativeError = this->boundingRadius > 0.f ? error / this->boundingRadius : 0.f;
+        this->lods.push_back({static_cast<Index>(this->indices.size()), static_cast<Index>(simplified.size()), std::max(relativeError, this->lods.back().error)});
+        this->indices.insert(this->indices.end(), simplified.begin(), simplified.end());
+    }
+    if (this->lods.size() == 1)
+        this->lods.clear();
+    this->updateMeshData();
+}
+
+const std::vector<MeshLOD>& MeshData::getLODs() const {
+    return this->lods;
+}
+
+std::size_t MeshData::selectLOD(float projectedRadius) const {
+    const auto allowedError = static_cast<float>(r_lod_bias.getValue<double>());
+    std::size_t lod = 0;
+    while (allowedError > 0.f && lod + 1 < this->lods.size() && this->lods[lod + 1].error * projectedRadius <= allowedError)
+        lod++;
+    return lod;
+}
+
+glm::vec3 MeshData::getBoundingCenter() const {
+    return this->boundingCenter;
+}
+
+float MeshData::getBoundingRadius() const {
+    return this->boundingRadius;
+}
+
+ResourceMemoryUsage MeshData::getMeshMemoryUsage() const {
+    const auto size = this->vertices.capacity() * sizeof(Vertex) + this->indices.capacity() * sizeof(Index);
+    return {size, this->initialized ? this->vertices.size() * this->vertexLayout.getStride() + this->indices.size() * sizeof(Index) : 0};
 }
 
 void MeshData::clearMeshData() {
     this->vertices.clear();
     this->indices.clear();
+    this->lods.clear();
+}
+
+void MeshData::removeLODs() {
+    if (this->lods.empty())
+        return;
+    this->indices.resize(this->lods[0].firstIndex + this->lods[0].indexCount);
+    this->lods.clear();
+}
+
+void MeshData::updateBounds() {
+    if (this->vertices.empty()) {
+        this->boundingCenter = glm::vec3{};
+        this->boundingRadius = 0.f;
+        return;
+    }
+    glm::vec3 min = this->vertices[0].position;
+    glm::vec3 max = this->vertices[0].position;
+    for (const auto& vertex : this->vertices) {
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::min(min[i], vertex.position[i]);
+            max[i] = std::max(max[i], vertex.position[i]);
+        }
+    }
+    this->boundingCenter = (min + max) / 2.f;
+    float radius = 0.f;
+    for (const auto& vertex : this->vertices)
+        radius = std::max(radius, glm::length(vertex.position - this->boundingCenter));
+    this->boundingRadius = radius;
 }
@@ -4,35 +4,65 @@
 #include <vector>
 #include <loader/mesh/IMeshLoader.h>
 #include <render/backend/RenderTypes.h>
+#include <render/backend/VertexLayout.h>
 #include <render/material/MaterialFactory.h>
+#include "MeshOptimizer.h"
 
 namespace chira {
 
 class MeshData {
 public:
     MeshData() = default;
-    void render(glm::mat4 model, MeshCullType cullType = MeshCullType::BACK);
+    /// LODs past the last one draw the last one.
+    void render(glm::mat4 model, MeshCullType cullType = MeshCullType::BACK, std::size_t lod = 0);
+    /// Like render(), but the material has to be in use already.
+    void draw(glm::mat4 model, MeshCullType cullType = MeshCullType::BACK, std::size_t lod = 0);
     virtual ~MeshData();
     [[nodiscard]] SharedPointer<IMaterial> getMaterial() const;
     void setMaterial(SharedPointer<IMaterial> newMaterial);
     [[nodiscard]] MeshDepthFunction getDepthFunction() const;
     void setDepthFunction(MeshDepthFunction function);
+    [[nodiscard]] const VertexLayout& getVertexLayout() const;
+    /// How the vertices are stored on the GPU. Calls updateMeshData().
+    void setVertexLayout(const VertexLayout& layout);
     [[nodiscard]] std::vector<byte> getMeshData(const std::string& meshLoader) const;
+    /// The vertex and index buffers, on the CPU and on the GPU once uploaded.
+    [[nodiscard]] ResourceMemoryUsage getMeshMemoryUsage() const;
     void appendMeshData(const std::string& loader, const std::string& identifier);
+    /// Reorders the mesh for the vertex cache, overdraw and vertex fetch. Calls updateMeshData().
+    void optimizeMeshData(unsigned int cacheSize = MeshOptimizer::DEFAULT_CACHE_SIZE);
+    [[nodiscard]] VertexCacheStatistics getVertexCacheStatistics(unsigned int cacheSize = MeshOptimizer::DEFAULT_CACHE_SIZE) const;
+    /// Replaces any LODs with up to count simplified versions of the full mesh, each with about reduction times as
+    /// many triangles as the one before. Stops early once the mesh can't get any simpler. Calls updateMeshData().
+    void generateLODs(std::size_t count, float reduction = 0.5f);
+    /// Empty if the mesh has no LODs, otherwise the first one is the full mesh.
+    [[nodiscard]] const std::vector<MeshLOD>& getLODs() const;
+    /// The simplest LOD that stays within r_lod_bias pixels of the full mesh, given how many pixels tall the
+    /// bounding sphere radius is on screen.
+    [[nodiscard]] std::size_t selectLOD(float projectedRadius) const;
+    [[nodiscard]] glm::vec3 getBoundingCenter() const;
+    [[nodiscard]] float getBoundingRadius() const;
 protected:
     bool initialized = false;
     Renderer::MeshHandle handle{};
     MeshDrawMode drawMode = MeshDrawMode::STATIC;
     MeshDepthFunction depthFunction = MeshDepthFunction::LEQUAL;
+    VertexLayout vertexLayout;
     SharedPointer<IMaterial> material;
     std::vector<Vertex> vertices;
     std::vector<Index> indices;
+    std::vector<MeshLOD> lods;
+    glm::vec3 boundingCenter{};
+    float boundingRadius = 0.f;
     /// Establishes the vertex buffers and copies the current mesh data into them.
     void setupForRendering();
     /// Updates the vertex buffers with the current mesh data.
     void updateMeshData();
     /// Does not call updateMeshData().
     void clearMeshData();
+    /// Keeps only the full mesh. Does not call updateMeshData().
+    void removeLODs();
+    void updateBounds();
 };
 
 } // namespace chira
@@ -1,25 +1,19 @@
 #include "MeshDataBuilder.h"
 
-#include <algorithm>
-
 using namespace chira;
 
 MeshDataBuilder::MeshDataBuilder() : MeshData() {
     this->drawMode = MeshDrawMode::DYNAMIC;
 }
 
-void MeshDataBuilder::addVertex(Vertex vertex, bool addDuplicate) { // NOLINT(misc-no-recursion)
+void MeshDataBuilder::addVertex(Vertex vertex, bool addDuplicate) {
     if (addDuplicate) {
         this->vertices.push_back(vertex);
         this->indices.push_back(this->currentIndex);
-        this->currentIndex += 1;
-        return;
-    }
-    if (auto position = std::find(this->vertices.begin(), this->vertices.end(), vertex); position != this->vertices.end()) {
-        this->indices.push_back(static_cast<Index>(position - this->vertices.begin()));
     } else {
-        this->addVertex(vertex, true);
+        this->indices.push_back(this->welder.weld(vertex, this->vertices));
     }
+    this->currentIndex = static_cast<Index>(this->vertices.size());
 }
 
 void MeshDataBuilder::addTriangle(Vertex v1, Vertex v2, Vertex v3, bool addDuplicate) {
@@ -202,4 +196,6 @@ void MeshDataBuilder::update() {
 
 void MeshDataBuilder::clear() {
     this->clearMeshData();
+    this->welder.clear();
+    this->currentIndex = 0;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <render/mesh/MeshData.h>
+#include <render/mesh/VertexWelder.h>
 #include <math/Axis.h>
 
 namespace chira {
@@ -20,7 +21,8 @@ public:
 
 protected:
     Index currentIndex = 0;
-    /// Pass true to addDuplicate if you don't want to scan the entire vertex vector to calculate the index.
+    VertexWelder welder;
+    /// Pass true to addDuplicate if you don't want to look up the vertex to calculate the index.
     /// This will make a duplicate vertex if one already exists.
     void addVertex(Vertex vertex, bool addDuplicate = false);
 };
@@ -15,6 +15,13 @@ void MeshDataResource::compile(const byte buffer[], std::size_t bufferLength) {
     if (!this->materialSetInCode) {
         this->material = CHIRA_GET_MATERIAL(this->materialType, this->materialPath);
     }
+    // Reloads replace the mesh and reuse the existing buffers
+    this->clearMeshData();
     this->appendMeshData(this->modelLoader, this->modelPath);
-    this->setupForRendering();
+    // Set directly, the mesh is uploaded below
+    this->vertexLayout = VertexLayout{this->vertexLayoutType};
+    if (this->initialized)
+        this->updateMeshData();
+    else
+        this->setupForRendering();
 }
@@ -11,6 +11,9 @@ class MeshDataResource : public Resource, public MeshData {
 public:
     explicit MeshDataResource(std::string identifier_) : Resource(std::move(identifier_)), MeshData() {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
+    [[nodiscard]] ResourceMemoryUsage getMemoryUsage() const override {
+        return this->getMeshMemoryUsage();
+    }
 
 private:
     bool materialSetInCode = false;
@@ -18,6 +21,7 @@ private:
     std::string materialPath{"file://materials/unlitTextured.json"};
     std::string modelPath{"file://meshes/missing.cmdl"};
     std::string modelLoader{"cmdl"};
+    VertexLayoutType vertexLayoutType = VertexLayoutType::FULL;
 
 public:
     template<typename Archive>
@@ -28,12 +32,14 @@ public:
                 cereal::make_nvp("material", this->materialPath),
                 cereal::make_nvp("model", this->modelPath),
                 cereal::make_nvp("modelLoader", this->modelLoader),
-                cereal::make_nvp("depthFunction", this->depthFunction)
+                cereal::make_nvp("depthFunction", this->depthFunction),
+                cereal::make_nvp("vertexLayout", this->vertexLayoutType)
         );
     }
 
 private:
     CHIRA_REGISTER_DEFAULT_RESOURCE(MeshDataResource, "file://meshes/missing.json");
+    CHIRA_REGISTER_RESOURCE_TYPE(MeshDataResource);
 };
 
 } // namespace chira
@@ -0,0 +1,257 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace chira;
+
+namespace {
+
+constexpr Index NO_VERTEX = ~Index{0};
+
+/// A FIFO cache, simulated with timestamps: a vertex is in the cache if it missed less than cacheSize misses ago.
+class CacheSimulator {
+public:
+    CacheSimulator(std::size_t vertexCount, unsigned int cacheSize_)
+            : timestamps(vertexCount, 0)
+            , cacheSize(cacheSize_)
+            , time(cacheSize_ + 1) {}
+
+    /// Returns true if the vertex had to be transformed.
+    bool access(Index vertex) {
+        if (this->getAge(vertex) > this->cacheSize) {
+            this->timestamps[vertex] = this->time++;
+            return true;
+        }
+        return false;
+    }
+
+    unsigned int accessTriangle(const Index* triangle) {
+        return this->access(triangle[0]) + this->access(triangle[1]) + this->access(triangle[2]);
+    }
+
+    /// How many misses ago the vertex was added.
+    [[nodiscard]] std::size_t getAge(Index vertex) const {
+        return this->time - this->timestamps[vertex];
+    }
+
+    void flush() {
+        this->time += this->cacheSize + 1;
+    }
+private:
+    std::vector<std::size_t> timestamps;
+    std::size_t cacheSize;
+    std::size_t time;
+};
+
+/// The triangles using each vertex, once per corner.
+struct Adjacency {
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> triangles;
+
+    Adjacency(const std::vector<Index>& indices, std::size_t triangleCount, std::size_t vertexCount)
+            : offsets(vertexCount + 1, 0)
+            , triangles(triangleCount * 3) {
+        for (std::size_t i = 0; i < triangleCount * 3; i++)
+            this->offsets[indices[i] + 1]++;
+        for (std::size_t vertex = 0; vertex < vertexCount; vertex++)
+            this->offsets[vertex + 1] += this->offsets[vertex];
+        auto cursors = this->offsets;
+        for (std::size_t i = 0; i < triangleCount * 3; i++)
+            this->triangles[cursors[indices[i]]++] = i / 3;
+    }
+
+    [[nodiscard]] std::size_t getCount(Index vertex) const {
+        return this->offsets[vertex + 1] - this->offsets[vertex];
+    }
+};
+
+/// Tipsify's fallback when the last fan left no usable candidates: a recently used vertex with triangles left,
+/// or the next one in order that has any.
+Index skipDeadEnd(std::vector<Index>& deadEnd, const std::vector<std::size_t>& liveTriangles, std::size_t& cursor) {
+    while (!deadEnd.empty()) {
+        const auto vertex = deadEnd.back();
+        deadEnd.pop_back();
+        if (liveTriangles[vertex] > 0)
+            return vertex;
+    }
+    for (; cursor < liveTriangles.size(); cursor++) {
+        if (liveTriangles[cursor] > 0)
+            return static_cast<Index>(cursor);
+    }
+    return NO_VERTEX;
+}
+
+} // namespace
+
+VertexCacheStatistics MeshOptimizer::analyzeVertexCache(const std::vector<Index>& indices, std::size_t vertexCount, unsigned int cacheSize /*= DEFAULT_CACHE_SIZE*/) {
+    const auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return {};
+
+    CacheSimulator cache{vertexCount, cacheSize};
+    std::vector<bool> used(vertexCount, false);
+    std::size_t usedCount = 0, misses = 0;
+    for (std::size_t i = 0; i < triangleCount * 3; i++) {
+        misses += cache.access(indices[i]);
+        if (!used[indices[i]]) {
+            used[indices[i]] = true;
+            usedCount++;
+        }
+    }
+    return {
+            static_cast<float>(misses) / static_cast<float>(triangleCount),
+            static_cast<float>(misses) / static_cast<float>(usedCount),
+    };
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<Index>& indices, std::size_t vertexCount, unsigned int cacheSize /*= DEFAULT_CACHE_SIZE*/) {
+    const auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    const Adjacency adjacency{indices, triangleCount, vertexCount};
+    std::vector<std::size_t> liveTriangles(vertexCount);
+    for (std::size_t vertex = 0; vertex < vertexCount; vertex++)
+        liveTriangles[vertex] = adjacency.getCount(static_cast<Index>(vertex));
+    std::vector<bool> emitted(triangleCount, false);
+    CacheSimulator cache{vertexCount, cacheSize};
+
+    std::vector<Index> result;
+    result.reserve(triangleCount * 3);
+    std::vector<Index> deadEnd;
+    std::vector<Index> candidates;
+    std::size_t cursor = 0;
+
+    // Emit every triangle around one vertex, then move on to the neighbour that will still be in the cache
+    // once all of its own triangles are emitted, preferring the one that has been there longest
+    for (Index fanning = indices[0]; fanning != NO_VERTEX; ) {
+        candidates.clear();
+        for (auto i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+            const auto triangle = adjacency.triangles[i];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = true;
+            for (std::size_t corner = 0; corner < 3; corner++) {
+                const auto vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                cache.access(vertex);
+            }
+        }
+
+        fanning = NO_VERTEX;
+        std::size_t bestPriority = 0;
+        for (const auto vertex : candidates) {
+            if (liveTriangles[vertex] == 0)
+                continue;
+            std::size_t priority = 1;
+            if (const auto age = cache.getAge(vertex); age + 2 * liveTriangles[vertex] <= cacheSize)
+                priority += age;
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanning = vertex;
+            }
+        }
+        if (fanning == NO_VERTEX)
+            fanning = skipDeadEnd(deadEnd, liveTriangles, cursor);
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<Index>& indices, const std::vector<Vertex>& vertices, unsigned int cacheSize /*= DEFAULT_CACHE_SIZE*/, float threshold /*= DEFAULT_OVERDRAW_THRESHOLD*/) {
+    const auto triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || vertices.empty())
+        return;
+
+    // Every triangle missing all three vertices starts over somewhere else in the mesh
+    CacheSimulator cache{vertices.size(), cacheSize};
+    std::vector<std::size_t> hardBoundaries;
+    for (std::size_t triangle = 0; triangle < triangleCount; triangle++) {
+        if (cache.accessTriangle(&indices[triangle * 3]) == 3)
+            hardBoundaries.push_back(triangle);
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    // Split those further wherever the cache has been used about as well as it is across the whole run,
+    // so splitting costs little
+    std::vector<std::size_t> clusters;
+    for (std::size_t hard = 0; hard + 1 < hardBoundaries.size(); hard++) {
+        const auto start = hardBoundaries[hard], end = hardBoundaries[hard + 1];
+        cache.flush();
+        std::size_t misses = 0;
+        for (auto triangle = start; triangle < end; triangle++)
+            misses += cache.accessTriangle(&indices[triangle * 3]);
+        const auto maxACMR = threshold * static_cast<float>(misses) / static_cast<float>(end - start);
+
+        cache.flush();
+        clusters.push_back(start);
+        auto clusterStart = start;
+        std::size_t clusterMisses = 0;
+        for (auto triangle = start; triangle + 1 < end; triangle++) {
+            clusterMisses += cache.accessTriangle(&indices[triangle * 3]);
+            if (static_cast<float>(clusterMisses) <= maxACMR * static_cast<float>(triangle + 1 - clusterStart)) {
+                clusterStart = triangle + 1;
+                clusters.push_back(clusterStart);
+                cache.flush();
+                clusterMisses = 0;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // Draw clusters that are far out from the center and face away from it first
+    glm::vec3 meshCenter{};
+    for (const auto& vertex : vertices)
+        meshCenter = meshCenter + vertex.position;
+    meshCenter = meshCenter / static_cast<float>(vertices.size());
+
+    std::vector<std::pair<float, std::size_t>> order;
+    order.reserve(clusters.size() - 1);
+    for (std::size_t cluster = 0; cluster + 1 < clusters.size(); cluster++) {
+        glm::vec3 center{}, normal{};
+        for (auto triangle = clusters[cluster]; triangle < clusters[cluster + 1]; triangle++) {
+            const auto& p0 = vertices[indices[triangle * 3]].position;
+            const auto& p1 = vertices[indices[triangle * 3 + 1]].position;
+            const auto& p2 = vertices[indices[triangle * 3 + 2]].position;
+            center = center + p0 + p1 + p2;
+            normal = normal + glm::cross(p1 - p0, p2 - p0);
+        }
+        center = center / static_cast<float>((clusters[cluster + 1] - clusters[cluster]) * 3);
+        const auto normalLength = glm::length(normal);
+        const auto key = normalLength > 0.f ? glm::dot(center - meshCenter, normal / normalLength) : 0.f;
+        order.emplace_back(key, cluster);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    std::vector<Index> result;
+    result.reserve(triangleCount * 3);
+    for (const auto& [key, cluster] : order)
+        result.insert(result.end(), indices.begin() + static_cast<std::ptrdiff_t>(clusters[cluster] * 3), indices.begin() + static_cast<std::ptrdiff_t>(clusters[cluster + 1] * 3));
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Index>& indices) {
+    std::vector<Index> remap(vertices.size(), NO_VERTEX);
+    std::vector<Vertex> sorted;
+    sorted.reserve(vertices.size());
+    for (auto& index : indices) {
+        if (remap[index] == NO_VERTEX) {
+            remap[index] = static_cast<Index>(sorted.size());
+            sorted.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(sorted);
+}
+
+void MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<Index>& indices, unsigned int cacheSize /*= DEFAULT_CACHE_SIZE*/) {
+    MeshOptimizer::optimizeVertexCache(indices, vertices.size(), cacheSize);
+    MeshOptimizer::optimizeOverdraw(indices, vertices, cacheSize);
+    MeshOptimizer::optimizeVertexFetch(vertices, indices);
+}
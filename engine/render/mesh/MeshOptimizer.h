@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <math/Vertex.h>
+
+namespace chira {
+
+/// How well a triangle list uses the post-transform vertex cache, simulated as a FIFO cache.
+struct VertexCacheStatistics {
+    /// Average cache miss ratio: vertices transformed per triangle, from 3 (no reuse) down to around 0.5
+    float acmr = 0.f;
+    /// Average transformed vertex ratio: vertices transformed per vertex used, from 1 (each one only once) up
+    float atvr = 0.f;
+};
+
+/// Reorders meshes for the GPU. Each pass keeps the triangles and their winding, only their order changes.
+/// Indices are read as a triangle list, a trailing partial triangle is left alone.
+namespace MeshOptimizer {
+
+/// Desktop GPUs have more than this, but optimizing for a smaller cache holds up better on all of them.
+constexpr unsigned int DEFAULT_CACHE_SIZE = 16;
+/// How much worse than optimal the vertex cache may get for the sake of overdraw.
+constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+[[nodiscard]] VertexCacheStatistics analyzeVertexCache(const std::vector<Index>& indices, std::size_t vertexCount,
+                                                       unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+/// Reorders triangles so that they reuse recently transformed vertices, using Tipsify
+/// (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+void optimizeVertexCache(std::vector<Index>& indices, std::size_t vertexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+/// Reorders clusters of triangles that were optimized for the vertex cache, so parts of the mesh facing outwards are
+/// drawn first and hide the ones behind them. Clusters are split wherever the cache hit rate stays within threshold.
+void optimizeOverdraw(std::vector<Index>& indices, const std::vector<Vertex>& vertices,
+                      unsigned int cacheSize = DEFAULT_CACHE_SIZE, float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+/// Sorts vertices in the order the indices first use them, so they are fetched in order. Unused vertices are removed.
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Index>& indices);
+
+/// Runs every pass, in order.
+void optimize(std::vector<Vertex>& vertices, std::vector<Index>& indices, unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+} // namespace MeshOptimizer
+
+} // namespace chira
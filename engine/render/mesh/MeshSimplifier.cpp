@@ -0,0 +1,287 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_set>
+
+using namespace chira;
+
+namespace {
+
+/// Border edges are kept much more strictly than the surface, or open meshes shrink away from their edges.
+constexpr double BORDER_WEIGHT = 10.0;
+constexpr double NO_COLLAPSE = std::numeric_limits<double>::infinity();
+
+/// The sum of squared distances to a set of planes, weighted by area.
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    /// The normal has to be unit length.
+    static Quadric fromPlane(const glm::vec3& normal, const glm::vec3& point, double weight) {
+        const double x = normal.x, y = normal.y, z = normal.z;
+        const double d = -(x * point.x + y * point.y + z * point.z);
+        return {
+                x * x * weight, x * y * weight, x * z * weight, y * y * weight, y * z * weight, z * z * weight,
+                x * d * weight, y * d * weight, z * d * weight,
+                d * d * weight,
+                weight,
+        };
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        this->a00 += other.a00; this->a01 += other.a01; this->a02 += other.a02;
+        this->a11 += other.a11; this->a12 += other.a12; this->a22 += other.a22;
+        this->b0 += other.b0; this->b1 += other.b1; this->b2 += other.b2;
+        this->c += other.c;
+        this->weight += other.weight;
+        return *this;
+    }
+
+    /// The mean squared distance from the point to the planes.
+    [[nodiscard]] double getError(const glm::vec3& point) const {
+        if (this->weight <= 0)
+            return 0;
+        const double x = point.x, y = point.y, z = point.z;
+        const auto error = x * (this->a00 * x + this->a01 * y + this->a02 * z)
+                         + y * (this->a01 * x + this->a11 * y + this->a12 * z)
+                         + z * (this->a02 * x + this->a12 * y + this->a22 * z)
+                         + 2 * (this->b0 * x + this->b1 * y + this->b2 * z)
+                         + this->c;
+        return std::abs(error) / this->weight;
+    }
+};
+
+enum class VertexKind : std::uint8_t {
+    /// Free to collapse onto any neighbour
+    MANIFOLD,
+    /// On an open edge of the mesh, can only collapse along it
+    BORDER,
+    /// On a seam or on a complicated part of the mesh, never moves
+    LOCKED,
+};
+
+struct Collapse {
+    Index from;
+    Index to;
+    double error;
+};
+
+[[nodiscard]] std::uint64_t getEdgeKey(Index from, Index to) {
+    return (static_cast<std::uint64_t>(from) << 32) | to;
+}
+
+[[nodiscard]] glm::vec3 getNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+} // namespace
+
+std::vector<Index> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, std::size_t targetIndexCount,
+                                            float maxError /*= std::numeric_limits<float>::max()*/, float* error /*= nullptr*/) {
+    std::vector<Index> result;
+    result.reserve(indices.size() - indices.size() % 3);
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if (indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i + 2] != indices[i])
+            result.insert(result.end(), indices.begin() + static_cast<std::ptrdiff_t>(i), indices.begin() + static_cast<std::ptrdiff_t>(i + 3));
+    }
+    if (error)
+        *error = 0.f;
+
+    // Vertices with the same position are wedges of one point on the surface, which is what the topology and
+    // the quadrics are built from
+    std::vector<Index> wedgeOf(vertices.size());
+    std::iota(wedgeOf.begin(), wedgeOf.end(), 0);
+    std::vector<std::size_t> wedgeCount(vertices.size(), 1);
+    {
+        std::vector<Index> sorted = wedgeOf;
+        const auto positionLess = [&vertices](Index lhs, Index rhs) {
+            const auto& a = vertices[lhs].position;
+            const auto& b = vertices[rhs].position;
+            return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+        };
+        std::sort(sorted.begin(), sorted.end(), positionLess);
+        for (std::size_t start = 0, end; start < sorted.size(); start = end) {
+            for (end = start + 1; end < sorted.size() && !positionLess(sorted[start], sorted[end]); end++)
+                wedgeOf[sorted[end]] = sorted[start];
+            wedgeCount[sorted[start]] = end - start;
+        }
+    }
+
+    std::unordered_set<std::uint64_t> edges;
+    edges.reserve(result.size());
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+        for (std::size_t corner = 0; corner < 3; corner++)
+            edges.insert(getEdgeKey(wedgeOf[result[i + corner]], wedgeOf[result[i + (corner + 1) % 3]]));
+    }
+    const auto isBorderEdge = [&edges](Index from, Index to) {
+        return !edges.contains(getEdgeKey(to, from));
+    };
+
+    std::vector<std::uint8_t> borderEdgesOut(vertices.size(), 0), borderEdgesIn(vertices.size(), 0);
+    std::vector<Quadric> quadrics(vertices.size());
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+        const auto& p0 = vertices[result[i]].position;
+        const auto& p1 = vertices[result[i + 1]].position;
+        const auto& p2 = vertices[result[i + 2]].position;
+        const auto normal = getNormal(p0, p1, p2);
+        const auto area = glm::length(normal);
+        if (area <= 0.f)
+            continue;
+        const auto unitNormal = normal / area;
+        const auto quadric = Quadric::fromPlane(unitNormal, p0, area);
+        for (std::size_t corner = 0; corner < 3; corner++) {
+            const auto from = wedgeOf[result[i + corner]], to = wedgeOf[result[i + (corner + 1) % 3]];
+            quadrics[from] += quadric;
+            if (!isBorderEdge(from, to))
+                continue;
+            borderEdgesOut[from] = static_cast<std::uint8_t>(std::min(borderEdgesOut[from] + 1, 2));
+            borderEdgesIn[to] = static_cast<std::uint8_t>(std::min(borderEdgesIn[to] + 1, 2));
+            // A plane through the edge, perpendicular to the triangle
+            const auto edge = vertices[to].position - vertices[from].position;
+            const auto edgeLength = glm::length(edge);
+            if (edgeLength <= 0.f)
+                continue;
+            const auto borderQuadric = Quadric::fromPlane(glm::normalize(glm::cross(unitNormal, edge)), vertices[from].position,
+                                                          static_cast<double>(edgeLength) * edgeLength * BORDER_WEIGHT);
+            quadrics[from] += borderQuadric;
+            quadrics[to] += borderQuadric;
+        }
+    }
+
+    std::vector<VertexKind> kinds(vertices.size(), VertexKind::LOCKED);
+    for (std::size_t vertex = 0; vertex < vertices.size(); vertex++) {
+        if (wedgeOf[vertex] != vertex || wedgeCount[vertex] > 1)
+            continue;
+        if (!borderEdgesOut[vertex] && !borderEdgesIn[vertex])
+            kinds[vertex] = VertexKind::MANIFOLD;
+        else if (borderEdgesOut[vertex] == 1 && borderEdgesIn[vertex] == 1)
+            kinds[vertex] = VertexKind::BORDER;
+    }
+    const auto canCollapse = [&](Index from, Index to) {
+        switch (kinds[from]) {
+            using enum VertexKind;
+            case MANIFOLD:
+                return true;
+            case BORDER:
+                return isBorderEdge(from, wedgeOf[to]) || isBorderEdge(wedgeOf[to], from);
+            default:
+                return false;
+        }
+    };
+
+    const auto maxQuadricError = static_cast<double>(maxError) * maxError;
+    double largestError = 0;
+    std::vector<std::size_t> adjacencyOffsets;
+    std::vector<std::size_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<Index> remap(vertices.size());
+    std::vector<bool> touched(vertices.size());
+
+    // Every pass collapses the cheapest edges that don't share any triangles, until nothing more can be collapsed
+    while (result.size() > targetIndexCount) {
+        adjacencyOffsets.assign(vertices.size() + 1, 0);
+        for (const auto index : result)
+            adjacencyOffsets[index + 1]++;
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+        adjacency.resize(result.size());
+        {
+            auto cursors = adjacencyOffsets;
+            for (std::size_t i = 0; i < result.size(); i++)
+                adjacency[cursors[result[i]]++] = i / 3;
+        }
+
+        collapses.clear();
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            for (std::size_t corner = 0; corner < 3; corner++) {
+                const auto a = result[i + corner], b = result[i + (corner + 1) % 3];
+                // Edges between two triangles are only looked at from one of them
+                if (a > b && !isBorderEdge(wedgeOf[a], wedgeOf[b]))
+                    continue;
+                auto quadric = quadrics[wedgeOf[a]];
+                quadric += quadrics[wedgeOf[b]];
+                const auto errorToB = canCollapse(a, b) ? quadric.getError(vertices[b].position) : NO_COLLAPSE;
+                const auto errorToA = canCollapse(b, a) ? quadric.getError(vertices[a].position) : NO_COLLAPSE;
+                if (errorToB < NO_COLLAPSE && errorToB <= errorToA)
+                    collapses.push_back({a, b, errorToB});
+                else if (errorToA < NO_COLLAPSE)
+                    collapses.push_back({b, a, errorToA});
+            }
+        }
+        if (collapses.empty())
+            break;
+
+        // Each collapse removes about two triangles. Collapses that are blocked by a cheaper one this pass are
+        // left for the next, rather than taking more expensive ones in their place
+        const auto wanted = (result.size() - targetIndexCount) / 6 + 1;
+        const auto byError = [](const Collapse& lhs, const Collapse& rhs) {
+            return lhs.error < rhs.error;
+        };
+        const auto limit = collapses.begin() + static_cast<std::ptrdiff_t>(std::min(wanted, collapses.size()) - 1);
+        std::nth_element(collapses.begin(), limit, collapses.end(), byError);
+        const auto passError = std::min(maxQuadricError, limit->error);
+        std::sort(collapses.begin(), limit + 1, byError);
+
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(touched.begin(), touched.end(), false);
+        const auto tryCollapse = [&](const Collapse& collapse) {
+            if (touched[collapse.from] || touched[collapse.to])
+                return false;
+
+            // Triangles that don't go away with the edge can't be flipped over by it
+            const auto& target = vertices[collapse.to].position;
+            bool flips = false;
+            for (auto i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1] && !flips; i++) {
+                const auto* triangle = &result[adjacency[i] * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    continue;
+                glm::vec3 moved[3];
+                for (std::size_t corner = 0; corner < 3; corner++)
+                    moved[corner] = triangle[corner] == collapse.from ? target : vertices[triangle[corner]].position;
+                const auto before = getNormal(vertices[triangle[0]].position, vertices[triangle[1]].position, vertices[triangle[2]].position);
+                flips = glm::dot(before, getNormal(moved[0], moved[1], moved[2])) <= 0.f;
+            }
+            if (flips)
+                return false;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[wedgeOf[collapse.to]] += quadrics[wedgeOf[collapse.from]];
+            largestError = std::max(largestError, collapse.error);
+            for (auto i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; i++) {
+                for (std::size_t corner = 0; corner < 3; corner++)
+                    touched[result[adjacency[i] * 3 + corner]] = true;
+            }
+            return true;
+        };
+        std::size_t collapsed = 0;
+        for (auto candidate = collapses.begin(); candidate <= limit && candidate->error <= passError; candidate++)
+            collapsed += tryCollapse(*candidate);
+        // Everything this pass wanted flips triangles over, look further
+        if (!collapsed) {
+            std::sort(limit + 1, collapses.end(), byError);
+            for (auto candidate = limit + 1; candidate != collapses.end() && candidate->error <= maxQuadricError && !collapsed; candidate++)
+                collapsed += tryCollapse(*candidate);
+        }
+        if (!collapsed)
+            break;
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            const auto a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a == b || b == c || c == a)
+                continue;
+            result[kept++] = a;
+            result[kept++] = b;
+            result[kept++] = c;
+        }
+        result.resize(kept);
+    }
+
+    if (error)
+        *error = static_cast<float>(std::sqrt(largestError));
+    return result;
+}
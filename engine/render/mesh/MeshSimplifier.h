@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <math/Vertex.h>
+
+namespace chira::MeshSimplifier {
+
+/// Collapses edges of a triangle list with the lowest quadric error (Garland and Heckbert, "Surface Simplification
+/// Using Quadric Error Metrics") until at most targetIndexCount indices are left, or until the next collapse would
+/// move the surface further than maxError. Returns indices into the same vertices, so every level of detail can share
+/// one vertex buffer. Vertices on open borders only move along them, and vertices on seams, where the same position
+/// has different attributes, don't move at all.
+/// If error isn't null, it is set to how far the surface moved, in the same units as the vertex positions.
+[[nodiscard]] std::vector<Index> simplify(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, std::size_t targetIndexCount,
+                                          float maxError = std::numeric_limits<float>::max(), float* error = nullptr);
+
+} // namespace chira::MeshSimplifier
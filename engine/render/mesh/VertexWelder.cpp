@@ -0,0 +1,88 @@
+#include "VertexWelder.h"
+
+#include <cmath>
+#include <utility/Hash.h>
+
+using namespace chira;
+
+VertexWelder::VertexWelder(float epsilon_) : epsilon(epsilon_) {}
+
+std::uint64_t VertexWelder::getHash(const Key& key) {
+    return Hash::xxh64(reinterpret_cast<const std::uint8_t*>(key.data()), sizeof(Key));
+}
+
+VertexWelder::Key VertexWelder::getKey(const Vertex& vertex) const {
+    Key key{
+            vertex.position.x, vertex.position.y, vertex.position.z,
+            vertex.normal.r, vertex.normal.g, vertex.normal.b,
+            vertex.color.r, vertex.color.g, vertex.color.b,
+            vertex.uv.r, vertex.uv.g,
+    };
+    for (auto& component : key) {
+        if (this->epsilon > 0.f)
+            component = std::round(component / this->epsilon);
+        // -0 and 0 are equal, so they have to hash the same
+        component += 0.f;
+    }
+    return key;
+}
+
+Index VertexWelder::findOrInsert(const Key& key, Index index, const std::vector<Vertex>& vertices) {
+    // Kept at most half full
+    if ((this->indexed + 1) * 2 > this->slots.size())
+        this->grow(this->indexed + 1);
+    const auto hash = VertexWelder::getHash(key);
+    const auto mask = this->slots.size() - 1;
+    for (auto i = static_cast<std::size_t>(hash) & mask; ; i = (i + 1) & mask) {
+        auto& slot = this->slots[i];
+        if (slot.index == EMPTY_SLOT) {
+            slot = {hash, index};
+            return index;
+        }
+        if (slot.hash == hash && this->getKey(vertices[slot.index]) == key)
+            return slot.index;
+    }
+}
+
+void VertexWelder::grow(std::size_t count) {
+    std::size_t size = 16;
+    while (size < count * 2)
+        size *= 2;
+    if (size <= this->slots.size())
+        return;
+    std::vector<Slot> old(size);
+    old.swap(this->slots);
+    const auto mask = size - 1;
+    for (const auto& slot : old) {
+        if (slot.index == EMPTY_SLOT)
+            continue;
+        auto i = static_cast<std::size_t>(slot.hash) & mask;
+        while (this->slots[i].index != EMPTY_SLOT)
+            i = (i + 1) & mask;
+        this->slots[i] = slot;
+    }
+}
+
+Index VertexWelder::weld(const Vertex& vertex, std::vector<Vertex>& vertices) {
+    if (vertices.size() < this->indexed)
+        this->clear();
+    for (; this->indexed < vertices.size(); this->indexed++) {
+        // The first match wins, like a linear search would
+        this->findOrInsert(this->getKey(vertices[this->indexed]), static_cast<Index>(this->indexed), vertices);
+    }
+    const auto index = this->findOrInsert(this->getKey(vertex), static_cast<Index>(vertices.size()), vertices);
+    if (index == vertices.size()) {
+        vertices.push_back(vertex);
+        this->indexed++;
+    }
+    return index;
+}
+
+void VertexWelder::reserve(std::size_t count) {
+    this->grow(count);
+}
+
+void VertexWelder::clear() {
+    this->slots.clear();
+    this->indexed = 0;
+}
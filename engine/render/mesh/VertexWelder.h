@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <math/Vertex.h>
+
+namespace chira {
+
+/// Finds vertices that were already added to a vertex list in amortized constant time, so meshes can be built
+/// without duplicate vertices. Vertices added to the list without going through weld() are picked up too.
+class VertexWelder {
+public:
+    /// With an epsilon of 0, only vertices that compare equal are welded. Otherwise, vertices are welded
+    /// if every component rounds to the same multiple of epsilon.
+    explicit VertexWelder(float epsilon_ = 0.f);
+
+    /// Returns the index of the first vertex in the list that matches this one, adding it to the end if there isn't one.
+    Index weld(const Vertex& vertex, std::vector<Vertex>& vertices);
+    void reserve(std::size_t count);
+    void clear();
+
+    [[nodiscard]] float getEpsilon() const {
+        return this->epsilon;
+    }
+private:
+    using Key = std::array<float, 11>;
+    /// An open addressing hash table of indices into the vertex list, which holds the keys
+    struct Slot {
+        std::uint64_t hash = 0;
+        Index index = EMPTY_SLOT;
+    };
+    static constexpr Index EMPTY_SLOT = ~Index{0};
+
+    float epsilon;
+    std::vector<Slot> slots;
+    /// How many vertices at the start of the list are in the table
+    std::size_t indexed = 0;
+
+    [[nodiscard]] Key getKey(const Vertex& vertex) const;
+    [[nodiscard]] static std::uint64_t getHash(const Key& key);
+    /// Returns the index of a matching vertex, or adds the given index to the table and returns it.
+    Index findOrInsert(const Key& key, Index index, const std::vector<Vertex>& vertices);
+    void grow(std::size_t count);
+};
+
+} // namespace chira
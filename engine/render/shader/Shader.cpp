@@ -2,6 +2,7 @@
 
 #include <regex>
 #include <core/Logger.h>
+#include <resource/ResourceLoadProfiler.h>
 #include <resource/StringResource.h>
 #include <utility/String.h>
 #include "UBO.h"
@@ -16,11 +17,27 @@ Shader::Shader(std::string identifier_)
 void Shader::compile(const byte buffer[], std::size_t bufferLength) {
     Serial::loadFromBuffer(this, buffer, bufferLength);
 
+    // If this is a reload, an include might be what changed
+    if (this->handle.handle) {
+        std::erase_if(Shader::preprocessorSymbols, [](const auto& pair) {
+            return pair.first.starts_with("include");
+        });
+    }
+
     const auto shaderModuleVertString = Resource::getUniqueUncachedResource<StringResource>(this->vertexPath);
     const auto shaderModuleVertData = replaceMacros(shaderModuleVertString->getIdentifier().data(), shaderModuleVertString->getString());
     const auto shaderModuleFragString = Resource::getUniqueUncachedResource<StringResource>(this->fragmentPath);
     const auto shaderModuleFragData = replaceMacros(shaderModuleFragString->getIdentifier().data(), shaderModuleFragString->getString());
-    this->handle = Renderer::createShader(shaderModuleVertData, shaderModuleFragData);
+    const auto oldHandle = this->handle;
+    {
+        ResourceLoadProfiler::StageScope backend{ResourceLoadStage::BACKEND};
+        this->handle = Renderer::createShader(shaderModuleVertData, shaderModuleFragData);
+    }
+    if (oldHandle.handle)
+        Renderer::destroyShader(oldHandle);
+    this->gpuMemoryUsage = Renderer::getShaderSize(this->handle);
+    this->revision = Shader::nextRevision++;
+    this->modelMatrixUniform = this->usesM ? this->getUniform("m") : Renderer::ShaderUniformHandle{};
 
     if (this->usesPV) {
         PerspectiveViewUBO::get().bindToShader(this->handle);
@@ -35,7 +52,9 @@ void Shader::use() const {
 }
 
 Shader::~Shader() {
-    Renderer::destroyShader(this->handle);
+    Resource::deferDestruction([handle = this->handle] {
+        Renderer::destroyShader(handle);
+    });
 }
 
 void Shader::addPreprocessorSymbol(const std::string& name, const std::string& value) {
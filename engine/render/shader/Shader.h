@@ -18,6 +18,9 @@ public:
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const;
     ~Shader() override;
+    [[nodiscard]] ResourceMemoryUsage getMemoryUsage() const override {
+        return {0, this->gpuMemoryUsage};
+    }
 
     inline void setUniform(std::string_view name, bool value) {
         Renderer::setShaderUniform1b(this->handle, name, value);
@@ -71,6 +74,70 @@ public:
         Renderer::setShaderUniform4m(this->handle, name, value);
     }
 
+    /// Resolving a uniform once and setting it through the handle skips looking up its name on every call.
+    /// Handles are only valid until the revision changes.
+    [[nodiscard]] inline Renderer::ShaderUniformHandle getUniform(std::string_view name) const {
+        return Renderer::getShaderUniform(this->handle, name);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, bool value) {
+        Renderer::setShaderUniform1b(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, unsigned int value) {
+        Renderer::setShaderUniform1u(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, int value) {
+        Renderer::setShaderUniform1i(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, float value) {
+        Renderer::setShaderUniform1f(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec2b value) {
+        Renderer::setShaderUniform2b(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec2u value) {
+        Renderer::setShaderUniform2u(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec2i value) {
+        Renderer::setShaderUniform2i(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec2f value) {
+        Renderer::setShaderUniform2f(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec3b value) {
+        Renderer::setShaderUniform3b(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec3u value) {
+        Renderer::setShaderUniform3u(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec3i value) {
+        Renderer::setShaderUniform3i(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec3f value) {
+        Renderer::setShaderUniform3f(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec4b value) {
+        Renderer::setShaderUniform4b(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec4u value) {
+        Renderer::setShaderUniform4u(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec4i value) {
+        Renderer::setShaderUniform4i(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::vec4f value) {
+        Renderer::setShaderUniform4f(uniform, value);
+    }
+    inline void setUniform(Renderer::ShaderUniformHandle uniform, glm::mat4 value) {
+        Renderer::setShaderUniform4m(uniform, value);
+    }
+    /// Sets "m", which is resolved when the shader is compiled.
+    inline void setModelMatrix(glm::mat4 model) {
+        Renderer::setShaderUniform4m(this->modelMatrixUniform, model);
+    }
+
+    [[nodiscard]] inline Renderer::ShaderHandle getHandle() const {
+        return this->handle;
+    }
     [[nodiscard]] inline bool usesPVMatrices() const {
         return this->usesPV;
     }
@@ -80,6 +147,10 @@ public:
     [[nodiscard]] inline bool isLit() const {
         return this->lit;
     }
+    /// Unique across all shaders, and changes every time this shader is compiled.
+    [[nodiscard]] inline unsigned int getRevision() const {
+        return this->revision;
+    }
 
     static void addPreprocessorSymbol(const std::string& name, const std::string& value);
     static void setPreprocessorPrefix(const std::string& prefix);
@@ -96,7 +167,13 @@ private:
 
     static std::string replaceMacros(const std::string&, const std::string&);
 
+    static inline unsigned int nextRevision = 1;
+
     Renderer::ShaderHandle handle{};
+    Renderer::ShaderUniformHandle modelMatrixUniform{};
+    unsigned int revision = 0;
+    /// The size of the linked program binary. Drivers don't report the real GPU footprint, this is the closest they get.
+    std::size_t gpuMemoryUsage = 0;
     bool usesPV = true;
     bool usesM = true;
     bool lit = true;
@@ -114,6 +191,9 @@ public:
                 cereal::make_nvp("fragment", this->fragmentPath)
         );
     }
+
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(Shader);
 };
 
 } // namespace chira
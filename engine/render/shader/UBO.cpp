@@ -1,9 +1,50 @@
 #include "UBO.h"
 
-#include <glm/gtc/type_ptr.hpp>
-
 using namespace chira;
 
+UniformBufferPool::UniformBufferPool(std::string name_, std::size_t dataSize, Slice capacity)
+        : name(std::move(name_))
+        , slices(dataSize, static_cast<std::size_t>(Renderer::getUniformBufferOffsetAlignment()), capacity)
+        , handle(Renderer::createUniformBuffer(static_cast<std::ptrdiff_t>(this->slices.getSize()))) {}
+
+UniformBufferPool::~UniformBufferPool() {
+    Renderer::destroyUniformBuffer(this->handle);
+}
+
+UniformBufferPool::Slice UniformBufferPool::acquire(const void* data) {
+    const auto acquired = this->slices.acquire(data);
+    if (acquired.grew) {
+        // Reallocates the buffer, the binding point stays the same
+        Renderer::updateUniformBuffer(this->handle, this->slices.getData(), static_cast<std::ptrdiff_t>(this->slices.getSize()));
+        this->boundSlice = INVALID_SLICE;
+    } else if (acquired.written) {
+        const auto offset = this->slices.getOffset(acquired.slice);
+        Renderer::updateUniformBufferPart(this->handle, static_cast<std::ptrdiff_t>(offset), this->slices.getData() + offset, static_cast<std::ptrdiff_t>(this->slices.getDataSize()));
+    }
+    return acquired.slice;
+}
+
+void UniformBufferPool::release(Slice slice) {
+    this->slices.release(slice);
+}
+
+UniformBufferPool::Slice UniformBufferPool::update(Slice slice, const void* data) {
+    // Acquire first, so an owner whose contents didn't change keeps its slice
+    const auto newSlice = this->acquire(data);
+    if (slice != INVALID_SLICE) {
+        this->release(slice);
+    }
+    return newSlice;
+}
+
+void UniformBufferPool::bind(Slice slice) {
+    if (slice == this->boundSlice) {
+        return;
+    }
+    Renderer::bindUniformBufferRange(this->handle, static_cast<std::ptrdiff_t>(this->slices.getOffset(slice)), static_cast<std::ptrdiff_t>(this->slices.getDataSize()));
+    this->boundSlice = slice;
+}
+
 PerspectiveViewUBO::PerspectiveViewUBO() : UniformBufferObject("PV") {}
 
 PerspectiveViewUBO& PerspectiveViewUBO::get() {
@@ -11,13 +52,16 @@ PerspectiveViewUBO& PerspectiveViewUBO::get() {
     return singleton;
 }
 
-void PerspectiveViewUBO::update(glm::mat4 proj, glm::mat4 view, glm::vec3 viewPos, glm::vec3 viewLookDir) const {
-    // todo: minimize the number of buffer writes
-    Renderer::updateUniformBufferPart(this->handle, 0 * glm::MAT4_SIZE, &proj, glm::MAT4_SIZE);
-    Renderer::updateUniformBufferPart(this->handle, 1 * glm::MAT4_SIZE, &view, glm::MAT4_SIZE);
-    Renderer::updateUniformBufferPart(this->handle, 2 * glm::MAT4_SIZE, glm::value_ptr(proj * view), glm::MAT4_SIZE);
-    Renderer::updateUniformBufferPart(this->handle, 3 * glm::MAT4_SIZE, glm::value_ptr(glm::vec4{viewPos, 1.0}), glm::VEC4F_SIZE);
-    Renderer::updateUniformBufferPart(this->handle, (3 * glm::MAT4_SIZE) + glm::VEC4F_SIZE, glm::value_ptr(glm::vec4{viewLookDir, 1.0}), glm::VEC4F_SIZE);
+bool PerspectiveViewUBO::update(glm::mat4 proj, glm::mat4 view, glm::vec3 viewPos, glm::vec3 viewLookDir) {
+    static_assert(sizeof(Data) == static_cast<std::size_t>(size), "PerspectiveViewUBO::Data doesn't match the size of PV!");
+    const Data data{
+        .p = proj,
+        .v = view,
+        .pv = proj * view,
+        .viewPosition = glm::vec4{viewPos, 1.0},
+        .viewLookDirection = glm::vec4{viewLookDir, 1.0},
+    };
+    return this->upload(&data);
 }
 
 LightsUBO::LightsUBO() : UniformBufferObject("LIGHTS") {}
@@ -27,85 +71,50 @@ LightsUBO& LightsUBO::get() {
     return singleton;
 }
 
-void LightsUBO::update(DirectionalLightComponent* directionalLights[], PointLightComponent* pointLights[], SpotLightComponent* spotLights[], glm::vec3i numberOfLights) const {
-    // todo: minimize the number of buffer writes
-    unsigned int position = 0;
-    int nullLights;
+bool LightsUBO::update(DirectionalLightComponent* directionalLights[], PointLightComponent* pointLights[], SpotLightComponent* spotLights[], glm::vec3i numberOfLights) {
+    static_assert(sizeof(Data) == static_cast<std::size_t>(size), "LightsUBO::Data doesn't match the size of LIGHTS!");
+    // Unused slots are zeroed so they compare equal between frames
+    Data data{};
 
-    nullLights = 0;
+    int count = 0;
     for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++) {
-        auto* light = directionalLights[i];
-        if (!light) {
-            nullLights++;
-            continue;
+        if (const auto* light = directionalLights[i]) {
+            data.directionalLights[count++] = {
+                .direction = glm::vec4{light->transform->getRotationEuler(), 0.f},
+                .ambient = glm::vec4{light->ambient, 1.f},
+                .diffuse = glm::vec4{light->diffuse, 1.f},
+                .specular = glm::vec4{light->specular, 1.f},
+            };
         }
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->transform->getRotationEuler(), 0.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->ambient, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->diffuse, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->specular, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
     }
-    position += (glm::VEC4F_SIZE * 4) * nullLights;
 
-    nullLights = 0;
+    count = 0;
     for (int i = 0; i < POINT_LIGHT_MAX; i++) {
-        auto* light = pointLights[i];
-        if (!light) {
-            nullLights++;
-            continue;
+        if (const auto* light = pointLights[i]) {
+            data.pointLights[count++] = {
+                .position = glm::vec4{light->transform->getPosition(), 0.f},
+                .ambient = glm::vec4{light->ambient, 1.f},
+                .diffuse = glm::vec4{light->diffuse, 1.f},
+                .specular = glm::vec4{light->specular, 1.f},
+                .falloff = glm::vec4{light->falloff, 1.f},
+            };
         }
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->transform->getPosition(), 0.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->ambient, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->diffuse, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->specular, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->falloff, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
     }
-    position += (glm::VEC4F_SIZE * 5) * nullLights;
 
-    nullLights = 0;
+    count = 0;
     for (int i = 0; i < SPOT_LIGHT_MAX; i++) {
-        auto* light = spotLights[i];
-        if (!light) {
-            nullLights++;
-            continue;
+        if (const auto* light = spotLights[i]) {
+            data.spotLights[count++] = {
+                .position = glm::vec4{light->transform->getPosition(), 0.f},
+                .direction = glm::vec4{light->transform->getRotationEuler(), 0.f},
+                .diffuse = glm::vec4{light->diffuse, 1.f},
+                .specular = glm::vec4{light->specular, 1.f},
+                .falloff = glm::vec4{light->falloff, 1.f},
+                .cutoff = glm::vec4{light->cutoff, 0.f, 1.f},
+            };
         }
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->transform->getPosition(), 0.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->transform->getRotationEuler(), 0.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->diffuse, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->specular, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->falloff, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
-
-        Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{light->cutoff, 0.f, 1.f}), glm::VEC4F_SIZE);
-        position += glm::VEC4F_SIZE;
     }
-    position += (glm::VEC4F_SIZE * 6) * nullLights;
 
-    Renderer::updateUniformBufferPart(this->handle, position, glm::value_ptr(glm::vec4{numberOfLights, 1.f}), glm::VEC4F_SIZE);
+    data.numberOfLights = glm::vec4{numberOfLights, 1.f};
+    return this->upload(&data);
 }
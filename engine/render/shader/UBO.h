@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstring>
 #include <string>
 #include <entity/component/LightComponents.h>
 #include <math/Types.h>
 #include <render/backend/RenderBackend.h>
+#include <render/backend/UniformBufferSlices.h>
 
 namespace chira {
 
@@ -26,12 +29,64 @@ protected:
     Renderer::UniformBufferHandle handle;
 
     static constexpr std::ptrdiff_t size = Size;
+
+    /// Uploads the whole buffer in one write, unless it's the same as the last upload.
+    /// Returns true if the buffer was written.
+    bool upload(const void* data) {
+        if (this->uploaded && std::memcmp(this->staging.data(), data, Size) == 0) {
+            return false;
+        }
+        std::memcpy(this->staging.data(), data, Size);
+        this->uploaded = true;
+        Renderer::updateUniformBuffer(this->handle, this->staging.data(), Size);
+        return true;
+    }
+private:
+    /// What the buffer currently holds
+    std::array<std::byte, Size> staging{};
+    bool uploaded = false;
 };
 
-/// Stores two mat4 values, named PV
+/// Many copies of one block in a single uniform buffer, one of which is bound by offset at a time.
+/// Copies with the same contents are shared, so owners with the same parameters bind the same range.
+class UniformBufferPool {
+public:
+    using Slice = UniformBufferSlices::Slice;
+    static constexpr Slice INVALID_SLICE = UniformBufferSlices::INVALID_SLICE;
+
+    UniformBufferPool(std::string name_, std::size_t dataSize, Slice capacity);
+    ~UniformBufferPool();
+    inline void bindToShader(Renderer::ShaderHandle shaderHandle) {
+        Renderer::bindUniformBufferToShader(shaderHandle, this->handle, this->name);
+    }
+    /// Returns a slice holding these contents, only writing to the buffer if no slice has them yet.
+    [[nodiscard]] Slice acquire(const void* data);
+    void release(Slice slice);
+    /// Moves an owner of the old slice (which can be INVALID_SLICE) to one holding the new contents.
+    [[nodiscard]] Slice update(Slice slice, const void* data);
+    /// Does nothing if the slice is already bound.
+    void bind(Slice slice);
+private:
+    std::string name;
+    UniformBufferSlices slices;
+    Renderer::UniformBufferHandle handle;
+    Slice boundSlice = INVALID_SLICE;
+};
+
+/// Stores the camera matrices, named PV
 struct PerspectiveViewUBO final : public UniformBufferObject<(3 * glm::MAT4_SIZE) + (2 * glm::VEC4F_SIZE)> {
+    /// Matches the std140 layout of PV in ubo/pv.glsl
+    struct Data {
+        glm::mat4 p;
+        glm::mat4 v;
+        glm::mat4 pv;
+        glm::vec4 viewPosition;
+        glm::vec4 viewLookDirection;
+    };
+
     static PerspectiveViewUBO& get();
-    void update(glm::mat4 proj, glm::mat4 view, glm::vec3 viewPos, glm::vec3 viewLookDir) const;
+    /// Returns true if the buffer changed
+    bool update(glm::mat4 proj, glm::mat4 view, glm::vec3 viewPos, glm::vec3 viewLookDir);
 private:
     PerspectiveViewUBO();
 };
@@ -41,8 +96,35 @@ struct LightsUBO final : public UniformBufferObject<((4 * glm::VEC4F_SIZE) * DIR
                                                     ((5 * glm::VEC4F_SIZE) * POINT_LIGHT_MAX) +
                                                     ((6 * glm::VEC4F_SIZE) * SPOT_LIGHT_MAX) +
                                                     glm::VEC4F_SIZE> {
+    /// Matches the std140 layout of LIGHTS in ubo/lights.glsl
+    struct Data {
+        struct DirectionalLight {
+            glm::vec4 direction;
+            glm::vec4 ambient;
+            glm::vec4 diffuse;
+            glm::vec4 specular;
+        } directionalLights[DIRECTIONAL_LIGHT_MAX];
+        struct PointLight {
+            glm::vec4 position;
+            glm::vec4 ambient;
+            glm::vec4 diffuse;
+            glm::vec4 specular;
+            glm::vec4 falloff;
+        } pointLights[POINT_LIGHT_MAX];
+        struct SpotLight {
+            glm::vec4 position;
+            glm::vec4 direction;
+            glm::vec4 diffuse;
+            glm::vec4 specular;
+            glm::vec4 falloff;
+            glm::vec4 cutoff;
+        } spotLights[SPOT_LIGHT_MAX];
+        glm::vec4 numberOfLights;
+    };
+
     static LightsUBO& get();
-    void update(DirectionalLightComponent* directionalLights[], PointLightComponent* pointLights[], SpotLightComponent* spotLights[], glm::vec3i numberOfLights) const;
+    /// Returns true if the buffer changed
+    bool update(DirectionalLightComponent* directionalLights[], PointLightComponent* pointLights[], SpotLightComponent* spotLights[], glm::vec3i numberOfLights);
 private:
     LightsUBO();
 };
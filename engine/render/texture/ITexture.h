@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include <loader/image/Image.h>
 #include <resource/Resource.h>
 #include <render/backend/RenderBackend.h>
 #include <render/backend/RenderTypes.h>
@@ -16,8 +17,20 @@ public:
     virtual void use() const = 0;
     virtual void use(TextureUnit activeTextureUnit) const = 0;
 
+    [[nodiscard]] ResourceMemoryUsage getMemoryUsage() const override {
+        return {0, this->gpuMemoryUsage};
+    }
+
 protected:
     Renderer::TextureHandle handle{};
+    /// Set when the texture is created, drivers don't report it.
+    std::size_t gpuMemoryUsage = 0;
+
+    /// A full mip chain adds about a third on top of the base level.
+    [[nodiscard]] static std::size_t estimateGPUMemoryUsage(const Image& image, bool mipmaps) {
+        const auto base = static_cast<std::size_t>(image.getWidth()) * image.getHeight() * image.getBitDepth();
+        return mipmaps ? base + base / 3 : base;
+    }
 };
 
 } // namespace chira
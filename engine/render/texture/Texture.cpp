@@ -2,6 +2,7 @@
 
 #include <core/Logger.h>
 #include <render/backend/RenderBackend.h>
+#include <resource/ResourceLoadProfiler.h>
 
 using namespace chira;
 
@@ -12,8 +13,11 @@ Texture::Texture(std::string identifier_, bool cacheTexture /*= true*/)
     , cache(cacheTexture) {}
 
 Texture::~Texture() {
-    if (this->handle)
-        Renderer::destroyTexture(this->handle);
+    if (this->handle) {
+        Resource::deferDestruction([handle = this->handle] {
+            Renderer::destroyTexture(handle);
+        });
+    }
 }
 
 void Texture::compile(const byte buffer[], std::size_t bufferLength) {
@@ -21,8 +25,15 @@ void Texture::compile(const byte buffer[], std::size_t bufferLength) {
 
     auto imageFile = Resource::getResource<Image>(this->filePath, this->verticalFlip);
 
-    this->handle = Renderer::createTexture2D(*imageFile, this->wrapModeS, this->wrapModeT, this->filterMode,
-                                             this->mipmaps, TextureUnit::G0);
+    const auto oldHandle = this->handle;
+    {
+        ResourceLoadProfiler::StageScope backend{ResourceLoadStage::BACKEND};
+        this->handle = Renderer::createTexture2D(*imageFile, this->wrapModeS, this->wrapModeT, this->filterMode,
+                                                 this->mipmaps, TextureUnit::G0);
+    }
+    if (oldHandle)
+        Renderer::destroyTexture(oldHandle);
+    this->gpuMemoryUsage = ITexture::estimateGPUMemoryUsage(*imageFile, this->mipmaps);
     if (this->cache) {
         this->file = imageFile;
     }
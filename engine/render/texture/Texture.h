@@ -36,6 +36,9 @@ public:
                 cereal::make_nvp("filterMode", this->filterMode)
         );
     }
+
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(Texture);
 };
 
 } // namespace chira
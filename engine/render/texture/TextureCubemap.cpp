@@ -3,6 +3,7 @@
 #include <core/Logger.h>
 #include <loader/image/Image.h>
 #include <render/backend/RenderBackend.h>
+#include <resource/ResourceLoadProfiler.h>
 
 using namespace chira;
 
@@ -12,8 +13,11 @@ TextureCubemap::TextureCubemap(std::string identifier_)
     : ITexture(std::move(identifier_)) {}
 
 TextureCubemap::~TextureCubemap() {
-    if (this->handle)
-        Renderer::destroyTexture(this->handle);
+    if (this->handle) {
+        Resource::deferDestruction([handle = this->handle] {
+            Renderer::destroyTexture(handle);
+        });
+    }
 }
 
 void TextureCubemap::compile(const byte buffer[], std::size_t bufferLength) {
@@ -26,9 +30,19 @@ void TextureCubemap::compile(const byte buffer[], std::size_t bufferLength) {
     auto fileLT = Resource::getResource<Image>(this->imageLT, this->verticalFlipLT);
     auto fileRT = Resource::getResource<Image>(this->imageRT, this->verticalFlipRT);
 
-    this->handle = Renderer::createTextureCubemap(*fileRT, *fileLT, *fileUP, *fileDN, *fileFD, *fileBK,
-                                                  this->wrapModeS, this->wrapModeT, this->wrapModeR, this->filterMode,
-                                                  this->mipmaps, TextureUnit::G0);
+    const auto oldHandle = this->handle;
+    {
+        ResourceLoadProfiler::StageScope backend{ResourceLoadStage::BACKEND};
+        this->handle = Renderer::createTextureCubemap(*fileRT, *fileLT, *fileUP, *fileDN, *fileFD, *fileBK,
+                                                      this->wrapModeS, this->wrapModeT, this->wrapModeR, this->filterMode,
+                                                      this->mipmaps, TextureUnit::G0);
+    }
+    if (oldHandle)
+        Renderer::destroyTexture(oldHandle);
+    this->gpuMemoryUsage = 0;
+    for (const auto* face : {&fileRT, &fileLT, &fileUP, &fileDN, &fileFD, &fileBK}) {
+        this->gpuMemoryUsage += ITexture::estimateGPUMemoryUsage(**face, this->mipmaps);
+    }
 }
 
 void TextureCubemap::use() const {
@@ -56,6 +56,9 @@ public:
                 cereal::make_nvp("filterMode", this->filterMode)
         );
     }
+
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(TextureCubemap);
 };
 
 } // namespace chira
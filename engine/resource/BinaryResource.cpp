@@ -1,23 +1,20 @@
 #include "BinaryResource.h"
 
-#include <cstring>
-
 using namespace chira;
 
 void BinaryResource::compile(const byte buffer[], std::size_t bufferLength) {
-    this->bufferLength_ = bufferLength - 1;
-    this->buffer_ = new byte[this->bufferLength_];
-    std::memcpy(this->buffer_, buffer, this->bufferLength_);
+    this->buffer_ = ResourceBuffer{std::vector<byte>{buffer, buffer + bufferLength}};
 }
 
-BinaryResource::~BinaryResource() {
-    delete[] this->buffer_;
+void BinaryResource::compileFromBuffer(const ResourceBuffer& buffer) {
+    this->buffer_ = buffer.keep();
 }
 
 const byte* BinaryResource::getBuffer() const {
-    return this->buffer_;
+    return this->buffer_.data();
 }
 
 std::size_t BinaryResource::getBufferLength() const {
-    return this->bufferLength_;
+    // Don't count the null terminator
+    return this->buffer_.empty() ? 0 : this->buffer_.size() - 1;
 }
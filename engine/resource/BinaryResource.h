@@ -4,16 +4,25 @@
 
 namespace chira {
 
+/// Raw bytes. When loaded from a provider, it holds onto the provider's buffer (often a file mapping) instead of copying it,
+/// unless the buffer maps a loose file that can change on disk.
 class BinaryResource : public Resource {
 public:
     explicit BinaryResource(std::string identifier_) : Resource(std::move(identifier_)) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
-    ~BinaryResource() override;
+    void compileFromBuffer(const ResourceBuffer& buffer) override;
+    [[nodiscard]] bool supportsAsyncCompile() const override {
+        return true;
+    }
+    [[nodiscard]] ResourceMemoryUsage getMemoryUsage() const override {
+        return {this->buffer_.size(), 0};
+    }
     [[nodiscard]] const byte* getBuffer() const;
     [[nodiscard]] std::size_t getBufferLength() const;
 protected:
-    byte* buffer_ = nullptr;
-    std::size_t bufferLength_ = 0;
+    ResourceBuffer buffer_;
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(BinaryResource);
 };
 
 } // namespace chira
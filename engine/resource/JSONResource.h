@@ -17,6 +17,9 @@ public:
         }
         return defaultValue;
     }
+
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(JSONResource);
 };
 
 } // namespace chira
@@ -1,43 +1,393 @@
 #include "Resource.h"
 
+#include <algorithm>
+#include <fstream>
+#include <typeinfo>
+#include <config/ConEntry.h>
 #include <core/Logger.h>
 #include <i18n/TranslationManager.h>
+#include <utility/Hash.h>
+#include "ResourceLoadProfiler.h"
 
 using namespace chira;
 
 CHIRA_CREATE_LOG(RESOURCE);
 
-Resource::~Resource() {
-    Resource::removeResource(this->identifier);
-}
+ConVar res_async_loader_threads{"res_async_loader_threads", 0, "The number of threads used to load resources in the background. 0 picks a number based on the CPU. Takes effect on the first background load.", CON_FLAG_CACHE};
+ConVar res_cache_budget_mb{"res_cache_budget_mb", 512, "Cached resources nobody is using are evicted, least recently used first, while the cache uses more memory than this.", CON_FLAG_CACHE};
+ConVar res_hot_reload{"res_hot_reload", true, "Recompile cached resources when the files they were compiled from change.", CON_FLAG_CACHE};
+ConVar res_gc_budget_ms{"res_gc_budget_ms", 1.0, "The time spent per frame destroying resources that were removed from the cache. Anything left over is destroyed over the next frames. 0 or less removes everything every frame.", CON_FLAG_CACHE};
+ConVar res_dedup_content{"res_dedup_content", false, "Resources of the same type with identical contents share one instance. Only affects resources loaded after it's changed.", CON_FLAG_CACHE};
+ConVar res_async_uploads_per_frame{"res_async_uploads_per_frame", 4, "The maximum number of resources loaded in the background that are compiled and cached per frame.", CON_FLAG_CACHE};
+
+[[maybe_unused]]
+ConCommand res_manifest_record{"res_manifest_record", "Starts recording every resource that gets loaded. See res_manifest_save.", [] {
+    Resource::startRecordingManifest();
+}};
+
+[[maybe_unused]]
+ConCommand res_manifest_save{"res_manifest_save", "Stops recording loaded resources and writes them to the given file as a precache manifest.", [](ConCommand::CallbackArgs args) {
+    if (args.empty()) {
+        LOG_RESOURCE.error("Usage: res_manifest_save <path>");
+        return;
+    }
+    if (Resource::saveManifest(args[0])) {
+        LOG_RESOURCE.infoImportant(TRF("debug.resource.manifest_saved", args[0]));
+    }
+}};
 
 //
 // Static caching functions
 //
 
+Resource::CompileScope::CompileScope(const ResourceId& identifier) {
+    Resource::compileStack.push_back(identifier);
+}
+
+Resource::CompileScope::~CompileScope() {
+    Resource::compileStack.pop_back();
+}
+
 void Resource::addResourceProvider(IResourceProvider* provider) {
-    std::string providerName{provider->getName().data()};
-    if (Resource::providers.find(providerName) == Resource::providers.end()) {
-        Resource::providers[providerName] = std::vector<std::unique_ptr<IResourceProvider>>{};
-    }
+    const auto providerName = ResourceId::intern(provider->getName());
     Resource::providers[providerName].emplace_back(provider);
+
+    // The new provider might have anything that was missing under its name
+    std::erase_if(Resource::missingResources, [providerName](const ResourceId& missing) {
+        return missing.getProvider() == providerName;
+    });
+    std::erase_if(Resource::errorCounts, [providerName](const auto& pair) {
+        return pair.first.getProvider() == providerName;
+    });
+
+    // The newest provider wins, so it overwrites whatever was indexed before
+    std::string identifier{providerName};
+    identifier += RESOURCE_ID_SEPARATOR;
+    const auto prefixLength = identifier.size();
+    const bool listed = provider->listResources([&identifier, prefixLength, provider](std::string_view name) {
+        identifier.resize(prefixLength);
+        identifier += name;
+        Resource::resourceIndex[identifier] = provider;
+    });
+    if (!listed) {
+        // We don't know what this provider overrides, so anything under its name has to be looked up the slow way
+        std::erase_if(Resource::resourceIndex, [providerName](const auto& pair) {
+            return pair.first.getProvider() == providerName;
+        });
+    }
 }
 
-IResourceProvider* Resource::getLatestResourceProvider(const std::string& provider) {
-    return Resource::providers[provider][Resource::providers[provider].size() - 1].get();
+IResourceProvider* Resource::getLatestResourceProvider(std::string_view provider) {
+    if (auto providerList = Resource::providers.find(provider); providerList != Resource::providers.end() && !providerList->second.empty())
+        return providerList->second.back().get();
+    return nullptr;
 }
 
-IResourceProvider* Resource::getResourceProviderWithResource(const std::string& identifier) {
-    auto id = Resource::splitResourceIdentifier(identifier);
-    const std::string& provider = id.first, name = id.second;
-    for (auto i = Resource::providers[provider].rbegin(); i < Resource::providers[provider].rend(); i++) {
-        if (i->get()->hasResource(name))
-            return i->get();
+IResourceProvider* Resource::getResourceProviderWithResource(const ResourceId& identifier) {
+    if (auto* provider = Resource::findResourceProvider(identifier))
+        return provider;
+    Resource::logResourceError("error.resource.resource_not_found", identifier);
+    return nullptr;
+}
+
+IResourceProvider* Resource::findResourceProvider(const ResourceId& identifier) {
+    if (!identifier.isValid()) {
+        Resource::logResourceError("error.resource.cannot_split_identifier", identifier);
+        return nullptr;
     }
-    LOG_RESOURCE.error(TRF("error.resource.resource_not_found", identifier));
+    if (auto indexed = Resource::resourceIndex.find(identifier); indexed != Resource::resourceIndex.end())
+        return indexed->second;
+    if (Resource::missingResources.contains(identifier))
+        return nullptr;
+    if (auto providerList = Resource::providers.find(identifier.getProvider()); providerList != Resource::providers.end()) {
+        for (auto i = providerList->second.rbegin(); i != providerList->second.rend(); i++) {
+            if (i->get()->hasResource(identifier.getName()))
+                return i->get();
+        }
+    }
+    Resource::missingResources.insert(identifier);
     return nullptr;
 }
 
+void Resource::pollResourceProviders() {
+    for (const auto& [providerName, providerList] : Resource::providers) {
+        for (const auto& provider : providerList) {
+            provider->pollChanges([&providerName, &providerList, changed = provider.get()](std::string_view name, ResourceChange change) {
+                if (change == ResourceChange::RESCAN) {
+                    Resource::reindexProviders(providerName);
+                    return;
+                }
+                ResourceId identifier{std::string{providerName} + RESOURCE_ID_SEPARATOR.data() + std::string{name}};
+                if (change == ResourceChange::MODIFIED) {
+                    // Edits to a file that is overridden by another provider don't matter
+                    if (Resource::findResourceProvider(identifier) == changed)
+                        Resource::changedResources.insert(identifier);
+                    return;
+                }
+                if (change == ResourceChange::ADDED) {
+                    Resource::missingResources.erase(identifier);
+                    Resource::errorCounts.erase(identifier);
+                }
+                // Another provider might still have it, or might be overridden by the new one
+                auto* previous = Resource::findResourceProvider(identifier);
+                Resource::resourceIndex.erase(identifier);
+                for (auto i = providerList.rbegin(); i != providerList.rend(); i++) {
+                    if (i->get()->hasResource(name)) {
+                        Resource::resourceIndex[identifier] = i->get();
+                        break;
+                    }
+                }
+                // If it's gone entirely, hold onto what was loaded
+                if (auto* current = Resource::findResourceProvider(identifier); current && current != previous)
+                    Resource::changedResources.insert(identifier);
+            });
+        }
+    }
+}
+
+void Resource::reindexProviders(std::string_view providerName) {
+    std::erase_if(Resource::missingResources, [providerName](const ResourceId& missing) {
+        return missing.getProvider() == providerName;
+    });
+    std::erase_if(Resource::errorCounts, [providerName](const auto& pair) {
+        return pair.first.getProvider() == providerName;
+    });
+    std::erase_if(Resource::resourceIndex, [providerName](const auto& pair) {
+        return pair.first.getProvider() == providerName;
+    });
+    auto providerList = Resource::providers.find(providerName);
+    if (providerList == Resource::providers.end())
+        return;
+
+    // Oldest first, so newer providers overwrite what they override
+    std::string identifier{providerName};
+    identifier += RESOURCE_ID_SEPARATOR;
+    const auto prefixLength = identifier.size();
+    for (const auto& provider : providerList->second) {
+        const bool listed = provider->listResources([&identifier, prefixLength, &provider](std::string_view name) {
+            identifier.resize(prefixLength);
+            identifier += name;
+            Resource::resourceIndex[identifier] = provider.get();
+        });
+        if (!listed) {
+            // Same as in addResourceProvider, everything under this name has to be looked up the slow way
+            std::erase_if(Resource::resourceIndex, [providerName](const auto& pair) {
+                return pair.first.getProvider() == providerName;
+            });
+            return;
+        }
+    }
+}
+
+ResourceMemoryUsage Resource::getCachedMemoryUsage() {
+    return Resource::cachedMemoryUsage;
+}
+
+void Resource::countMemoryUsage(const ResourceId& identifier) {
+    auto cached = Resource::resources.find(identifier);
+    if (cached == Resource::resources.end())
+        return;
+    auto* resource = cached->second.get();
+    Resource::cachedMemoryUsage -= resource->countedMemoryUsage;
+    resource->countedMemoryUsage = resource->getMemoryUsage();
+    Resource::cachedMemoryUsage += resource->countedMemoryUsage;
+}
+
+bool Resource::deduplicate(Resource* resource, const ResourceBuffer& buffer) {
+    // Only the first compile of a resource counts, reloads always recompile in place
+    const auto seed = std::exchange(resource->deduplicationSeed, std::nullopt);
+    if (!seed || !res_dedup_content.getValue<bool>())
+        return false;
+    const auto identifier = resource->getResourceId();
+    auto cached = Resource::resources.find(identifier);
+    if (cached == Resource::resources.end() || cached->second.get() != resource)
+        return false;
+
+    const auto hash = Hash::xxh64(buffer.data(), buffer.size(), *seed ^ typeid(*resource).hash_code());
+    auto [indexed, inserted] = Resource::contentIndex.try_emplace(hash, identifier);
+    if (inserted || indexed->second == identifier)
+        return false;
+    auto original = Resource::resources.find(indexed->second);
+    if (original == Resource::resources.end() || typeid(*original->second) != typeid(*resource)) {
+        // The original is gone, this one takes its place
+        indexed->second = identifier;
+        return false;
+    }
+
+    Resource::aliases[identifier] = indexed->second;
+    Resource::markUsed(original->second.get());
+    // Destroy it outside the map, in case its destructor releases other cached resources
+    Resource::forgetMemoryUsage(cached->second.get());
+    auto duplicate = std::move(cached->second);
+    Resource::resources.erase(cached);
+    return true;
+}
+
+std::size_t Resource::getDeduplicatedCount() {
+    return static_cast<std::size_t>(std::count_if(Resource::aliases.begin(), Resource::aliases.end(), [](const auto& pair) {
+        return Resource::resources.contains(pair.second);
+    }));
+}
+
+ResourceMemoryUsage Resource::getDeduplicatedMemoryUsage() {
+    ResourceMemoryUsage usage;
+    for (const auto& [alias, original] : Resource::aliases) {
+        if (auto cached = Resource::resources.find(original); cached != Resource::resources.end())
+            usage += cached->second->getMemoryUsage();
+    }
+    return usage;
+}
+
+void Resource::evictUnusedResources(std::size_t budget) {
+    if (Resource::cachedMemoryUsage.total() <= budget)
+        return;
+
+    // Only the cache holds these
+    std::vector<std::pair<std::uint64_t, ResourceId>> unused;
+    for (const auto& [identifier, resource] : Resource::resources) {
+        if (resource.useCount() == 1)
+            unused.emplace_back(resource->lastUsed, identifier);
+    }
+    std::sort(unused.begin(), unused.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    for (const auto& [lastUsed, identifier] : unused) {
+        if (Resource::cachedMemoryUsage.total() <= budget)
+            break;
+        auto cached = Resource::resources.find(identifier);
+        // Evicting one resource can release the last handle to another, but never takes one
+        if (cached == Resource::resources.end() || cached->second.useCount() != 1)
+            continue;
+        // Destroy it outside the map, its destructor might release other cached resources
+        Resource::forgetMemoryUsage(cached->second.get());
+        auto evicted = std::move(cached->second);
+        Resource::resources.erase(cached);
+        Resource::clearDependencies(identifier);
+    }
+}
+
+void Resource::reloadResource(const ResourceId& identifier) {
+    Resource::changedResources.insert(identifier);
+}
+
+std::vector<ResourceId> Resource::getResourceDependents(const ResourceId& identifier) {
+    std::scoped_lock lock{Resource::dependencyMutex};
+    if (auto found = Resource::dependents.find(identifier); found != Resource::dependents.end())
+        return {found->second.begin(), found->second.end()};
+    return {};
+}
+
+void Resource::addDependency(const ResourceId& dependent, const ResourceId& dependency) {
+    std::scoped_lock lock{Resource::dependencyMutex};
+    Resource::dependents[dependency].insert(dependent);
+    Resource::dependencies[dependent].insert(dependency);
+}
+
+void Resource::clearDependencies(const ResourceId& dependent) {
+    std::scoped_lock lock{Resource::dependencyMutex};
+    auto found = Resource::dependencies.find(dependent);
+    if (found == Resource::dependencies.end())
+        return;
+    for (const auto& dependency : found->second) {
+        if (auto dependencyDependents = Resource::dependents.find(dependency); dependencyDependents != Resource::dependents.end()) {
+            dependencyDependents->second.erase(dependent);
+            if (dependencyDependents->second.empty())
+                Resource::dependents.erase(dependencyDependents);
+        }
+    }
+    Resource::dependencies.erase(found);
+}
+
+void Resource::reloadChangedResources() {
+    if (Resource::changedResources.empty())
+        return;
+    if (!res_hot_reload.getValue<bool>()) {
+        Resource::changedResources.clear();
+        return;
+    }
+
+    // Identical resources might not be identical anymore, give aliases of anything that changed their own instance
+    std::vector<ResourceId> splitAliases;
+    std::erase_if(Resource::aliases, [&splitAliases](const auto& pair) {
+        if (Resource::changedResources.contains(pair.first))
+            return true;
+        if (!Resource::changedResources.contains(pair.second))
+            return false;
+        splitAliases.push_back(pair.first);
+        return true;
+    });
+    // Whatever was loaded through them still holds the old instance
+    Resource::changedResources.insert(splitAliases.begin(), splitAliases.end());
+    std::erase_if(Resource::contentIndex, [](const auto& pair) {
+        return Resource::changedResources.contains(pair.second);
+    });
+
+    // Everything that depends on a changed resource, directly or not
+    std::vector<ResourceId> order;
+    {
+        std::scoped_lock lock{Resource::dependencyMutex};
+        std::unordered_set<ResourceId> affected;
+        std::vector<ResourceId> toVisit{Resource::changedResources.begin(), Resource::changedResources.end()};
+        while (!toVisit.empty()) {
+            auto identifier = toVisit.back();
+            toVisit.pop_back();
+            if (!affected.insert(identifier).second)
+                continue;
+            if (auto found = Resource::dependents.find(identifier); found != Resource::dependents.end())
+                toVisit.insert(toVisit.end(), found->second.begin(), found->second.end());
+        }
+
+        // Sort them so every resource is recompiled after the affected resources it depends on
+        std::unordered_map<ResourceId, int> remainingDependencies;
+        for (const auto& identifier : affected) {
+            int count = 0;
+            if (auto found = Resource::dependencies.find(identifier); found != Resource::dependencies.end()) {
+                count = static_cast<int>(std::count_if(found->second.begin(), found->second.end(), [&affected](const ResourceId& dependency) {
+                    return affected.contains(dependency);
+                }));
+            }
+            remainingDependencies[identifier] = count;
+            if (!count)
+                order.push_back(identifier);
+        }
+        for (std::size_t i = 0; i < order.size(); i++) {
+            auto found = Resource::dependents.find(order[i]);
+            if (found == Resource::dependents.end())
+                continue;
+            for (const auto& dependent : found->second) {
+                if (--remainingDependencies[dependent] == 0)
+                    order.push_back(dependent);
+            }
+        }
+        // Dependency cycles can't be ordered, reload them last
+        for (const auto& [identifier, count] : remainingDependencies) {
+            if (count > 0)
+                order.push_back(identifier);
+        }
+    }
+    Resource::changedResources.clear();
+
+    for (const auto& identifier : order) {
+        auto cached = Resource::resources.find(identifier);
+        if (cached == Resource::resources.end() || !cached->second->supportsReload())
+            continue;
+        auto* provider = Resource::findResourceProvider(identifier);
+        if (!provider)
+            continue;
+        // Compiling can cache new resources, don't hold onto the iterator
+        auto* resource = cached->second.get();
+        Resource::clearDependencies(identifier);
+        try {
+            provider->compileResource(identifier.getName(), resource);
+            Resource::countMemoryUsage(identifier);
+            LOG_RESOURCE.info(TRF("debug.resource.reloaded", identifier.getString()));
+        } catch (const std::exception& e) {
+            LOG_RESOURCE.error(TRF("error.resource.reload_failed", identifier.getString(), e.what()));
+        }
+    }
+}
+
 std::pair<std::string, std::string> Resource::splitResourceIdentifier(const std::string& identifier) {
     std::pair<std::string, std::string> out;
     size_t pos = identifier.find(RESOURCE_ID_SEPARATOR);
@@ -50,52 +400,374 @@ std::pair<std::string, std::string> Resource::splitResourceIdentifier(const std:
     return out;
 }
 
-const std::vector<std::unique_ptr<IResourceProvider>>& Resource::getResourceProviders(const std::string& providerName) {
+const std::vector<std::unique_ptr<IResourceProvider>>& Resource::getResourceProviders(std::string_view providerName) {
     return Resource::providers.at(providerName);
 }
 
-bool Resource::hasResource(const std::string& identifier) {
-    auto id = Resource::splitResourceIdentifier(identifier);
-    const std::string& provider = id.first, name = id.second;
-    for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-        if (i->get()->hasResource(name))
-            return true;
-    }
-    return false;
+bool Resource::hasResource(const ResourceId& identifier) {
+    return Resource::findResourceProvider(identifier) != nullptr;
 }
 
-void Resource::removeResource(const std::string& identifier) {
-    auto id = Resource::splitResourceIdentifier(identifier);
-    const std::string& provider = id.first, name = id.second;
-    // If the count is 2, then it's being held by the resource manager and the object requesting its removal.
-    // Anything below 2 means it should be already deleted everywhere except the resource manager.
-    if (Resource::resources[provider].contains(name) && Resource::resources[provider][name].useCount() <= 2)
+std::size_t Resource::getErrorCount(const ResourceId& identifier) {
+    if (auto count = Resource::errorCounts.find(identifier); count != Resource::errorCounts.end())
+        return count->second;
+    return 0;
+}
+
+void Resource::removeResource(const ResourceId& identifier) {
+    Resource::aliases.erase(identifier);
+    if (Resource::resources.contains(identifier))
         Resource::garbageResources.push_back(identifier);
 }
 
+void Resource::deferDestruction(std::function<void()> destroy) {
+    std::scoped_lock lock{Resource::deferredDestructionsMutex};
+    Resource::deferredDestructions.push_back(std::move(destroy));
+}
+
+void Resource::collectGarbage() {
+    const auto budget = res_gc_budget_ms.getValue<double>();
+    if (budget <= 0.0) {
+        Resource::cleanup();
+        return;
+    }
+    Resource::collectGarbageUntil(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>{budget}));
+}
+
 void Resource::cleanup() {
-    for (const auto& name : Resource::garbageResources) {
-        auto id = Resource::splitResourceIdentifier(name);
-        Resource::resources[id.first].erase(id.second);
+    Resource::collectGarbageUntil(std::chrono::steady_clock::time_point::max());
+}
+
+void Resource::collectGarbageUntil(std::chrono::steady_clock::time_point deadline) {
+    // Resources first, destroying them can defer more destructions
+    while (!Resource::garbageResources.empty()) {
+        const auto identifier = Resource::garbageResources.front();
+        Resource::garbageResources.pop_front();
+        auto cached = Resource::resources.find(identifier);
+        if (cached == Resource::resources.end())
+            continue;
+        {
+            // Destroy it outside the map, its destructor might release other cached resources
+            Resource::forgetMemoryUsage(cached->second.get());
+            auto removed = std::move(cached->second);
+            Resource::resources.erase(cached);
+            if (removed.useCount() > 1)
+                Resource::releasedResources[identifier] = WeakPointer<Resource>{removed};
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+            return;
+    }
+    while (true) {
+        std::function<void()> destroy;
+        {
+            std::scoped_lock lock{Resource::deferredDestructionsMutex};
+            if (Resource::deferredDestructions.empty())
+                return;
+            destroy = std::move(Resource::deferredDestructions.front());
+            Resource::deferredDestructions.pop_front();
+        }
+        destroy();
+        if (std::chrono::steady_clock::now() >= deadline)
+            return;
+    }
+}
+
+const SharedPointer<Resource>* Resource::findCachedResource(const ResourceId& identifier) {
+    if (auto cached = Resource::resources.find(identifier); cached != Resource::resources.end()) {
+        Resource::markUsed(cached->second.get());
+        return &cached->second;
+    }
+    if (auto alias = Resource::aliases.find(identifier); alias != Resource::aliases.end()) {
+        if (auto cached = Resource::resources.find(alias->second); cached != Resource::resources.end()) {
+            Resource::markUsed(cached->second.get());
+            return &cached->second;
+        }
+        // The original is gone, it has to be loaded on its own again
+        Resource::aliases.erase(alias);
+    }
+    if (Resource::releasedResources.empty())
+        return nullptr;
+    auto released = Resource::releasedResources.find(identifier);
+    if (released == Resource::releasedResources.end())
+        return nullptr;
+    auto resource = released->second.lock();
+    Resource::releasedResources.erase(released);
+    if (!resource)
+        return nullptr;
+    Resource::markUsed(resource.get());
+    const auto revived = Resource::resources.insert_or_assign(identifier, std::move(resource)).first;
+    Resource::countMemoryUsage(identifier);
+    return &revived->second;
+}
+
+void Resource::update() {
+    std::erase_if(Resource::releasedResources, [](const auto& pair) {
+        return pair.second.expired();
+    });
+    Resource::pollResourceProviders();
+    Resource::reloadChangedResources();
+    Resource::evictUnusedResources(static_cast<std::size_t>(std::max(res_cache_budget_mb.getValue<int>(), 0)) * 1024 * 1024);
+    if (Resource::prefetchedBuffersUpdatesLeft > 0 && --Resource::prefetchedBuffersUpdatesLeft == 0) {
+        // Nothing asked for the rest, don't hold onto them
+        std::scoped_lock lock{Resource::prefetchedBuffersMutex};
+        Resource::prefetchedBuffers.clear();
+    }
+
+    int uploaded = 0;
+    while (uploaded < res_async_uploads_per_frame.getValue<int>()) {
+        std::shared_ptr<AsyncResourceLoad> load;
+        {
+            std::scoped_lock lock{Resource::completedLoadsMutex};
+            if (Resource::completedLoads.empty())
+                break;
+            load = std::move(Resource::completedLoads.front());
+            Resource::completedLoads.pop_front();
+        }
+        // It might have been requested synchronously in the meantime
+        if (load->finished)
+            continue;
+        Resource::finishAsyncLoad(load->identifier);
+        uploaded++;
     }
-    Resource::garbageResources.clear();
 }
 
 void Resource::discardAll() {
+    // Wait for loader threads to stop touching providers and resources
+    Resource::loaderThreads.reset();
+    Resource::completedLoads.clear();
+    Resource::pendingLoads.clear();
+    {
+        std::scoped_lock lock{Resource::prefetchedBuffersMutex};
+        Resource::prefetchedBuffers.clear();
+    }
+    Resource::prefetchedBuffersUpdatesLeft = 0;
+    Resource::recordingManifest = false;
+    Resource::manifestEntries.clear();
+    Resource::manifestRecorded.clear();
+
     Resource::defaultResources.clear();
     Resource::cleanup();
-    for (const auto& [providerName, resourceMap] : Resource::resources) {
-        for (const auto& [name, resource] : resourceMap) {
-            // This really shouldn't happen, but it should work out if it does, hence the warning
-            LOG_RESOURCE.warning() << TRF("warn.resource.deleting_resource_at_exit",
-                                          Resource::resources[providerName].at(name)->getIdentifier(),
-                                          Resource::resources[providerName].at(name).useCount());
-        }
+    for (const auto& [identifier, resource] : Resource::resources) {
+        // The cache holding the only reference is fine, but this really shouldn't happen.
+        // It should work out if it does, hence the warning
+        if (resource.useCount() > 1)
+            LOG_RESOURCE.warning() << TRF("warn.resource.deleting_resource_at_exit", identifier.getString(), resource.useCount());
     }
     Resource::resources.clear();
+    Resource::cachedMemoryUsage = {};
+    Resource::releasedResources.clear();
+    Resource::aliases.clear();
+    Resource::contentIndex.clear();
+    // Run whatever destroying the cache deferred
+    Resource::cleanup();
+    Resource::resourceIndex.clear();
+    Resource::missingResources.clear();
+    Resource::errorCounts.clear();
     Resource::providers.clear();
+    Resource::changedResources.clear();
+    {
+        std::scoped_lock lock{Resource::dependencyMutex};
+        Resource::dependents.clear();
+        Resource::dependencies.clear();
+    }
+}
+
+std::shared_ptr<AsyncResourceLoad> Resource::queueAsyncLoad(const ResourceId& identifier, IResourceProvider* provider, const SharedPointer<Resource>& resource) {
+    auto load = std::make_shared<AsyncResourceLoad>();
+    load->identifier = identifier;
+    load->provider = provider;
+    load->resource = resource.get();
+
+    // Keeps the resource alive while it is loading, even if every handle to it is dropped
+    Resource::pendingLoads[identifier] = {resource, load};
+
+    Resource::getLoaderThreads().submit([load] {
+        try {
+            ResourceLoadProfiler::LoadScope profile{load->identifier};
+            {
+                ResourceLoadProfiler::StageScope read{ResourceLoadStage::READ};
+                load->buffer = load->provider->readResource(load->identifier.getName());
+            }
+            if (load->resource->supportsAsyncCompile()) {
+                Resource::CompileScope scope{load->identifier};
+                load->resource->compileFromBuffer(load->buffer);
+                load->compiled = true;
+                load->buffer = {};
+            }
+        } catch (const std::exception& e) {
+            load->error = e.what();
+        }
+        {
+            std::scoped_lock lock{Resource::completedLoadsMutex};
+            Resource::completedLoads.push_back(load);
+        }
+        load->readPromise.set_value();
+    });
+    return load;
+}
+
+bool Resource::finishAsyncLoad(const ResourceId& identifier) {
+    auto pending = Resource::pendingLoads.find(identifier);
+    if (pending == Resource::pendingLoads.end())
+        return false;
+    auto [resource, load] = std::move(pending->second);
+    Resource::pendingLoads.erase(pending);
+
+    load->readFuture.wait();
+    load->finished = true;
+    if (load->error.empty() && !load->compiled) {
+        try {
+            // Recorded separately from the part of the load done on the loader thread
+            Resource::CompileScope scope{identifier};
+            ResourceLoadProfiler::LoadScope profile{identifier};
+            resource->compileFromBuffer(load->buffer);
+        } catch (const std::exception& e) {
+            load->error = e.what();
+        }
+        load->buffer = {};
+    }
+    if (!load->error.empty()) {
+        load->failed = true;
+        LOG_RESOURCE.error(TRF("error.resource.async_load_failed", identifier.getString(), load->error));
+        return false;
+    }
+    // Hand it over to the cache
+    Resource::markUsed(resource.get());
+    auto& cached = Resource::resources[identifier];
+    if (cached)
+        Resource::forgetMemoryUsage(cached.get());
+    cached = std::move(resource);
+    Resource::countMemoryUsage(identifier);
+    return true;
+}
+
+ThreadPool& Resource::getLoaderThreads() {
+    if (!Resource::loaderThreads) {
+        Resource::loaderThreads = std::make_unique<ThreadPool>(std::max(res_async_loader_threads.getValue<int>(), 0));
+    }
+    return *Resource::loaderThreads;
+}
+
+void Resource::startRecordingManifest() {
+    Resource::recordingManifest = true;
+    Resource::manifestEntries.clear();
+    Resource::manifestRecorded.clear();
+}
+
+bool Resource::saveManifest(const std::string& path) {
+    Resource::recordingManifest = false;
+    std::ofstream file{path, std::ios::trunc};
+    if (!file) {
+        LOG_RESOURCE.error(TRF("error.resource.cannot_write_manifest", path));
+        return false;
+    }
+    auto entries = nlohmann::json::array();
+    for (const auto& [identifier, type] : Resource::manifestEntries) {
+        entries.push_back({
+            {"identifier", identifier.getString()},
+            {"type", type},
+        });
+    }
+    file << nlohmann::json{{"resources", entries}}.dump(4);
+    return true;
+}
+
+bool Resource::precacheManifest(const ResourceId& manifest) {
+    auto* manifestProvider = Resource::findResourceProvider(manifest);
+    if (!manifestProvider) {
+        Resource::logResourceError("error.resource.resource_not_found", manifest);
+        return false;
+    }
+    nlohmann::json contents;
+    try {
+        const auto buffer = manifestProvider->readResource(manifest.getName());
+        // Skip the null terminator
+        const auto* text = reinterpret_cast<const char*>(buffer.data());
+        contents = nlohmann::json::parse(text, text + buffer.size() - 1);
+    } catch (const std::exception& e) {
+        LOG_RESOURCE.error(TRF("error.resource.invalid_manifest", manifest.getString(), e.what()));
+        return false;
+    }
+
+    struct ManifestLoad {
+        ResourceId identifier;
+        std::string type;
+        IResourceProvider* provider;
+    };
+    std::vector<ManifestLoad> loads;
+    // Each provider gets every read at once, so it can batch them
+    std::unordered_map<IResourceProvider*, std::vector<ResourceId>> batches;
+    std::unordered_set<ResourceId> queued;
+    for (const auto& entry : contents.value("resources", nlohmann::json::array())) {
+        const ResourceId identifier{entry.value("identifier", std::string{})};
+        if (Resource::findCachedResource(identifier) || Resource::pendingLoads.contains(identifier) || !queued.insert(identifier).second)
+            continue;
+        // Manifests can go stale, anything that's gone is simply skipped
+        auto* provider = Resource::findResourceProvider(identifier);
+        if (!provider)
+            continue;
+        loads.push_back({identifier, entry.value("type", std::string{}), provider});
+        batches[provider].push_back(identifier);
+    }
+
+    for (auto& [provider, identifiers] : batches) {
+        auto reads = std::make_shared<std::vector<std::promise<ResourceBuffer>>>(identifiers.size());
+        std::vector<std::string> names;
+        {
+            std::scoped_lock lock{Resource::prefetchedBuffersMutex};
+            for (std::size_t i = 0; i < identifiers.size(); i++) {
+                Resource::prefetchedBuffers.emplace(identifiers[i], (*reads)[i].get_future().share());
+                names.emplace_back(identifiers[i].getName());
+            }
+        }
+        provider->readResources(std::move(names), [reads](std::size_t index, ResourceBuffer buffer, std::exception_ptr error) {
+            if (error)
+                (*reads)[index].set_exception(std::move(error));
+            else
+                (*reads)[index].set_value(std::move(buffer));
+        });
+    }
+
+    // Dependencies were recorded before what depends on them, so they're cached by the time they're requested.
+    // Resources that can only be prefetched are compiled when something requests them, see update()
+    for (const auto& [identifier, type, provider] : loads) {
+        if (type.empty() || !ResourceFactory::hasTypeFactory(type) || Resource::findCachedResource(identifier))
+            continue;
+        auto* resource = Resource::cacheResource(identifier, ResourceFactory::getTypeFactory(type)(std::string{identifier.getString()}));
+        // Factories don't take parameters
+        resource->deduplicationSeed = 0;
+        provider->compileResource(identifier.getName(), resource);
+        Resource::countMemoryUsage(identifier);
+    }
+
+    // Manifests are usually precached while loading, and the rest is requested over the following frame.
+    // The update() that starts that frame doesn't count
+    Resource::prefetchedBuffersUpdatesLeft = 2;
+    return true;
+}
+
+std::optional<ResourceBuffer> Resource::takePrefetchedBuffer(const ResourceId& identifier) {
+    std::shared_future<ResourceBuffer> read;
+    {
+        std::scoped_lock lock{Resource::prefetchedBuffersMutex};
+        auto prefetched = Resource::prefetchedBuffers.find(identifier);
+        if (prefetched == Resource::prefetchedBuffers.end())
+            return std::nullopt;
+        read = std::move(prefetched->second);
+        Resource::prefetchedBuffers.erase(prefetched);
+    }
+    try {
+        return read.get();
+    } catch (const std::exception&) {
+        // Let the provider read it again and report the error the usual way
+        return std::nullopt;
+    }
 }
 
-void Resource::logResourceError(const std::string& identifier, const std::string& resourceName) {
-    LOG_RESOURCE.error(TRF(identifier, resourceName));
+void Resource::logResourceError(const std::string& errorKey, const ResourceId& identifier) {
+    const auto count = ++Resource::errorCounts[identifier];
+    if (count == 1)
+        LOG_RESOURCE.error(TRF(errorKey, identifier.getString()));
+    else if ((count & (count - 1)) == 0)
+        LOG_RESOURCE.error(TRF("error.resource.repeated", TRF(errorKey, identifier.getString()), count));
 }
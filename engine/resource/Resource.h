@@ -1,86 +1,192 @@
 #pragma once
 
+#include <chrono>
+#include <deque>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include <nlohmann/json.hpp>
 #include <core/Logger.h>
 #include <math/Types.h>
+#include <utility/AbstractFactory.h>
+#include <utility/Concepts.h>
+#include <utility/NoCopyOrMove.h>
 #include <utility/SharedPointer.h>
+#include <utility/ThreadPool.h>
 #include <utility/Types.h>
 #include "provider/IResourceProvider.h"
+#include "ResourceBuffer.h"
+#include "ResourceId.h"
 
 namespace chira {
 
-constexpr std::string_view RESOURCE_ID_SEPARATOR = "://";
+class Resource;
+template<typename ResourceType> class AsyncResource;
+
+/// Constructs resources of registered types from just their identifier, see CHIRA_REGISTER_RESOURCE_TYPE.
+using ResourceFactory = AbstractFactory<Resource*>;
+
+/// An estimate of the memory a resource is responsible for, in bytes.
+struct ResourceMemoryUsage {
+    std::size_t cpu = 0;
+    std::size_t gpu = 0;
+
+    ResourceMemoryUsage& operator+=(const ResourceMemoryUsage& other) {
+        this->cpu += other.cpu;
+        this->gpu += other.gpu;
+        return *this;
+    }
+    ResourceMemoryUsage& operator-=(const ResourceMemoryUsage& other) {
+        this->cpu -= other.cpu;
+        this->gpu -= other.gpu;
+        return *this;
+    }
+    [[nodiscard]] std::size_t total() const {
+        return this->cpu + this->gpu;
+    }
+};
+
+/// Bookkeeping for a resource being loaded in the background.
+/// Loader threads only ever touch the provider, the raw resource pointer, and the buffer.
+struct AsyncResourceLoad {
+    ResourceId identifier;
+    IResourceProvider* provider = nullptr;
+    Resource* resource = nullptr;
+    ResourceBuffer buffer;
+    /// Set on the loader thread if the resource was compiled there.
+    bool compiled = false;
+    /// Set on the loader thread if reading or compiling threw, holds the reason.
+    std::string error;
+    /// Set on the main thread once the resource is compiled and cached, or once it failed.
+    bool finished = false;
+    /// Set on the main thread if the load failed. The resource was never compiled and must not be handed out.
+    bool failed = false;
+    std::promise<void> readPromise;
+    std::shared_future<void> readFuture = readPromise.get_future().share();
+};
 
 /// A chunk of data, usually a file. Is typically cached and shared.
-class Resource {
+class Resource : public ReferenceCounted {
     // To view resource data
     friend class ResourceUsageTrackerPanel;
+    // To finish its load without falling back to a synchronous one
+    template<typename ResourceType>
+    friend class AsyncResource;
 public:
-    explicit Resource(std::string identifier_)
-            : identifier(std::move(identifier_)) {}
+    explicit Resource(ResourceId identifier_)
+            : identifier(identifier_) {}
 
-    virtual ~Resource();
+    ~Resource() override = default;
 
     virtual void compile(const byte /*buffer*/[], std::size_t /*bufferLength*/) = 0;
 
+    /// Called by resource providers. Forwards to compile() by default, override it
+    /// to hold onto the buffer (and the file mapping behind it) instead of copying it.
+    virtual void compileFromBuffer(const ResourceBuffer& buffer) {
+        this->compile(buffer.data(), buffer.size());
+    }
+
+    /// Return true if compile() only touches CPU memory owned by this resource,
+    /// and can therefore run on a resource loader thread.
+    [[nodiscard]] virtual bool supportsAsyncCompile() const {
+        return false;
+    }
+
+    /// Memory owned by this resource. Memory owned by other resources it holds onto is not included.
+    [[nodiscard]] virtual ResourceMemoryUsage getMemoryUsage() const {
+        return {};
+    }
+
+    /// Return false if compile() can't be called a second time to replace the contents of the resource.
+    /// Resources that can be recompiled must release whatever the previous compile() created.
+    [[nodiscard]] virtual bool supportsReload() const {
+        return true;
+    }
+
+    /// The returned view is null-terminated.
     [[nodiscard]] std::string_view getIdentifier() const {
+        return this->identifier.getString();
+    }
+
+    [[nodiscard]] const ResourceId& getResourceId() const {
         return this->identifier;
     }
 
 protected:
-    std::string identifier;
+    ResourceId identifier;
+    /// When this was last requested from the cache, for eviction.
+    std::uint64_t lastUsed = 0;
+    /// What this resource currently adds to cachedMemoryUsage.
+    ResourceMemoryUsage countedMemoryUsage;
+    /// Set by the cache before a new resource is first compiled if it could share an instance with an identical one.
+    /// Hashes the constructor parameters, so resources built from the same bytes with different parameters stay apart.
+    std::optional<std::uint64_t> deduplicationSeed;
 
 //
 // Static caching functions
 //
 public:
+    /// While alive, resources requested on this thread are recorded as dependencies of the given resource.
+    /// Resource providers open one around compiling a resource.
+    struct CompileScope : public NoCopyOrMove {
+        explicit CompileScope(const ResourceId& identifier);
+        ~CompileScope();
+    };
+
     static void addResourceProvider(IResourceProvider* provider);
 
-    static IResourceProvider* getLatestResourceProvider(const std::string& provider);
+    static IResourceProvider* getLatestResourceProvider(std::string_view provider);
 
-    static IResourceProvider* getResourceProviderWithResource(const std::string& identifier);
+    static IResourceProvider* getResourceProviderWithResource(const ResourceId& identifier);
 
     template<typename ResourceType, typename... Params>
-    static SharedPointer<ResourceType> getResource(const std::string& identifier, Params... params) {
-        Resource::cleanup();
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        if (Resource::resources[provider].count(name) > 0) {
-            return Resource::resources[provider][name].template cast<ResourceType>();
+    static SharedPointer<ResourceType> getResource(const ResourceId& identifier, Params... params) {
+        Resource::recordDependency(identifier);
+        if (const auto* resource = Resource::findCachedResource(identifier)) {
+            return resource->template cast<ResourceType>();
+        }
+        if (Resource::pendingLoads.contains(identifier) && Resource::finishAsyncLoad(identifier)) {
+            return Resource::resources[identifier].template cast<ResourceType>();
         }
         return Resource::getUniqueResource<ResourceType>(identifier, std::forward<Params>(params)...);
     }
 
     template<typename ResourceType, typename... Params>
-    static void precacheResource(const std::string& identifier, Params... params) {
-        Resource::cleanup();
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        if (Resource::resources[provider].count(name) > 0) {
+    static void precacheResource(const ResourceId& identifier, Params... params) {
+        Resource::recordDependency(identifier);
+        if (Resource::findCachedResource(identifier)) {
             return; // Already in cache
         }
+        if (Resource::pendingLoads.contains(identifier) && Resource::finishAsyncLoad(identifier)) {
+            return; // Finished loading in the background
+        }
 
-        for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-            if ((*i)->hasResource(name)) {
-                Resource::resources[provider][name] = SharedPointer<Resource>(new ResourceType{identifier, std::forward<Params>(params)...});
-                (*i)->compileResource(name, Resource::resources[provider][name].get());
-                return; // Precached!
-            }
+        if (auto* provider = Resource::findResourceProvider(identifier)) {
+            const auto seed = Resource::getDeduplicationSeed(params...);
+            auto* resource = Resource::cacheResource(identifier, new ResourceType{std::string{identifier.getString()}, std::forward<Params>(params)...});
+            resource->deduplicationSeed = seed;
+            provider->compileResource(identifier.getName(), resource);
+            Resource::countMemoryUsage(identifier);
+            Resource::recordManifestEntry<ResourceType, Params...>(identifier);
+            return; // Precached!
         }
         Resource::logResourceError("error.resource.resource_not_found", identifier);
     }
 
     template<typename ResourceType>
-    static SharedPointer<ResourceType> getCachedResource(const std::string& identifier) {
-        Resource::cleanup();
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        if (Resource::resources[provider].count(name) > 0) {
-            return Resource::resources[provider][name].cast<ResourceType>();
+    static SharedPointer<ResourceType> getCachedResource(const ResourceId& identifier) {
+        if (const auto* resource = Resource::findCachedResource(identifier)) {
+            return resource->template cast<ResourceType>();
         }
         Resource::logResourceError("error.resource.cached_resource_not_found", identifier);
         if (Resource::hasDefaultResource<ResourceType>())
@@ -88,16 +194,54 @@ public:
         return SharedPointer<ResourceType>{};
     }
 
+    /// Starts loading the resource in the background and returns immediately.
+    /// Until the resource is ready, the handle returns the default resource of the type.
+    template<typename ResourceType, typename... Params>
+    static AsyncResource<ResourceType> getResourceAsync(const ResourceId& identifier, Params... params) {
+        Resource::recordDependency(identifier);
+        if (const auto* resource = Resource::findCachedResource(identifier)) {
+            return AsyncResource<ResourceType>{resource->template cast<ResourceType>(), nullptr};
+        }
+        if (auto pending = Resource::pendingLoads.find(identifier); pending != Resource::pendingLoads.end()) {
+            return AsyncResource<ResourceType>{pending->second.first.template cast<ResourceType>(), pending->second.second};
+        }
+        auto* provider = Resource::getResourceProviderWithResource(identifier);
+        if (!provider) {
+            return AsyncResource<ResourceType>{};
+        }
+        auto resource = SharedPointer<Resource>(new ResourceType{std::string{identifier.getString()}, std::forward<Params>(params)...});
+        auto load = Resource::queueAsyncLoad(identifier, provider, resource);
+        Resource::recordManifestEntry<ResourceType, Params...>(identifier);
+        return AsyncResource<ResourceType>{resource.template cast<ResourceType>(), load};
+    }
+
+    /// Starts loading the resource in the background, to be picked up from the cache later.
+    template<typename ResourceType, typename... Params>
+    static void precacheResourceAsync(const ResourceId& identifier, Params... params) {
+        Resource::recordDependency(identifier);
+        if (Resource::findCachedResource(identifier) || Resource::pendingLoads.contains(identifier)) {
+            return; // Already in cache or on its way
+        }
+        auto* provider = Resource::getResourceProviderWithResource(identifier);
+        if (!provider) {
+            return;
+        }
+        Resource::queueAsyncLoad(identifier, provider, SharedPointer<Resource>(new ResourceType{std::string{identifier.getString()}, std::forward<Params>(params)...}));
+        Resource::recordManifestEntry<ResourceType, Params...>(identifier);
+    }
+
     template<typename ResourceType, typename... Params>
-    static SharedPointer<ResourceType> getUniqueResource(const std::string& identifier, Params... params) {
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-            if ((*i)->hasResource(name)) {
-                Resource::resources[provider][name] = SharedPointer<Resource>(new ResourceType{identifier, std::forward<Params>(params)...});
-                (*i)->compileResource(name, Resource::resources[provider][name].get());
-                return Resource::resources[provider][name].template cast<ResourceType>();
-            }
+    static SharedPointer<ResourceType> getUniqueResource(const ResourceId& identifier, Params... params) {
+        Resource::recordDependency(identifier);
+        if (auto* provider = Resource::findResourceProvider(identifier)) {
+            const auto seed = Resource::getDeduplicationSeed(params...);
+            auto* resource = Resource::cacheResource(identifier, new ResourceType{std::string{identifier.getString()}, std::forward<Params>(params)...});
+            resource->deduplicationSeed = seed;
+            provider->compileResource(identifier.getName(), resource);
+            Resource::countMemoryUsage(identifier);
+            Resource::recordManifestEntry<ResourceType, Params...>(identifier);
+            // Might be an identical resource if it was deduplicated
+            return Resource::findCachedResource(identifier)->template cast<ResourceType>();
         }
         Resource::logResourceError("error.resource.resource_not_found", identifier);
         if (Resource::hasDefaultResource<ResourceType>())
@@ -107,17 +251,14 @@ public:
 
     /// You might want to use this sparingly as it defeats the entire point of a cached, shared resource system.
     template<typename ResourceType, typename... Params>
-    static SharedPointer<ResourceType> getUniqueUncachedResource(const std::string& identifier, Params... params) {
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-            if ((*i)->hasResource(name)) {
-                auto resource = SharedPointer<ResourceType>(new ResourceType{identifier, std::forward<Params>(params)...});
-                (*i)->compileResource(name, resource.get());
-                // We're not holding onto this
-                resource.setHolderAmountForDelete(0);
-                return resource;
-            }
+    static SharedPointer<ResourceType> getUniqueUncachedResource(const ResourceId& identifier, Params... params) {
+        Resource::recordDependency(identifier);
+        if (auto* provider = Resource::findResourceProvider(identifier)) {
+            auto resource = SharedPointer<ResourceType>(new ResourceType{std::string{identifier.getString()}, std::forward<Params>(params)...});
+            provider->compileResource(identifier.getName(), resource.get());
+            // Uncached resources can't be precompiled, but their bytes can still be prefetched
+            Resource::recordManifestEntry<void>(identifier);
+            return resource;
         }
         Resource::logResourceError("error.resource.resource_not_found", identifier);
         return SharedPointer<ResourceType>{};
@@ -134,19 +275,91 @@ public:
 
     static std::pair<std::string, std::string> splitResourceIdentifier(const std::string& identifier);
 
-    static const std::vector<std::unique_ptr<IResourceProvider>>& getResourceProviders(const std::string& providerName);
+    static const std::vector<std::unique_ptr<IResourceProvider>>& getResourceProviders(std::string_view providerName);
+
+    static bool hasResource(const ResourceId& identifier);
 
-    static bool hasResource(const std::string& identifier);
+    /// The threads resources are loaded on in the background. Started the first time this is called.
+    static ThreadPool& getLoaderThreads();
 
-    /// If resource is present in the cache and has a reference count less than or equal to 2, mark it for removal.
-    static void removeResource(const std::string& identifier);
+    /// How many errors were reported for the identifier since it was last found by a provider.
+    [[nodiscard]] static std::size_t getErrorCount(const ResourceId& identifier);
 
-    /// Delete all resources marked for removal.
+    /// Marks the resource for removal from the cache. It stays cached until the next collectGarbage(),
+    /// and is destroyed once nothing else holds it.
+    static void removeResource(const ResourceId& identifier);
+
+    /// Runs the given function on the main thread during the next collectGarbage().
+    /// Resources can be destroyed on any thread, so anything that has to be destroyed on the main thread
+    /// (like render backend objects) should be handed over here from their destructor. Thread-safe.
+    static void deferDestruction(std::function<void()> destroy);
+
+    /// Called once per frame on the main thread, after everything else. Removes resources marked for removal
+    /// from the cache and runs deferred destructions, oldest first, until the time set by res_gc_budget_ms
+    /// runs out. Whatever is left over is picked up next frame.
+    static void collectGarbage();
+
+    /// Removes all resources marked for removal from the cache and runs every deferred destruction.
     static void cleanup();
 
+    /// Called once per frame on the main thread. Picks up resources added to or removed from providers,
+    /// recompiles changed resources, and compiles and caches a limited number of resources that finished
+    /// loading in the background.
+    static void update();
+
+    /// Recompiles the cached resource in place on the next update(), along with every cached resource
+    /// that depends on it. Called automatically when a provider reports that a resource changed.
+    static void reloadResource(const ResourceId& identifier);
+
+    /// The combined memory usage of every cached resource, as of when each was cached or last compiled.
+    [[nodiscard]] static ResourceMemoryUsage getCachedMemoryUsage();
+
+    /// Called by resource providers after reading a resource for the first time, before compiling it.
+    /// While res_dedup_content is enabled, a new cached resource with the same type, contents and parameters as
+    /// another cached resource is dropped, and its identifier is made an alias of the other one.
+    /// Returns true if that happened, in which case the resource was destroyed and must not be compiled.
+    static bool deduplicate(Resource* resource, const ResourceBuffer& buffer);
+
+    /// The number of identifiers that share the instance of an identical resource.
+    [[nodiscard]] static std::size_t getDeduplicatedCount();
+
+    /// The memory deduplicated identifiers would use if they each had their own instance.
+    [[nodiscard]] static ResourceMemoryUsage getDeduplicatedMemoryUsage();
+
+    /// Evicts cached resources that nothing else holds, least recently used first,
+    /// until the cache uses at most the given number of bytes or nothing else can be evicted.
+    /// Called every update() with the budget set by res_cache_budget_mb, and only walks the cache when it is over budget.
+    static void evictUnusedResources(std::size_t budget);
+
+    /// Returns the resources that requested the given resource while they were compiling.
+    [[nodiscard]] static std::vector<ResourceId> getResourceDependents(const ResourceId& identifier);
+
     /// Deletes ALL resources and providers. Should only ever be called once, when the program closes.
     static void discardAll();
 
+    /// Starts recording every resource that gets loaded, in the order they finish compiling.
+    static void startRecordingManifest();
+    /// Stops recording and writes what was recorded as a manifest for precacheManifest().
+    /// Returns false if the file could not be written.
+    static bool saveManifest(const std::string& path);
+    /// Reads every resource in the manifest in the background at once, one batch per provider, then compiles and caches
+    /// the ones of registered types in recorded order as their reads land, which puts dependencies first.
+    /// Blocks until that's done. Reads nothing asked for yet, like resources with constructor parameters,
+    /// are kept for whatever requests them during the next frame, then dropped.
+    static bool precacheManifest(const ResourceId& manifest);
+    /// Called by resource providers before reading a resource themselves.
+    /// Waits for the read if precacheManifest() started one and it hasn't finished yet.
+    [[nodiscard]] static std::optional<ResourceBuffer> takePrefetchedBuffer(const ResourceId& identifier);
+
+    /// Lets precacheManifest() construct resources of this type. It must be constructible from only its identifier.
+    template<typename ResourceType>
+    static bool registerResourceType(const std::string& name) {
+        Resource::getResourceTypeNames()[typeHash<ResourceType>()] = name;
+        return ResourceFactory::registerTypeFactory(name, [](const std::string& identifier) -> Resource* {
+            return new ResourceType{identifier};
+        });
+    }
+
     template<typename ResourceType>
     static bool registerDefaultResource(const std::string& identifier) {
         Resource::getDefaultResourceConstructors()[typeHash<ResourceType>()] = [identifier] {
@@ -172,18 +385,183 @@ public:
     }
 
 protected:
-    static inline std::unordered_map<std::string, std::vector<std::unique_ptr<IResourceProvider>>> providers;
-    static inline std::unordered_map<std::string, std::unordered_map<std::string, SharedPointer<Resource>>> resources;
+    /// Keyed by interned provider name.
+    static inline std::unordered_map<std::string_view, std::vector<std::unique_ptr<IResourceProvider>>> providers;
+    /// The cache co-owns everything in it, so resources outlive their last handle until they are evicted.
+    static inline std::unordered_map<ResourceId, SharedPointer<Resource>> resources;
+    /// Kept up to date as resources enter the cache, leave it, or are compiled, so the budget can be checked every frame.
+    static inline ResourceMemoryUsage cachedMemoryUsage;
+    /// Resources removed from the cache while something else still held them. They are put back in the cache
+    /// if they're requested again before they are destroyed, so they are never loaded twice.
+    static inline std::unordered_map<ResourceId, WeakPointer<Resource>> releasedResources;
+    static inline std::uint64_t useCounter = 0;
+    /// Every resource of every provider that can list its resources, mapped to the provider that wins for it.
+    static inline std::unordered_map<ResourceId, IResourceProvider*> resourceIndex;
+    /// Identifiers that share the cached instance of another identifier with identical contents, see deduplicate().
+    static inline std::unordered_map<ResourceId, ResourceId> aliases;
+    /// Hash of the contents of a resource (seeded with its type and parameters) to the identifier it was cached under
+    static inline std::unordered_map<std::uint64_t, ResourceId> contentIndex;
+    /// Identifiers no provider had when they were looked up, so they aren't looked up again.
+    /// Forgotten when a provider is added under the same name, or when a provider reports the resource was added.
+    static inline std::unordered_set<ResourceId> missingResources;
+    static inline std::unordered_map<ResourceId, std::size_t> errorCounts;
     static inline std::unordered_map<std::type_index, SharedPointer<Resource>> defaultResources;
-    static inline std::vector<std::string> garbageResources;
+    /// Resources marked for removal, oldest first.
+    static inline std::deque<ResourceId> garbageResources;
+    static inline std::deque<std::function<void()>> deferredDestructions;
+    static inline std::mutex deferredDestructionsMutex;
+
+    static inline std::unique_ptr<ThreadPool> loaderThreads;
+    /// Resources being loaded in the background. Only accessed on the main thread.
+    static inline std::unordered_map<ResourceId, std::pair<SharedPointer<Resource>, std::shared_ptr<AsyncResourceLoad>>> pendingLoads;
+    /// Loads that loader threads have finished reading, in completion order.
+    static inline std::deque<std::shared_ptr<AsyncResourceLoad>> completedLoads;
+    static inline std::mutex completedLoadsMutex;
+
+    /// Resources being compiled on this thread, innermost last.
+    static inline thread_local std::vector<ResourceId> compileStack;
+    /// Maps a resource to the resources that requested it while compiling, and the reverse.
+    /// Includes uncached resources, so a shader is still reloaded when one of its source files changes.
+    static inline std::unordered_map<ResourceId, std::unordered_set<ResourceId>> dependents;
+    static inline std::unordered_map<ResourceId, std::unordered_set<ResourceId>> dependencies;
+    static inline std::mutex dependencyMutex;
+    /// Resources to reload on the next update(). Only accessed on the main thread.
+    static inline std::unordered_set<ResourceId> changedResources;
+
+    static inline bool recordingManifest = false;
+    /// Recorded resources with the registered name of their type, or an empty name if they can only be prefetched
+    static inline std::vector<std::pair<ResourceId, std::string>> manifestEntries;
+    static inline std::unordered_set<ResourceId> manifestRecorded;
+    /// Reads started by precacheManifest() that nothing has picked up yet
+    static inline std::unordered_map<ResourceId, std::shared_future<ResourceBuffer>> prefetchedBuffers;
+    static inline std::mutex prefetchedBuffersMutex;
+    /// How many more update() calls keep prefetchedBuffers around. Only accessed on the main thread.
+    static inline int prefetchedBuffersUpdatesLeft = 0;
 
     static auto getDefaultResourceConstructors() -> std::unordered_map<std::type_index, std::function<void()>>& {
         static std::unordered_map<std::type_index, std::function<void()>> defaultResourceConstructors;
         return defaultResourceConstructors;
     }
 
+    static auto getResourceTypeNames() -> std::unordered_map<std::type_index, std::string>& {
+        static std::unordered_map<std::type_index, std::string> resourceTypeNames;
+        return resourceTypeNames;
+    }
+
+    /// Returns the latest provider that has the resource, or nullptr. Only logs if the identifier is invalid.
+    static IResourceProvider* findResourceProvider(const ResourceId& identifier);
+
+    /// Takes ownership of the resource and puts it in the cache. Returns the resource.
+    /// Its memory usage is counted by countMemoryUsage() once it has been compiled.
+    static Resource* cacheResource(const ResourceId& identifier, Resource* resource) {
+        auto& cached = Resource::resources[identifier];
+        if (cached)
+            Resource::forgetMemoryUsage(cached.get());
+        cached = SharedPointer<Resource>(resource);
+        Resource::markUsed(resource);
+        return resource;
+    }
+    /// Updates cachedMemoryUsage with the current memory usage of the resource cached under the identifier, if any.
+    static void countMemoryUsage(const ResourceId& identifier);
+    /// Takes the resource out of cachedMemoryUsage, call before it leaves the cache.
+    static void forgetMemoryUsage(Resource* resource) {
+        Resource::cachedMemoryUsage -= std::exchange(resource->countedMemoryUsage, {});
+    }
+    /// Returns the cached resource and marks it as used, or nullptr if it isn't cached.
+    static const SharedPointer<Resource>* findCachedResource(const ResourceId& identifier);
+    /// Returns nothing if any parameter can't be hashed, so the resource is never deduplicated.
+    template<typename... Params>
+    static std::optional<std::uint64_t> getDeduplicationSeed(const Params&... params) {
+        if constexpr ((CHashable<Params> && ...)) {
+            std::uint64_t seed = 0;
+            ((seed = (seed ^ std::hash<Params>{}(params)) * 0x9e3779b185ebca87ull), ...);
+            return seed;
+        } else {
+            return std::nullopt;
+        }
+    }
+    static void markUsed(Resource* resource) {
+        resource->lastUsed = ++Resource::useCounter;
+    }
+
+    /// Removes resources marked for removal and runs deferred destructions until the deadline passes.
+    /// Always does at least one thing if there is anything to do, so it can't stall forever.
+    static void collectGarbageUntil(std::chrono::steady_clock::time_point deadline);
+
+    /// Lets providers report changes, and updates the resource index to match.
+    static void pollResourceProviders();
+    /// Lists every provider with this name again, and forgets which of its resources were missing.
+    static void reindexProviders(std::string_view providerName);
+
+    static void recordDependency(const ResourceId& dependency) {
+        if (!Resource::compileStack.empty() && Resource::compileStack.back() != dependency)
+            Resource::addDependency(Resource::compileStack.back(), dependency);
+    }
+    static void addDependency(const ResourceId& dependent, const ResourceId& dependency);
+
+    template<typename ResourceType, typename... Params>
+    static void recordManifestEntry(const ResourceId& identifier) {
+        if (!Resource::recordingManifest || !Resource::manifestRecorded.insert(identifier).second)
+            return;
+        // Constructor parameters can't be recorded, so those resources are only prefetched
+        if constexpr (std::is_void_v<ResourceType> || sizeof...(Params) > 0) {
+            Resource::manifestEntries.emplace_back(identifier, std::string{});
+        } else {
+            const auto& typeNames = Resource::getResourceTypeNames();
+            const auto typeName = typeNames.find(typeHash<ResourceType>());
+            Resource::manifestEntries.emplace_back(identifier, typeName != typeNames.end() ? typeName->second : std::string{});
+        }
+    }
+    /// Forgets what the resource depends on, before it is compiled again.
+    static void clearDependencies(const ResourceId& dependent);
+
+    /// Recompiles changed resources and their dependents, dependencies first.
+    static void reloadChangedResources();
+
+    static std::shared_ptr<AsyncResourceLoad> queueAsyncLoad(const ResourceId& identifier, IResourceProvider* provider, const SharedPointer<Resource>& resource);
+    /// Blocks until the given pending load is read, then compiles and caches it.
+    /// Returns false if the resource could not be loaded.
+    static bool finishAsyncLoad(const ResourceId& identifier);
+
     /// We do a few predeclaration workarounds
-    static void logResourceError(const std::string& identifier, const std::string& resourceName);
+    /// Logs the first error reported for an identifier, then again with the count each time the count doubles,
+    /// so something requesting a broken resource thousands of times doesn't flood the log.
+    static void logResourceError(const std::string& errorKey, const ResourceId& identifier);
+};
+
+/// Handle to a resource requested with Resource::getResourceAsync.
+template<typename ResourceType>
+class AsyncResource {
+public:
+    AsyncResource() = default;
+    AsyncResource(SharedPointer<ResourceType> resource_, std::shared_ptr<AsyncResourceLoad> load_)
+            : resource(std::move(resource_))
+            , load(std::move(load_)) {}
+
+    /// Returns true if the resource is ready or failed to load. Either way, get() will not change anymore.
+    [[nodiscard]] bool isReady() const {
+        return !this->load || this->load->finished;
+    }
+
+    /// Returns the loaded resource, or the default resource of its type if it is not ready yet or failed to load.
+    [[nodiscard]] SharedPointer<ResourceType> get() const {
+        if (this->resource && this->isReady() && !(this->load && this->load->failed))
+            return this->resource;
+        if (Resource::hasDefaultResource<ResourceType>())
+            return Resource::getDefaultResource<ResourceType>();
+        return SharedPointer<ResourceType>{};
+    }
+
+    /// Blocks until the resource is loaded, then returns it, or the default resource if it failed to load.
+    [[nodiscard]] SharedPointer<ResourceType> wait() const {
+        if (!this->isReady())
+            Resource::finishAsyncLoad(this->load->identifier);
+        return this->get();
+    }
+
+private:
+    SharedPointer<ResourceType> resource;
+    std::shared_ptr<AsyncResourceLoad> load;
 };
 
 } // namespace chira
@@ -191,3 +569,7 @@ protected:
 #define CHIRA_REGISTER_DEFAULT_RESOURCE(type, identifier) \
     static inline const auto type##DefaultResourceRegistryHelper = \
         chira::Resource::registerDefaultResource<type>(identifier)
+
+#define CHIRA_REGISTER_RESOURCE_TYPE(type) \
+    static inline const auto type##ResourceTypeRegistryHelper = \
+        chira::Resource::registerResourceType<type>(#type)
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <math/Types.h>
+
+namespace chira {
+
+/// The read-only contents of a resource, followed by a null terminator that is included in size().
+/// It either owns a heap buffer or keeps a file mapping alive, so copies are cheap and never copy the data.
+/// Anything that holds onto a buffer past compile() should go through keep().
+class ResourceBuffer {
+public:
+    ResourceBuffer() = default;
+
+    /// The vector must already end with a null terminator.
+    explicit ResourceBuffer(std::vector<byte> bytes) {
+        auto owned = std::make_shared<std::vector<byte>>(std::move(bytes));
+        this->data_ = owned->data();
+        this->size_ = owned->size();
+        this->owner = std::move(owned);
+    }
+
+    /// The owner keeps the memory behind data_ alive, e.g. by unmapping it on destruction.
+    /// Volatile memory maps a file that can be rewritten while it is mapped, see isVolatile().
+    ResourceBuffer(std::shared_ptr<const void> owner_, const byte* data_, std::size_t size_, bool volatile_ = false)
+            : owner(std::move(owner_))
+            , data_(data_)
+            , size_(size_)
+            , volatile_(volatile_) {}
+
+    [[nodiscard]] const byte* data() const {
+        return this->data_;
+    }
+
+    /// Includes the null terminator.
+    [[nodiscard]] std::size_t size() const {
+        return this->size_;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return this->size_ == 0;
+    }
+
+    /// A view into part of this buffer that keeps the whole thing alive.
+    /// The caller is responsible for the view ending in a null terminator.
+    [[nodiscard]] ResourceBuffer view(std::size_t offset, std::size_t size) const {
+        return {this->owner, this->data_ + offset, size, this->volatile_};
+    }
+
+    /// The buffer maps a file that can change on disk, e.g. a loose file being hot reloaded.
+    /// Reading it may see the new contents, or raise SIGBUS if the file was truncated.
+    [[nodiscard]] bool isVolatile() const {
+        return this->volatile_;
+    }
+
+    /// A buffer that is safe to hold onto indefinitely: volatile buffers are copied to the heap, the rest are shared.
+    [[nodiscard]] ResourceBuffer keep() const {
+        if (!this->volatile_)
+            return *this;
+        return ResourceBuffer{std::vector<byte>{this->data_, this->data_ + this->size_}};
+    }
+
+private:
+    std::shared_ptr<const void> owner;
+    const byte* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool volatile_ = false;
+};
+
+} // namespace chira
@@ -0,0 +1,32 @@
+#include "ResourceId.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+using namespace chira;
+
+namespace {
+
+/// The strings are already hashed with XXH64, no need to hash them again.
+struct PrehashedStringHash {
+    std::size_t operator()(std::uint64_t hash) const noexcept {
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+} // namespace
+
+std::string_view ResourceId::intern(std::string_view str, std::uint64_t hash) {
+    // Strings in a deque never move, so views into them stay valid
+    static std::deque<std::string> storage;
+    static std::unordered_multimap<std::uint64_t, std::string_view, PrehashedStringHash> interned;
+    static std::mutex internMutex;
+
+    std::scoped_lock lock{internMutex};
+    for (auto [it, end] = interned.equal_range(hash); it != end; ++it) {
+        if (it->second == str)
+            return it->second;
+    }
+    return interned.emplace(hash, storage.emplace_back(str))->second;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility/Hash.h>
+
+namespace chira {
+
+constexpr std::string_view RESOURCE_ID_SEPARATOR = "://";
+
+/// A resource identifier ("provider://name") split and hashed once.
+/// Runtime identifiers are interned, so copies are cheap and the views stay valid (and null-terminated) forever.
+class ResourceId {
+public:
+    constexpr ResourceId() = default;
+
+    // Implicit on purpose, so identifiers can still be passed around as strings
+    ResourceId(std::string_view identifier_) // NOLINT(google-explicit-constructor)
+            : ResourceId(identifier_, Hash::xxh64(identifier_)) {}
+    ResourceId(const std::string& identifier_) // NOLINT(google-explicit-constructor)
+            : ResourceId(std::string_view{identifier_}) {}
+    ResourceId(const char* identifier_) // NOLINT(google-explicit-constructor)
+            : ResourceId(std::string_view{identifier_}) {}
+
+    /// For identifiers known at compile time. The literal outlives everything, so no interning is needed.
+    static consteval ResourceId fromLiteral(std::string_view literal) {
+        return ResourceId{literal, true};
+    }
+
+    [[nodiscard]] constexpr std::string_view getString() const {
+        return this->identifier;
+    }
+    [[nodiscard]] constexpr std::string_view getProvider() const {
+        return this->identifier.substr(0, this->separator);
+    }
+    [[nodiscard]] constexpr std::string_view getName() const {
+        if (this->separator == std::string_view::npos)
+            return {};
+        return this->identifier.substr(this->separator + RESOURCE_ID_SEPARATOR.length());
+    }
+    [[nodiscard]] constexpr std::uint64_t getHash() const {
+        return this->hash;
+    }
+    /// Returns false if the identifier has no provider separator.
+    [[nodiscard]] constexpr bool isValid() const {
+        return this->separator != std::string_view::npos;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const ResourceId& other) const {
+        return this->hash == other.hash && this->identifier == other.identifier;
+    }
+
+    /// Returns a view of the interned copy of the string, interning it if it is new.
+    [[nodiscard]] static std::string_view intern(std::string_view str) {
+        return ResourceId::intern(str, Hash::xxh64(str));
+    }
+
+private:
+    std::string_view identifier;
+    std::size_t separator = std::string_view::npos;
+    std::uint64_t hash = Hash::xxh64({});
+
+    constexpr ResourceId(std::string_view identifier_, bool)
+            : identifier(identifier_)
+            , separator(identifier_.find(RESOURCE_ID_SEPARATOR))
+            , hash(Hash::xxh64(identifier_)) {}
+
+    ResourceId(std::string_view identifier_, std::uint64_t hash_)
+            : identifier(ResourceId::intern(identifier_, hash_))
+            , separator(identifier_.find(RESOURCE_ID_SEPARATOR))
+            , hash(hash_) {}
+
+    /// Hash must be the XXH64 hash of the string, so it is only computed once.
+    [[nodiscard]] static std::string_view intern(std::string_view str, std::uint64_t hash);
+};
+
+inline namespace literals {
+
+consteval ResourceId operator""_rid(const char* identifier, std::size_t length) {
+    return ResourceId::fromLiteral({identifier, length});
+}
+
+} // namespace literals
+
+} // namespace chira
+
+template<>
+struct std::hash<chira::ResourceId> {
+    std::size_t operator()(const chira::ResourceId& id) const noexcept {
+        return static_cast<std::size_t>(id.getHash());
+    }
+};
@@ -0,0 +1,172 @@
+#include "ResourceLoadProfiler.h"
+
+#include <fstream>
+#include <sstream>
+#include <nlohmann/json.hpp>
+#include <config/ConEntry.h>
+#include <core/Logger.h>
+#include <i18n/TranslationManager.h>
+
+using namespace chira;
+
+CHIRA_CREATE_LOG(RESOURCE_PROFILER);
+
+ConVar res_profile_loads{"res_profile_loads", true, "Record how long each resource takes to load. See res_load_report.", CON_FLAG_CACHE};
+
+[[maybe_unused]]
+ConCommand res_load_report{"res_load_report", "Writes the recorded resource load times to the given file, as CSV if it ends with \".csv\" and as JSON otherwise.", [](ConCommand::CallbackArgs args) {
+    const std::string path = args.empty() ? "resource_load_report.json" : args[0];
+    if (ResourceLoadProfiler::writeReport(path)) {
+        LOG_RESOURCE_PROFILER.infoImportant(TRF("debug.resource_profiler.report_written", path));
+    }
+}};
+
+[[maybe_unused]]
+ConCommand res_load_report_clear{"res_load_report_clear", "Clears the recorded resource load times.", [] {
+    ResourceLoadProfiler::clearRecords();
+}};
+
+namespace {
+
+double millisecondsSince(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+} // namespace
+
+ResourceLoadProfiler::LoadScope::LoadScope(const ResourceId& identifier) {
+    if (!res_profile_loads.getValue<bool>()) {
+        // Still push an entry, so stages and nested loads aren't attributed to whatever encloses this
+        ResourceLoadProfiler::loadStack.emplace_back(-1, 0);
+        return;
+    }
+    this->begin = std::chrono::steady_clock::now();
+
+    std::scoped_lock lock{ResourceLoadProfiler::recordsMutex};
+    if (ResourceLoadProfiler::records.empty()) {
+        ResourceLoadProfiler::epoch = this->begin;
+    }
+    ResourceLoadRecord entry{
+        .identifier = identifier,
+        .parent = ResourceLoadProfiler::getCurrentRecord(),
+        .start = millisecondsSince(ResourceLoadProfiler::epoch, this->begin),
+    };
+    if (entry.parent >= 0) {
+        entry.depth = ResourceLoadProfiler::records[entry.parent].depth + 1;
+    }
+    this->record = static_cast<std::ptrdiff_t>(ResourceLoadProfiler::records.size());
+    this->generation = ResourceLoadProfiler::generation;
+    ResourceLoadProfiler::records.push_back(entry);
+    ResourceLoadProfiler::loadStack.emplace_back(this->record, this->generation);
+}
+
+ResourceLoadProfiler::LoadScope::~LoadScope() {
+    ResourceLoadProfiler::loadStack.pop_back();
+    if (this->record < 0)
+        return;
+    const auto elapsed = millisecondsSince(this->begin, std::chrono::steady_clock::now());
+
+    std::scoped_lock lock{ResourceLoadProfiler::recordsMutex};
+    if (this->generation != ResourceLoadProfiler::generation)
+        return;
+    auto& entry = ResourceLoadProfiler::records[this->record];
+    entry.total = elapsed;
+    if (entry.parent >= 0) {
+        ResourceLoadProfiler::records[entry.parent].children += elapsed;
+    }
+}
+
+ResourceLoadProfiler::StageScope::StageScope(ResourceLoadStage stage_) : stage(stage_) {
+    std::scoped_lock lock{ResourceLoadProfiler::recordsMutex};
+    this->record = ResourceLoadProfiler::getCurrentRecord();
+    if (this->record < 0)
+        return;
+    this->generation = ResourceLoadProfiler::generation;
+    this->begin = std::chrono::steady_clock::now();
+}
+
+ResourceLoadProfiler::StageScope::~StageScope() {
+    if (this->record < 0)
+        return;
+    const auto elapsed = millisecondsSince(this->begin, std::chrono::steady_clock::now());
+
+    std::scoped_lock lock{ResourceLoadProfiler::recordsMutex};
+    if (this->generation != ResourceLoadProfiler::generation)
+        return;
+    auto& entry = ResourceLoadProfiler::records[this->record];
+    switch (this->stage) {
+        case ResourceLoadStage::READ:
+            entry.read += elapsed;
+            break;
+        case ResourceLoadStage::BACKEND:
+            entry.backend += elapsed;
+            break;
+    }
+}
+
+std::vector<ResourceLoadRecord> ResourceLoadProfiler::getRecords() {
+    std::scoped_lock lock{ResourceLoadProfiler::recordsMutex};
+    return ResourceLoadProfiler::records;
+}
+
+void ResourceLoadProfiler::clearRecords() {
+    std::scoped_lock lock{ResourceLoadProfiler::recordsMutex};
+    ResourceLoadProfiler::records.clear();
+    ResourceLoadProfiler::generation++;
+}
+
+std::string ResourceLoadProfiler::getReportJSON() {
+    const auto snapshot = ResourceLoadProfiler::getRecords();
+    auto loads = nlohmann::json::array();
+    for (const auto& entry : snapshot) {
+        loads.push_back({
+            {"identifier", entry.identifier.getString()},
+            {"parent", entry.parent},
+            {"depth", entry.depth},
+            {"start_ms", entry.start},
+            {"total_ms", entry.total},
+            {"self_ms", entry.self()},
+            {"read_ms", entry.read},
+            {"compile_ms", entry.compile()},
+            {"backend_ms", entry.backend},
+        });
+    }
+    return nlohmann::json{{"loads", loads}}.dump(4);
+}
+
+std::string ResourceLoadProfiler::getReportCSV() {
+    const auto snapshot = ResourceLoadProfiler::getRecords();
+    std::ostringstream csv;
+    csv << "index,identifier,parent,depth,start_ms,total_ms,self_ms,read_ms,compile_ms,backend_ms\n";
+    for (std::size_t i = 0; i < snapshot.size(); i++) {
+        const auto& entry = snapshot[i];
+        // Identifiers can't contain quotes, but they can contain commas
+        csv << i << ",\"" << entry.identifier.getString() << "\"," << entry.parent << ',' << entry.depth << ','
+            << entry.start << ',' << entry.total << ',' << entry.self() << ','
+            << entry.read << ',' << entry.compile() << ',' << entry.backend << '\n';
+    }
+    return csv.str();
+}
+
+bool ResourceLoadProfiler::writeReport(const std::string& path) {
+    std::ofstream file{path, std::ios::trunc};
+    if (!file) {
+        LOG_RESOURCE_PROFILER.error(TRF("error.resource_profiler.cannot_write_report", path));
+        return false;
+    }
+    if (path.ends_with(".csv")) {
+        file << ResourceLoadProfiler::getReportCSV();
+    } else {
+        file << ResourceLoadProfiler::getReportJSON();
+    }
+    return true;
+}
+
+std::ptrdiff_t ResourceLoadProfiler::getCurrentRecord() {
+    if (ResourceLoadProfiler::loadStack.empty())
+        return -1;
+    const auto [record, recordGeneration] = ResourceLoadProfiler::loadStack.back();
+    if (recordGeneration != ResourceLoadProfiler::generation)
+        return -1;
+    return record;
+}
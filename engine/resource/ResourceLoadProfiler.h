@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <utility/NoCopyOrMove.h>
+#include "ResourceId.h"
+
+namespace chira {
+
+enum class ResourceLoadStage {
+    /// Reading the resource from its provider
+    READ,
+    /// Creating the resource with the render backend (shader compilation, GPU uploads)
+    BACKEND,
+};
+
+/// Timings of a single load of a resource, in milliseconds.
+/// Times are exclusive: anything spent loading a nested resource is only counted in that resource's record.
+struct ResourceLoadRecord {
+    ResourceId identifier;
+    /// Index of the record of the resource that was loading when this one started, or -1
+    std::ptrdiff_t parent = -1;
+    std::size_t depth = 0;
+    /// When the load started, relative to the first recorded load
+    double start = 0.0;
+    double total = 0.0;
+    double read = 0.0;
+    double backend = 0.0;
+    /// Total time spent loading nested resources
+    double children = 0.0;
+
+    /// Everything that isn't reading, nested loads, or the backend (parsing, decoding, preprocessing...)
+    [[nodiscard]] double compile() const {
+        return this->total - this->read - this->backend - this->children;
+    }
+    [[nodiscard]] double self() const {
+        return this->total - this->children;
+    }
+};
+
+/// Records how long each resource takes to load, split by stage.
+/// Loads nest per thread, so a resource loaded while compiling another is attributed to it.
+class ResourceLoadProfiler {
+public:
+    /// Times the load of a resource. Records are only kept while res_profile_loads is enabled.
+    struct LoadScope : public NoCopyOrMove {
+        explicit LoadScope(const ResourceId& identifier);
+        ~LoadScope();
+    private:
+        std::ptrdiff_t record = -1;
+        std::size_t generation = 0;
+        std::chrono::steady_clock::time_point begin;
+    };
+
+    /// Times a stage of the innermost resource being loaded on this thread.
+    struct StageScope : public NoCopyOrMove {
+        explicit StageScope(ResourceLoadStage stage_);
+        ~StageScope();
+    private:
+        ResourceLoadStage stage;
+        std::ptrdiff_t record = -1;
+        std::size_t generation = 0;
+        std::chrono::steady_clock::time_point begin;
+    };
+
+    /// Returns a copy of every record, in the order the loads started.
+    [[nodiscard]] static std::vector<ResourceLoadRecord> getRecords();
+    static void clearRecords();
+
+    [[nodiscard]] static std::string getReportJSON();
+    [[nodiscard]] static std::string getReportCSV();
+    /// Writes a report, as CSV if the path ends with ".csv" and as JSON otherwise.
+    static bool writeReport(const std::string& path);
+
+private:
+    static inline std::mutex recordsMutex;
+    static inline std::vector<ResourceLoadRecord> records;
+    static inline std::chrono::steady_clock::time_point epoch;
+    /// Bumped when the records are cleared, so loads that were open at the time don't write into the new ones
+    static inline std::size_t generation = 0;
+    /// Records of the loads currently open on this thread (with their generation), innermost last
+    static inline thread_local std::vector<std::pair<std::ptrdiff_t, std::size_t>> loadStack;
+
+    /// Returns the record of the innermost load open on this thread, or -1 if there is none or it was cleared.
+    /// The records mutex must be locked.
+    [[nodiscard]] static std::ptrdiff_t getCurrentRecord();
+};
+
+} // namespace chira
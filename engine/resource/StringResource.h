@@ -8,9 +8,17 @@ class StringResource : public Resource {
 public:
     explicit StringResource(std::string identifier_) : Resource(std::move(identifier_)) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
+    [[nodiscard]] bool supportsAsyncCompile() const override {
+        return true;
+    }
+    [[nodiscard]] ResourceMemoryUsage getMemoryUsage() const override {
+        return {this->data.capacity(), 0};
+    }
     [[nodiscard]] const std::string& getString() const;
 protected:
     std::string data;
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(StringResource);
 };
 
 } // namespace chira
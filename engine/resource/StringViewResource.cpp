@@ -0,0 +1,28 @@
+#include "StringViewResource.h"
+
+#include <utility/String.h>
+
+using namespace chira;
+
+void StringViewResource::compile(const byte buffer_[], std::size_t bufferLength) {
+    this->compileFromBuffer(ResourceBuffer{std::vector<byte>{buffer_, buffer_ + bufferLength}});
+}
+
+void StringViewResource::compileFromBuffer(const ResourceBuffer& buffer_) {
+    // Don't count the null terminator
+    std::string_view text{reinterpret_cast<const char*>(buffer_.data()), buffer_.empty() ? 0 : buffer_.size() - 1};
+    if (text.find("\r\n") != std::string_view::npos) {
+        this->buffer = {};
+        this->normalized = text;
+        String::replace(this->normalized, "\r\n", "\n");
+        this->data = this->normalized;
+    } else {
+        this->buffer = buffer_.keep();
+        this->normalized.clear();
+        this->data = {reinterpret_cast<const char*>(this->buffer.data()), text.size()};
+    }
+}
+
+std::string_view StringViewResource::getString() const {
+    return this->data;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string_view>
+#include "Resource.h"
+
+namespace chira {
+
+/// Like StringResource, but views the provider's buffer (often a file mapping) instead of copying it.
+/// Text with Windows line endings still has to be copied to normalize them, as do loose files that can change on disk.
+class StringViewResource : public Resource {
+public:
+    explicit StringViewResource(std::string identifier_) : Resource(std::move(identifier_)) {}
+    void compile(const byte buffer[], std::size_t bufferLength) override;
+    void compileFromBuffer(const ResourceBuffer& buffer) override;
+    [[nodiscard]] bool supportsAsyncCompile() const override {
+        return true;
+    }
+    /// The view is null-terminated.
+    [[nodiscard]] std::string_view getString() const;
+protected:
+    ResourceBuffer buffer;
+    std::string normalized;
+    std::string_view data;
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(StringViewResource);
+};
+
+} // namespace chira
@@ -0,0 +1,200 @@
+#include "ArchiveResourceProvider.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <utility>
+#include <core/Logger.h>
+#include <i18n/TranslationManager.h>
+#include <utility/Compression.h>
+#include <utility/Hash.h>
+
+using namespace chira;
+
+CHIRA_CREATE_LOG(ARCHIVE);
+
+ArchiveResourceProvider::ArchiveResourceProvider(std::string path_, const std::string& name_)
+    : IResourceProvider(name_)
+    , path(std::move(path_)) {
+    FilesystemResourceProvider::nixifyPath(this->path);
+
+    std::error_code error;
+    const auto archiveSize = static_cast<std::size_t>(std::filesystem::file_size(this->path, error));
+    if (error || archiveSize < sizeof(ArchiveHeader)) {
+        LOG_ARCHIVE.error(TRF("error.archive.invalid_archive", this->path));
+        return;
+    }
+
+#ifndef CHIRA_PLATFORM_WINDOWS
+    // Archives are packed ahead of time and never rewritten while mounted, so entries can stay mapped
+    this->mapping = FilesystemResourceProvider::mapFile(this->path, archiveSize, false);
+#endif
+
+    // Only the header, table of contents, and names are copied out, the rest is read as needed
+    const auto readRange = [this](std::size_t offset, void* out, std::size_t size) {
+        if (!this->mapping.empty()) {
+            std::memcpy(out, this->mapping.data() + offset, size);
+            return true;
+        }
+        std::ifstream file{this->path, std::ios::binary};
+        file.seekg(static_cast<std::streamoff>(offset));
+        return static_cast<bool>(file.read(static_cast<char*>(out), static_cast<std::streamsize>(size)));
+    };
+
+    ArchiveHeader header;
+    const bool readHeader = readRange(0, &header, sizeof(ArchiveHeader));
+    const std::size_t tocSize = static_cast<std::size_t>(header.entryCount) * sizeof(ArchiveEntry);
+    if (!readHeader || std::memcmp(header.signature, ArchiveHeader{}.signature, sizeof(header.signature)) != 0 ||
+        header.version != ARCHIVE_VERSION ||
+        sizeof(ArchiveHeader) + tocSize > archiveSize ||
+        header.stringTableOffset > archiveSize || header.stringTableSize > archiveSize - header.stringTableOffset) {
+        LOG_ARCHIVE.error(TRF("error.archive.invalid_archive", this->path));
+        this->mapping = {};
+        return;
+    }
+
+    this->entries.resize(header.entryCount);
+    this->names.resize(static_cast<std::size_t>(header.stringTableSize));
+    if (!readRange(sizeof(ArchiveHeader), this->entries.data(), tocSize) ||
+        !readRange(static_cast<std::size_t>(header.stringTableOffset), this->names.data(), this->names.size())) {
+        LOG_ARCHIVE.error(TRF("error.archive.invalid_archive", this->path));
+        this->entries.clear();
+        this->names.clear();
+        this->mapping = {};
+        return;
+    }
+
+    // Drop anything pointing outside the archive now so reads don't have to check. Sizes are checked too,
+    // readResource() allocates whatever size a compressed entry claims
+    std::erase_if(this->entries, [archiveSize, this](const ArchiveEntry& entry) {
+        return entry.offset > archiveSize || entry.storedSize + 1 > archiveSize - entry.offset ||
+               static_cast<std::size_t>(entry.nameOffset) + entry.nameLength > this->names.size() ||
+               (!(entry.flags & ARCHIVE_ENTRY_COMPRESSED) && entry.size != entry.storedSize) ||
+               ((entry.flags & ARCHIVE_ENTRY_COMPRESSED) && entry.size > entry.storedSize * Compression::MAX_EXPANSION);
+    });
+    this->valid = true;
+}
+
+const ArchiveEntry* ArchiveResourceProvider::findEntry(std::string_view name) const {
+    const auto hash = Hash::xxh64(name);
+    auto entry = std::lower_bound(this->entries.begin(), this->entries.end(), hash, [](const ArchiveEntry& e, std::uint64_t h) {
+        return e.nameHash < h;
+    });
+    for (; entry != this->entries.end() && entry->nameHash == hash; entry++) {
+        if (this->getEntryName(*entry) == name)
+            return &*entry;
+    }
+    return nullptr;
+}
+
+std::string_view ArchiveResourceProvider::getEntryName(const ArchiveEntry& entry) const {
+    return std::string_view{this->names}.substr(entry.nameOffset, entry.nameLength);
+}
+
+bool ArchiveResourceProvider::hasResource(std::string_view name) const {
+    return this->findEntry(name) != nullptr;
+}
+
+bool ArchiveResourceProvider::listResources(const std::function<void(std::string_view)>& callback) const {
+    for (const auto& entry : this->entries) {
+        callback(this->getEntryName(entry));
+    }
+    return true;
+}
+
+ResourceBuffer ArchiveResourceProvider::readResource(std::string_view name) const {
+    const auto* entry = this->findEntry(name);
+    if (!entry)
+        return ResourceBuffer{std::vector<byte>{'\0'}};
+
+    // Uncompressed entries are already null terminated in the archive
+    if (!(entry->flags & ARCHIVE_ENTRY_COMPRESSED) && !this->mapping.empty())
+        return this->mapping.view(static_cast<std::size_t>(entry->offset), static_cast<std::size_t>(entry->size) + 1);
+
+    std::vector<byte> stored;
+    const byte* storedData;
+    if (!this->mapping.empty()) {
+        storedData = this->mapping.data() + entry->offset;
+    } else {
+        stored.resize(static_cast<std::size_t>(entry->storedSize) + 1);
+        std::ifstream file{this->path, std::ios::binary};
+        file.seekg(static_cast<std::streamoff>(entry->offset));
+        if (!file.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(entry->storedSize))) {
+            // The archive changed or shrank since it was opened, don't hand out a partly read buffer
+            throw std::filesystem::filesystem_error{"cannot read archive entry", this->path, std::make_error_code(std::errc::io_error)};
+        }
+        if (!(entry->flags & ARCHIVE_ENTRY_COMPRESSED)) {
+            stored.back() = '\0';
+            return ResourceBuffer{std::move(stored)};
+        }
+        storedData = stored.data();
+    }
+
+    std::vector<byte> bytes(static_cast<std::size_t>(entry->size) + 1);
+    if (!Compression::decompress(storedData, static_cast<std::size_t>(entry->storedSize), bytes.data(), static_cast<std::size_t>(entry->size))) {
+        LOG_ARCHIVE.error(TRF("error.archive.decompression_failed", name, this->path));
+        return ResourceBuffer{std::vector<byte>{'\0'}};
+    }
+    bytes.back() = '\0';
+    return ResourceBuffer{std::move(bytes)};
+}
+
+bool ArchiveResourceProvider::packFolder(const std::filesystem::path& folder, const std::filesystem::path& archivePath, bool compress) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& file : std::filesystem::recursive_directory_iterator{folder}) {
+        if (file.is_regular_file())
+            files.push_back(file.path());
+    }
+
+    ArchiveHeader header;
+    header.entryCount = static_cast<std::uint32_t>(files.size());
+    std::vector<ArchiveEntry> entries(files.size());
+    std::string names;
+    for (std::size_t i = 0; i < files.size(); i++) {
+        auto name = std::filesystem::relative(files[i], folder).string();
+        FilesystemResourceProvider::nixifyPath(name);
+        entries[i].nameHash = Hash::xxh64(name);
+        entries[i].nameOffset = static_cast<std::uint32_t>(names.size());
+        entries[i].nameLength = static_cast<std::uint32_t>(name.size());
+        names += name;
+    }
+
+    std::ofstream archive{archivePath, std::ios::binary | std::ios::trunc};
+    if (!archive)
+        return false;
+    // Data goes right after the table of contents, names go at the very end
+    std::uint64_t offset = sizeof(ArchiveHeader) + files.size() * sizeof(ArchiveEntry);
+    archive.seekp(static_cast<std::streamoff>(offset));
+
+    for (std::size_t i = 0; i < files.size(); i++) {
+        std::ifstream input{files[i], std::ios::binary};
+        std::vector<byte> contents{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+        entries[i].offset = offset;
+        entries[i].size = contents.size();
+
+        // Small savings aren't worth the decompression and the lost zero-copy read
+        if (compress && !contents.empty()) {
+            if (auto compressed = Compression::compress(contents.data(), contents.size()); compressed.size() < contents.size() - contents.size() / 8) {
+                contents = std::move(compressed);
+                entries[i].flags |= ARCHIVE_ENTRY_COMPRESSED;
+            }
+        }
+        entries[i].storedSize = contents.size();
+        contents.push_back('\0');
+        archive.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+        offset += contents.size();
+    }
+
+    header.stringTableOffset = offset;
+    header.stringTableSize = names.size();
+    archive.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    std::sort(entries.begin(), entries.end(), [](const ArchiveEntry& lhs, const ArchiveEntry& rhs) {
+        return lhs.nameHash < rhs.nameHash;
+    });
+    archive.seekp(0);
+    archive.write(reinterpret_cast<const char*>(&header), sizeof(ArchiveHeader));
+    archive.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ArchiveEntry)));
+    return static_cast<bool>(archive);
+}
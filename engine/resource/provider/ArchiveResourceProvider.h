@@ -0,0 +1,84 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "FilesystemResourceProvider.h"
+#include "IResourceProvider.h"
+
+namespace chira {
+
+constexpr std::uint32_t ARCHIVE_VERSION = 1;
+
+// The header and table of contents are copied in and out as is, byte swapping isn't worth it for hosts nobody ships on
+static_assert(std::endian::native == std::endian::little, "Archives are little endian, and are read and written in host byte order!");
+
+/// All fields are little-endian. The table of contents follows the header directly.
+struct ArchiveHeader {
+    char signature[4] {'C', 'P', 'A', 'K'};
+    std::uint32_t version = ARCHIVE_VERSION;
+    std::uint32_t entryCount = 0;
+    std::uint32_t reserved = 0;
+    std::uint64_t stringTableOffset = 0;
+    std::uint64_t stringTableSize = 0;
+};
+static_assert(sizeof(ArchiveHeader) == 32);
+
+enum ArchiveEntryFlags : std::uint32_t {
+    ARCHIVE_ENTRY_COMPRESSED = 1 << 0,
+};
+
+/// Entries are sorted by name hash. Uncompressed data is followed by a null byte in the
+/// archive, so it can be handed to compile() straight out of the mapping.
+struct ArchiveEntry {
+    std::uint64_t nameHash = 0;
+    std::uint64_t offset = 0;
+    std::uint64_t storedSize = 0;
+    std::uint64_t size = 0;
+    std::uint32_t nameOffset = 0;
+    std::uint32_t nameLength = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t reserved = 0;
+};
+static_assert(sizeof(ArchiveEntry) == 48);
+
+/// Serves resources out of a single archive file built by packtool.
+/// It uses the file provider name by default, so adding one after a FilesystemResourceProvider
+/// lets the archive override loose files, and vice versa.
+class ArchiveResourceProvider : public IResourceProvider {
+public:
+    /// Relative paths are relative to the working directory.
+    explicit ArchiveResourceProvider(std::string path_, const std::string& name_ = FILESYSTEM_PROVIDER_NAME);
+    [[nodiscard]] bool hasResource(std::string_view name) const override;
+    [[nodiscard]] ResourceBuffer readResource(std::string_view name) const override;
+    bool listResources(const std::function<void(std::string_view)>& callback) const override;
+    [[nodiscard]] std::string_view getPath() const {
+        return this->path;
+    }
+    /// False if the archive was missing or malformed, in which case it has no resources.
+    [[nodiscard]] bool isValid() const {
+        return this->valid;
+    }
+    [[nodiscard]] std::size_t getEntryCount() const {
+        return this->entries.size();
+    }
+
+    /// Packs every file under the given folder into an archive. Entries are named by their path
+    /// relative to the folder, and are compressed if that makes them meaningfully smaller.
+    /// Returns false if the archive could not be written.
+    static bool packFolder(const std::filesystem::path& folder, const std::filesystem::path& archivePath, bool compress = true);
+private:
+    std::string path;
+    bool valid = false;
+    std::vector<ArchiveEntry> entries;
+    std::string names;
+    /// The whole archive if it could be mapped, otherwise entries are read on demand.
+    ResourceBuffer mapping;
+
+    [[nodiscard]] const ArchiveEntry* findEntry(std::string_view name) const;
+    [[nodiscard]] std::string_view getEntryName(const ArchiveEntry& entry) const;
+};
+
+} // namespace chira
@@ -3,17 +3,27 @@
 #include <fstream>
 #include <filesystem>
 #include <utility>
+#include <config/ConEntry.h>
 #include <core/Platform.h>
 #include <resource/Resource.h>
+#include <utility/BatchFileReader.h>
 
 #ifdef CHIRA_PLATFORM_APPLE
     #include "CoreFoundation/CoreFoundation.h"
 #endif
 
+#ifndef CHIRA_PLATFORM_WINDOWS
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
 using namespace chira;
 
 CHIRA_CREATE_LOG(FILESYSTEM);
 
+ConVar res_read_queue_depth{"res_read_queue_depth", 64, "The number of file reads kept in flight at once when resources are read in bulk, like when precaching a manifest.", CON_FLAG_CACHE};
+
 FilesystemResourceProvider::FilesystemResourceProvider(std::string path_, bool isPathAbsolute, const std::string& name_)
     : IResourceProvider(name_)
     , path(std::move(path_))
@@ -67,31 +77,163 @@ FilesystemResourceProvider::FilesystemResourceProvider(std::string path_, bool i
     this->path = FILESYSTEM_ROOT_FOLDER + '/' + this->path;
 #endif
     }
+
+    this->indexFolder("");
+    this->watcher = std::make_unique<FilesystemWatcher>(this->getRoot());
+}
+
+std::filesystem::path FilesystemResourceProvider::getRoot() const {
+    return this->absolute ? std::filesystem::path{this->path} : std::filesystem::current_path().append(this->path);
+}
+
+void FilesystemResourceProvider::indexFolder(const std::string& folder, const std::function<void(std::string_view)>& callback) {
+    const auto root = this->getRoot();
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator i{folder.empty() ? root : root / folder, error}, end; !error && i != end; i.increment(error)) {
+        if (!i->is_regular_file())
+            continue;
+        // Index it first, the callback might look it up
+        const auto& name = *this->index.insert(std::filesystem::relative(i->path(), root).generic_string()).first;
+        if (callback)
+            callback(name);
+    }
 }
 
 bool FilesystemResourceProvider::hasResource(std::string_view name) const {
-    if (this->absolute)
-        return std::filesystem::exists(std::filesystem::path{this->path}.append(name));
-    else
-        return std::filesystem::exists(std::filesystem::current_path().append(this->path).append(name));
+    if (this->index.contains(name))
+        return true;
+    if (this->watcher->isWatching())
+        return false;
+    // Without a watcher, files added after the index was built are only on the disk
+    return std::filesystem::exists(this->getRoot().append(name));
+}
+
+bool FilesystemResourceProvider::listResources(const std::function<void(std::string_view)>& callback) const {
+    for (const auto& name : this->index) {
+        callback(name);
+    }
+    return true;
+}
+
+void FilesystemResourceProvider::pollChanges(const std::function<void(std::string_view, ResourceChange)>& callback) {
+    for (const auto& event : this->watcher->poll()) {
+        switch (event.change) {
+            case FilesystemChange::ADDED:
+                if (event.isDirectory) {
+                    this->indexFolder(event.path, [&callback](std::string_view name) {
+                        callback(name, ResourceChange::ADDED);
+                    });
+                } else if (this->index.insert(event.path).second) {
+                    callback(event.path, ResourceChange::ADDED);
+                } else {
+                    // Editors that save by renaming a temporary file over the original only move the new one in
+                    callback(event.path, ResourceChange::MODIFIED);
+                }
+                break;
+            case FilesystemChange::REMOVED:
+                if (event.isDirectory) {
+                    const auto prefix = event.path + '/';
+                    for (auto name = this->index.begin(); name != this->index.end();) {
+                        if (name->starts_with(prefix)) {
+                            callback(*name, ResourceChange::REMOVED);
+                            name = this->index.erase(name);
+                        } else {
+                            name++;
+                        }
+                    }
+                } else if (this->index.erase(event.path)) {
+                    callback(event.path, ResourceChange::REMOVED);
+                }
+                break;
+            case FilesystemChange::MODIFIED:
+                if (this->index.insert(event.path).second)
+                    callback(event.path, ResourceChange::ADDED);
+                else
+                    callback(event.path, ResourceChange::MODIFIED);
+                break;
+            case FilesystemChange::RESCAN:
+                this->index.clear();
+                this->indexFolder("");
+                callback("", ResourceChange::RESCAN);
+                break;
+        }
+    }
 }
 
-void FilesystemResourceProvider::compileResource(std::string_view name, Resource* resource) const {
-    std::filesystem::path resourcePath;
-    if (this->absolute)
-        resourcePath = std::filesystem::path{this->path}.append(name);
-    else
-        resourcePath = std::filesystem::current_path().append(this->path).append(name);
+ResourceBuffer FilesystemResourceProvider::readResource(std::string_view name) const {
+    const auto resourcePath = this->getRoot().append(name);
     std::uintmax_t fileSize = std::filesystem::file_size(resourcePath);
+
+#ifndef CHIRA_PLATFORM_WINDOWS
+    if (fileSize >= FILESYSTEM_MAP_THRESHOLD) {
+        if (auto mapped = FilesystemResourceProvider::mapFile(resourcePath, static_cast<std::size_t>(fileSize), true); !mapped.empty())
+            return mapped;
+    }
+#endif
+
     std::ifstream ifs(resourcePath.string().c_str(), std::ios::in | std::ios::binary);
     ifs.seekg(0, std::ios::beg);
-    auto* bytes = new byte[(std::size_t) fileSize + 1];
-    ifs.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(fileSize));
+    std::vector<byte> bytes((std::size_t) fileSize + 1);
+    ifs.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(fileSize));
     bytes[fileSize] = '\0';
-    resource->compile(bytes, (std::size_t) fileSize + 1);
-    delete[] bytes;
+    return ResourceBuffer{std::move(bytes)};
+}
+
+void FilesystemResourceProvider::readResources(std::vector<std::string> names, ResourceReadCallback callback) const {
+    auto reader = std::make_shared<BatchFileReader>(static_cast<unsigned int>(std::max(res_read_queue_depth.getValue<int>(), 1)));
+    if (!reader->isAsync()) {
+        IResourceProvider::readResources(std::move(names), std::move(callback));
+        return;
+    }
+    Resource::getLoaderThreads().submit([this, reader, names = std::move(names), callback = std::move(callback)] {
+        const auto root = this->getRoot();
+        std::vector<std::filesystem::path> paths;
+        paths.reserve(names.size());
+        for (const auto& name : names) {
+            paths.push_back(root / name);
+        }
+        reader->read(paths, [&callback, &paths](std::size_t index, std::vector<byte> contents, std::error_code error) {
+            if (error)
+                callback(index, {}, std::make_exception_ptr(std::filesystem::filesystem_error{"cannot read resource", paths[index], error}));
+            else
+                callback(index, ResourceBuffer{std::move(contents)}, nullptr);
+        });
+    });
 }
 
+#ifndef CHIRA_PLATFORM_WINDOWS
+ResourceBuffer FilesystemResourceProvider::mapFile(const std::filesystem::path& filePath, std::size_t fileSize, bool canChange) {
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return {};
+
+    // Reserve room for the file plus at least one zeroed byte, then map the file over the start of it.
+    // The bytes past the end of the file are zero whether they land in the file's last page or in the
+    // anonymous page after it, so we get the null terminator compile() expects without copying anything.
+    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t mappingSize = (fileSize + 1 + pageSize - 1) / pageSize * pageSize;
+    void* reserved = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        close(fd);
+        return {};
+    }
+    void* mapped = mmap(reserved, fileSize, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        munmap(reserved, mappingSize);
+        return {};
+    }
+    // Resources are almost always consumed front to back, right after being read
+    madvise(mapped, fileSize, MADV_SEQUENTIAL);
+    madvise(mapped, fileSize, MADV_WILLNEED);
+
+    std::shared_ptr<const void> owner{mapped, [mappingSize](const void* address) {
+        munmap(const_cast<void*>(address), mappingSize);
+    }};
+    return ResourceBuffer{std::move(owner), static_cast<const byte*>(mapped), fileSize + 1, canChange};
+}
+#endif
+
 std::string FilesystemResourceProvider::getFolder() const {
     return String::stripLeft(std::string{this->getPath().data()}, FILESYSTEM_ROOT_FOLDER + '/');
 }
@@ -101,7 +243,7 @@ std::string FilesystemResourceProvider::getLocalResourceAbsolutePath(const std::
     auto name = Resource::splitResourceIdentifier(identifier).second;
     if (!this->hasResource(name))
         return "";
-    auto absPath = (this->absolute ? std::filesystem::path{this->path} : std::filesystem::current_path().append(this->path)).append(name).string();
+    auto absPath = this->getRoot().append(name).string();
     // Replace cringe Windows-style backslashes
     FilesystemResourceProvider::nixifyPath(absPath);
     return absPath;
@@ -141,7 +283,8 @@ std::string FilesystemResourceProvider::getResourceFolderPath(std::string_view a
 }
 
 std::string FilesystemResourceProvider::getResourceAbsolutePath(const std::string& identifier) {
-    if (auto provider = Resource::getResourceProviderWithResource(identifier))
-        return assert_cast<FilesystemResourceProvider*>(provider)->getLocalResourceAbsolutePath(identifier);
+    // The resource might live in an archive, which has no path for it
+    if (auto provider = dynamic_cast<FilesystemResourceProvider*>(Resource::getResourceProviderWithResource(identifier)))
+        return provider->getLocalResourceAbsolutePath(identifier);
     return "";
 }
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <filesystem>
+#include <memory>
+#include <unordered_set>
+#include <core/Platform.h>
+#include <math/Types.h>
+#include <utility/FilesystemWatcher.h>
 #include <utility/String.h>
 #include "IResourceProvider.h"
 
@@ -7,12 +13,26 @@ namespace chira {
 
 const std::string FILESYSTEM_ROOT_FOLDER = "resources";
 const std::string FILESYSTEM_PROVIDER_NAME = "file";
+/// Below this size, a plain read is cheaper than setting up a mapping.
+/// Loose files can be rewritten or truncated while mapped (hot reload does exactly that), which shows
+/// the new contents through the mapping or raises SIGBUS on pages past the new end. These mappings are
+/// marked volatile, so resources copy them with ResourceBuffer::keep() instead of holding onto them.
+constexpr std::size_t FILESYSTEM_MAP_THRESHOLD = 64 * 1024;
 
 class FilesystemResourceProvider : public IResourceProvider {
 public:
     explicit FilesystemResourceProvider(std::string path_, bool isPathAbsolute = false, const std::string& name_ = FILESYSTEM_PROVIDER_NAME);
+    /// Answered from an index of the folder built when the provider is created. The index is kept up
+    /// to date by pollChanges() where a filesystem watcher is available, elsewhere a miss falls back to the disk.
     [[nodiscard]] bool hasResource(std::string_view name) const override;
-    void compileResource(std::string_view name, Resource* resource) const override;
+    /// Files at least FILESYSTEM_MAP_THRESHOLD bytes large are memory mapped instead of read.
+    /// The mapping is volatile, so it should only be read during compile().
+    [[nodiscard]] ResourceBuffer readResource(std::string_view name) const override;
+    /// Reads the whole batch on one loader thread through a BatchFileReader, with res_read_queue_depth reads in flight.
+    /// Nothing is memory mapped. Falls back to one loader thread task per file where the reader can't read asynchronously.
+    void readResources(std::vector<std::string> names, ResourceReadCallback callback) const override;
+    bool listResources(const std::function<void(std::string_view)>& callback) const override;
+    void pollChanges(const std::function<void(std::string_view, ResourceChange)>& callback) override;
     [[nodiscard]] std::string_view getPath() const {
         return this->path;
     }
@@ -34,10 +54,30 @@ public:
     /// Takes a resource identifier and returns the full absolute path, if it exists.
     static std::string getResourceAbsolutePath(const std::string& identifier);
 
+#ifndef CHIRA_PLATFORM_WINDOWS
+    /// Maps the file read-only, followed by a null terminator. Returns an empty buffer if the file could not be mapped.
+    /// Pass canChange for files that may be rewritten while mapped, the buffer is then marked volatile.
+    static ResourceBuffer mapFile(const std::filesystem::path& filePath, std::size_t fileSize, bool canChange);
+#endif
+
     static constexpr inline short FILEPATH_MAX_LENGTH = 1024;
 private:
     std::string path;
     bool absolute;
+
+    struct IndexHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view name) const {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+    /// Paths of every file under the folder, relative to it.
+    std::unordered_set<std::string, IndexHash, std::equal_to<>> index;
+    std::unique_ptr<FilesystemWatcher> watcher;
+
+    [[nodiscard]] std::filesystem::path getRoot() const;
+    /// Adds every file under the given subfolder to the index, and calls the callback with each one.
+    void indexFolder(const std::string& folder, const std::function<void(std::string_view)>& callback = {});
 };
 
 } // namespace chira
@@ -0,0 +1,37 @@
+#include "IResourceProvider.h"
+
+#include <memory>
+#include <resource/Resource.h>
+#include <resource/ResourceLoadProfiler.h>
+
+using namespace chira;
+
+void IResourceProvider::readResources(std::vector<std::string> names, ResourceReadCallback callback) const {
+    auto sharedCallback = std::make_shared<ResourceReadCallback>(std::move(callback));
+    for (std::size_t i = 0; i < names.size(); i++) {
+        Resource::getLoaderThreads().submit([this, i, name = std::move(names[i]), sharedCallback] {
+            try {
+                (*sharedCallback)(i, this->readResource(name), nullptr);
+            } catch (...) {
+                (*sharedCallback)(i, {}, std::current_exception());
+            }
+        });
+    }
+}
+
+void IResourceProvider::compileResource(std::string_view name, Resource* resource) const {
+    Resource::CompileScope scope{resource->getResourceId()};
+    ResourceLoadProfiler::LoadScope load{resource->getResourceId()};
+    ResourceBuffer buffer;
+    {
+        ResourceLoadProfiler::StageScope read{ResourceLoadStage::READ};
+        if (auto prefetched = Resource::takePrefetchedBuffer(resource->getResourceId())) {
+            buffer = std::move(*prefetched);
+        } else {
+            buffer = this->readResource(name);
+        }
+    }
+    if (Resource::deduplicate(resource, buffer))
+        return;
+    resource->compileFromBuffer(buffer);
+}
@@ -1,12 +1,28 @@
 #pragma once
 
+#include <cstddef>
+#include <exception>
+#include <functional>
 #include <string>
 #include <string_view>
+#include <vector>
+#include <resource/ResourceBuffer.h>
 
 namespace chira {
 
 class Resource;
 
+enum class ResourceChange {
+    ADDED,
+    REMOVED,
+    MODIFIED,
+    /// Changes were lost, so the provider's whole listing has to be read again. Reported with an empty name.
+    RESCAN,
+};
+
+/// Called with the index of a resource in the batch, and its contents or the exception reading it threw.
+using ResourceReadCallback = std::function<void(std::size_t, ResourceBuffer, std::exception_ptr)>;
+
 class IResourceProvider {
 public:
     explicit IResourceProvider(std::string name) : providerName(std::move(name)) {}
@@ -15,7 +31,21 @@ public:
         return this->providerName;
     }
     [[nodiscard]] virtual bool hasResource(std::string_view name) const = 0;
-    virtual void compileResource(std::string_view name, Resource* resource) const = 0;
+    /// Returns the contents of the resource with a null terminator appended.
+    /// Must be safe to call from resource loader threads.
+    [[nodiscard]] virtual ResourceBuffer readResource(std::string_view name) const = 0;
+    /// Starts reading all the resources in the background and returns immediately. The callback is called on
+    /// resource loader threads as each read finishes, in any order. By default every read is its own loader thread task.
+    virtual void readResources(std::vector<std::string> names, ResourceReadCallback callback) const;
+    virtual void compileResource(std::string_view name, Resource* resource) const;
+    /// Calls the callback with the name of every resource this provider has, and returns true.
+    /// Providers that can list their resources are indexed when they are added, so looking up a
+    /// resource doesn't have to ask every provider. Returns false if the provider can't do this.
+    virtual bool listResources(const std::function<void(std::string_view)>& /*callback*/) const {
+        return false;
+    }
+    /// Called once a frame on the main thread. Reports resources that changed since the last call.
+    virtual void pollChanges(const std::function<void(std::string_view, ResourceChange)>& /*callback*/) {}
 protected:
     std::string providerName;
 };
@@ -12,6 +12,10 @@ class Font : public Resource {
 public:
     explicit Font(const std::string& identifier_) : Resource(identifier_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
+    /// The font atlas is baked when the window is created.
+    [[nodiscard]] bool supportsReload() const override {
+        return false;
+    }
     [[nodiscard]] ImFont* getFont() const;
     [[nodiscard]] const std::string& getName() const;
     [[nodiscard]] float getSize() const;
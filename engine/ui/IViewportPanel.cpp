@@ -1,9 +1,13 @@
 #include "IViewportPanel.h"
 
+#include <config/ConEntry.h>
 #include <entity/Viewport.h>
+#include <i18n/TranslationManager.h>
 
 using namespace chira;
 
+ConVar r_show_render_stats{"r_show_render_stats", false, "Show the draw calls and state changes of each viewport over it.", CON_FLAG_CACHE};
+
 IViewportPanel::IViewportPanel(const std::string& title_, Viewport* viewport_, bool resizeLayer_, bool startVisible, ImVec2 windowSize, bool enforceSize)
     : IPanel(title_, startVisible, windowSize, enforceSize)
     , viewport(viewport_)
@@ -21,6 +25,11 @@ void IViewportPanel::renderContents() {
             this->currentSize = size;
         }
         ImGui::Image(Renderer::getImGuiFrameBufferHandle(*this->viewport->getRawHandle()), guiSize, ImVec2(0, 1), ImVec2(1, 0));
+        if (r_show_render_stats.getValue<bool>()) {
+            const auto& statistics = this->viewport->getRenderStatistics();
+            ImGui::SetCursorPos({ImGui::GetStyle().WindowPadding.x, ImGui::GetStyle().WindowPadding.y});
+            ImGui::TextUnformatted(TRF("ui.viewport.render_stats", statistics.drawCalls, statistics.viewChanges, statistics.shaderChanges, statistics.materialChanges).c_str());
+        }
         this->renderViewportContents();
     }
     ImGui::EndChild();
@@ -1,9 +1,48 @@
 #include "ResourceUsageTrackerPanel.h"
 
+#include <string>
+#include <vector>
 #include <i18n/TranslationManager.h>
+#include <resource/ResourceLoadProfiler.h>
 
 using namespace chira;
 
+namespace {
+
+std::string formatBytes(std::size_t bytes) {
+    if (bytes >= 1024 * 1024)
+        return std::to_string(bytes / (1024 * 1024)) + " MB";
+    if (bytes >= 1024)
+        return std::to_string(bytes / 1024) + " KB";
+    return std::to_string(bytes) + " B";
+}
+
+void renderLoadRecord(const std::vector<ResourceLoadRecord>& records, const std::vector<std::vector<std::size_t>>& children, std::size_t index) {
+    const auto& entry = records[index];
+    ImGui::TableNextRow();
+    ImGui::TableSetColumnIndex(0);
+    ImGui::PushID(static_cast<int>(index));
+    const bool leaf = children[index].empty();
+    const bool open = ImGui::TreeNodeEx(entry.identifier.getString().data(), leaf ? ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen : ImGuiTreeNodeFlags_None);
+    ImGui::PopID();
+    ImGui::TableSetColumnIndex(1);
+    ImGui::Text("%.2f", entry.total);
+    ImGui::TableSetColumnIndex(2);
+    ImGui::Text("%.2f", entry.read);
+    ImGui::TableSetColumnIndex(3);
+    ImGui::Text("%.2f", entry.compile());
+    ImGui::TableSetColumnIndex(4);
+    ImGui::Text("%.2f", entry.backend);
+    if (open && !leaf) {
+        for (const auto child : children[index]) {
+            renderLoadRecord(records, children, child);
+        }
+        ImGui::TreePop();
+    }
+}
+
+} // namespace
+
 ResourceUsageTrackerPanel::ResourceUsageTrackerPanel(ImVec2 windowSize) : IPanel(TR("ui.resource_usage_tracker.title"), false, windowSize) {}
 
 void ResourceUsageTrackerPanel::renderContents() {
@@ -18,18 +57,58 @@ void ResourceUsageTrackerPanel::renderContents() {
         ImGui::EndTable();
     }
     ImGui::Separator();
-    if (ImGui::BeginTable("Resources", 3)) {
-        for (const auto& [providerName, resourceMap] : Resource::resources) {
-            for (const auto& [resourceName, resource] : resourceMap) {
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0);
-                ImGui::Text("%s", providerName.c_str());
-                ImGui::TableSetColumnIndex(1);
-                ImGui::Text("%s", resourceName.c_str());
-                ImGui::TableSetColumnIndex(2);
-                ImGui::Text("%d", resource.useCount());
-            }
+    const auto total = Resource::getCachedMemoryUsage();
+    ImGui::TextUnformatted(TRF("ui.resource_usage_tracker.cache_total", Resource::resources.size(), formatBytes(total.cpu), formatBytes(total.gpu)).c_str());
+    if (const auto deduplicated = Resource::getDeduplicatedCount()) {
+        const auto saved = Resource::getDeduplicatedMemoryUsage();
+        ImGui::TextUnformatted(TRF("ui.resource_usage_tracker.deduplicated", deduplicated, formatBytes(saved.cpu), formatBytes(saved.gpu)).c_str());
+    }
+    if (ImGui::BeginTable("Resources", 5)) {
+        for (const auto& [identifier, resource] : Resource::resources) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            // Not null-terminated, it's a view into the full identifier
+            const auto providerName = identifier.getProvider();
+            ImGui::TextUnformatted(providerName.data(), providerName.data() + providerName.size());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%s", identifier.getName().data());
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%d", resource.useCount());
+            const auto usage = resource->getMemoryUsage();
+            ImGui::TableSetColumnIndex(3);
+            ImGui::TextUnformatted(formatBytes(usage.cpu).c_str());
+            ImGui::TableSetColumnIndex(4);
+            ImGui::TextUnformatted(formatBytes(usage.gpu).c_str());
         }
         ImGui::EndTable();
     }
+
+    ImGui::Separator();
+    if (ImGui::CollapsingHeader(TRC("ui.resource_usage_tracker.load_times"))) {
+        const auto records = ResourceLoadProfiler::getRecords();
+        std::vector<std::vector<std::size_t>> children(records.size());
+        std::vector<std::size_t> roots;
+        double rootTotal = 0.0;
+        for (std::size_t i = 0; i < records.size(); i++) {
+            if (records[i].parent >= 0) {
+                children[records[i].parent].push_back(i);
+            } else {
+                roots.push_back(i);
+                rootTotal += records[i].total;
+            }
+        }
+        ImGui::TextUnformatted(TRF("ui.resource_usage_tracker.load_total", records.size(), rootTotal).c_str());
+        if (ImGui::BeginTable("Load Times", 5, ImGuiTableFlags_Resizable)) {
+            ImGui::TableSetupColumn("Resource");
+            ImGui::TableSetupColumn("Total (ms)");
+            ImGui::TableSetupColumn("Read (ms)");
+            ImGui::TableSetupColumn("Compile (ms)");
+            ImGui::TableSetupColumn("Backend (ms)");
+            ImGui::TableHeadersRow();
+            for (const auto root : roots) {
+                renderLoadRecord(records, children, root);
+            }
+            ImGui::EndTable();
+        }
+    }
 }
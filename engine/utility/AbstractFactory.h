@@ -19,6 +19,9 @@ public:
         AbstractFactory::getFactoryMethods()[name] = createFunc;
         return true;
     }
+    static bool hasTypeFactory(const std::string& name) {
+        return AbstractFactory::getFactoryMethods().contains(name);
+    }
     static const factoryFunction& getTypeFactory(const std::string& name) {
         return AbstractFactory::getFactoryMethods().at(name);
     }
@@ -0,0 +1,247 @@
+#include "BatchFileReader.h"
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef CHIRA_PLATFORM_LINUX
+    #include <atomic>
+    #include <cerrno>
+    #include <cstdint>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+using namespace chira;
+
+namespace {
+
+void readWholeFile(const std::filesystem::path& path, std::vector<byte>& contents, std::error_code& error) {
+    const auto size = std::filesystem::file_size(path, error);
+    if (error)
+        return;
+    std::ifstream file{path, std::ios::in | std::ios::binary};
+    if (!file) {
+        error = std::make_error_code(std::errc::io_error);
+        return;
+    }
+    contents.resize(static_cast<std::size_t>(size) + 1);
+    file.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(size));
+    contents.resize(static_cast<std::size_t>(file.gcount()) + 1);
+    contents.back() = '\0';
+}
+
+} // namespace
+
+void BatchFileReader::read(std::span<const std::filesystem::path> paths, const Callback& callback) {
+#ifdef CHIRA_PLATFORM_LINUX
+    if (this->isAsync()) {
+        this->readAsync(paths, callback);
+        return;
+    }
+#endif
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        std::vector<byte> contents;
+        std::error_code error;
+        readWholeFile(paths[i], contents, error);
+        callback(i, std::move(contents), error);
+    }
+}
+
+#ifdef CHIRA_PLATFORM_LINUX
+
+namespace {
+
+template<typename T>
+T* ringField(void* ring, std::uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+/// The most one read asks for, a single read can't transfer more than this anyway
+constexpr std::size_t MAX_READ_LENGTH = 1 << 30;
+
+} // namespace
+
+BatchFileReader::BatchFileReader(unsigned int queueDepth_) : queueDepth(std::max(queueDepth_, 1u)) {
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CLAMP;
+    this->ringFd = static_cast<int>(syscall(__NR_io_uring_setup, this->queueDepth, &params));
+    if (this->ringFd < 0)
+        return;
+    this->queueDepth = std::min(this->queueDepth, params.sq_entries);
+
+    this->submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    this->submissionRing = mmap(nullptr, this->submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_SQ_RING);
+    this->completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    this->completionRing = mmap(nullptr, this->completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_CQ_RING);
+    this->submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+    this->submissionEntries = mmap(nullptr, this->submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_SQES);
+    if (this->submissionRing == MAP_FAILED || this->completionRing == MAP_FAILED || this->submissionEntries == MAP_FAILED) {
+        // Fall back to reading files one at a time
+        for (auto [mapping, size] : {std::pair{&this->submissionRing, this->submissionRingSize},
+                                     std::pair{&this->completionRing, this->completionRingSize},
+                                     std::pair{&this->submissionEntries, this->submissionEntriesSize}}) {
+            if (*mapping != MAP_FAILED)
+                munmap(*mapping, size);
+            *mapping = nullptr;
+        }
+        close(this->ringFd);
+        this->ringFd = -1;
+        return;
+    }
+
+    this->submissionTail = ringField<unsigned int>(this->submissionRing, params.sq_off.tail);
+    this->submissionMask = *ringField<unsigned int>(this->submissionRing, params.sq_off.ring_mask);
+    this->submissionArray = ringField<unsigned int>(this->submissionRing, params.sq_off.array);
+    this->completionHead = ringField<unsigned int>(this->completionRing, params.cq_off.head);
+    this->completionTail = ringField<unsigned int>(this->completionRing, params.cq_off.tail);
+    this->completionMask = *ringField<unsigned int>(this->completionRing, params.cq_off.ring_mask);
+    this->completionEntries = ringField<void>(this->completionRing, params.cq_off.cqes);
+}
+
+BatchFileReader::~BatchFileReader() {
+    this->closeRing();
+}
+
+void BatchFileReader::closeRing() {
+    if (this->ringFd < 0)
+        return;
+    munmap(this->submissionEntries, this->submissionEntriesSize);
+    munmap(this->completionRing, this->completionRingSize);
+    munmap(this->submissionRing, this->submissionRingSize);
+    close(this->ringFd);
+    this->ringFd = -1;
+}
+
+bool BatchFileReader::isAsync() const {
+    return this->ringFd >= 0;
+}
+
+void BatchFileReader::readAsync(std::span<const std::filesystem::path> paths, const Callback& callback) {
+    struct PendingRead {
+        std::size_t index = 0;
+        int fd = -1;
+        std::vector<byte> contents;
+        std::size_t size = 0;
+        std::size_t done = 0;
+    };
+    std::vector<PendingRead> slots(this->queueDepth);
+    std::vector<unsigned int> freeSlots;
+    for (unsigned int slot = this->queueDepth; slot > 0; slot--) {
+        freeSlots.push_back(slot - 1);
+    }
+    unsigned int unsubmitted = 0;
+
+    // Asks for the rest of the file, short reads just queue another one
+    const auto queueRead = [this, &slots, &unsubmitted](unsigned int slot) {
+        auto& read = slots[slot];
+        const auto tail = std::atomic_ref{*this->submissionTail}.load(std::memory_order_relaxed);
+        const auto entry = tail & this->submissionMask;
+        auto* sqe = static_cast<io_uring_sqe*>(this->submissionEntries) + entry;
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = read.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(read.contents.data() + read.done);
+        sqe->len = static_cast<std::uint32_t>(std::min(read.size - read.done, MAX_READ_LENGTH));
+        sqe->off = read.done;
+        sqe->user_data = slot;
+        this->submissionArray[entry] = entry;
+        std::atomic_ref{*this->submissionTail}.store(tail + 1, std::memory_order_release);
+        unsubmitted++;
+    };
+    const auto finishRead = [&slots, &freeSlots, &callback](unsigned int slot, std::error_code error) {
+        auto& read = slots[slot];
+        close(read.fd);
+        if (error) {
+            read.contents.clear();
+        } else {
+            // The file might have gotten shorter since it was opened
+            read.contents.resize(read.done + 1);
+            read.contents.back() = '\0';
+        }
+        freeSlots.push_back(slot);
+        callback(read.index, std::move(read.contents), error);
+    };
+
+    std::size_t next = 0;
+    while (true) {
+        while (next < paths.size() && !freeSlots.empty()) {
+            const auto index = next++;
+            const int fd = open(paths[index].c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                callback(index, {}, std::error_code{errno, std::generic_category()});
+                continue;
+            }
+            struct stat info{};
+            if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+                close(fd);
+                callback(index, {}, std::make_error_code(std::errc::invalid_argument));
+                continue;
+            }
+            if (info.st_size == 0) {
+                close(fd);
+                callback(index, std::vector<byte>(1, '\0'), {});
+                continue;
+            }
+            const auto slot = freeSlots.back();
+            freeSlots.pop_back();
+            const auto size = static_cast<std::size_t>(info.st_size);
+            slots[slot] = PendingRead{index, fd, std::vector<byte>(size + 1), size, 0};
+            queueRead(slot);
+        }
+        if (freeSlots.size() == this->queueDepth)
+            break;
+
+        const auto submitted = syscall(__NR_io_uring_enter, this->ringFd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            // Shouldn't happen with a working ring. Stop using it, and read whatever is left the slow way
+            const std::error_code error{errno, std::generic_category()};
+            this->closeRing();
+            for (unsigned int slot = 0; slot < this->queueDepth; slot++) {
+                if (std::find(freeSlots.begin(), freeSlots.end(), slot) == freeSlots.end())
+                    finishRead(slot, error);
+            }
+            this->read(paths.subspan(next), [&callback, next](std::size_t index, std::vector<byte> contents, std::error_code readError) {
+                callback(next + index, std::move(contents), readError);
+            });
+            return;
+        }
+        unsubmitted -= static_cast<unsigned int>(submitted);
+
+        auto head = std::atomic_ref{*this->completionHead}.load(std::memory_order_relaxed);
+        const auto tail = std::atomic_ref{*this->completionTail}.load(std::memory_order_acquire);
+        for (; head != tail; head++) {
+            const auto& cqe = static_cast<const io_uring_cqe*>(this->completionEntries)[head & this->completionMask];
+            const auto slot = static_cast<unsigned int>(cqe.user_data);
+            auto& read = slots[slot];
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                queueRead(slot);
+            } else if (cqe.res < 0) {
+                finishRead(slot, std::error_code{-cqe.res, std::generic_category()});
+            } else if (cqe.res == 0 || (read.done += static_cast<std::size_t>(cqe.res)) == read.size) {
+                finishRead(slot, {});
+            } else {
+                queueRead(slot);
+            }
+        }
+        std::atomic_ref{*this->completionHead}.store(head, std::memory_order_release);
+    }
+}
+
+#else
+
+BatchFileReader::BatchFileReader(unsigned int queueDepth_) : queueDepth(queueDepth_) {}
+
+BatchFileReader::~BatchFileReader() = default;
+
+bool BatchFileReader::isAsync() const {
+    return false;
+}
+
+#endif
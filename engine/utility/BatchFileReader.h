@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <system_error>
+#include <vector>
+#include <core/Platform.h>
+#include <math/Types.h>
+#include "NoCopyOrMove.h"
+
+namespace chira {
+
+/// Reads many whole files at once.
+/// Only implemented with io_uring on Linux, where up to queueDepth reads are kept in flight.
+/// Elsewhere, or if the kernel doesn't allow io_uring, isAsync() is false and files are read one after another.
+class BatchFileReader : public NoCopyOrMove {
+public:
+    using Callback = std::function<void(std::size_t index, std::vector<byte> contents, std::error_code error)>;
+
+    explicit BatchFileReader(unsigned int queueDepth_);
+    ~BatchFileReader();
+
+    /// Reads every file, calling the callback with its index and its contents followed by a null terminator
+    /// as each read finishes, in any order. The callback is called on this thread. Blocks until every file is done.
+    void read(std::span<const std::filesystem::path> paths, const Callback& callback);
+
+    [[nodiscard]] bool isAsync() const;
+private:
+    unsigned int queueDepth;
+
+#ifdef CHIRA_PLATFORM_LINUX
+    int ringFd = -1;
+    void* submissionRing = nullptr;
+    std::size_t submissionRingSize = 0;
+    void* completionRing = nullptr;
+    std::size_t completionRingSize = 0;
+    void* submissionEntries = nullptr;
+    std::size_t submissionEntriesSize = 0;
+
+    unsigned int* submissionTail = nullptr;
+    unsigned int submissionMask = 0;
+    unsigned int* submissionArray = nullptr;
+    unsigned int* completionHead = nullptr;
+    unsigned int* completionTail = nullptr;
+    unsigned int completionMask = 0;
+    void* completionEntries = nullptr;
+
+    void readAsync(std::span<const std::filesystem::path> paths, const Callback& callback);
+    void closeRing();
+#endif
+};
+
+} // namespace chira
@@ -0,0 +1,144 @@
+#include "Compression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace chira;
+
+namespace {
+
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t MAX_OFFSET = 65535;
+// The format requires the last 5 bytes to be literals, and no match may start in the last 12
+constexpr std::size_t LAST_LITERALS = 5;
+constexpr std::size_t MATCH_SAFE_DISTANCE = 12;
+constexpr int HASH_BITS = 16;
+
+std::uint32_t read32(const byte* p) {
+    std::uint32_t out;
+    std::memcpy(&out, p, sizeof(out));
+    return out;
+}
+
+std::uint32_t hashSequence(std::uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void writeLength(std::vector<byte>& out, std::size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<byte>(length));
+}
+
+void writeSequence(std::vector<byte>& out, const byte* literals, std::size_t literalLength, std::size_t offset, std::size_t matchLength) {
+    const std::size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+    out.push_back(static_cast<byte>((std::min<std::size_t>(literalLength, 15) << 4) | std::min<std::size_t>(matchCode, 15)));
+    if (literalLength >= 15)
+        writeLength(out, literalLength - 15);
+    out.insert(out.end(), literals, literals + literalLength);
+    if (!matchLength)
+        return;
+    out.push_back(static_cast<byte>(offset & 0xff));
+    out.push_back(static_cast<byte>(offset >> 8));
+    if (matchCode >= 15)
+        writeLength(out, matchCode - 15);
+}
+
+} // namespace
+
+std::vector<byte> Compression::compress(const byte* source, std::size_t sourceSize) {
+    std::vector<byte> out;
+    out.reserve(sourceSize + sourceSize / 255 + 16);
+
+    std::size_t anchor = 0;
+    if (sourceSize > MATCH_SAFE_DISTANCE) {
+        // Positions are stored + 1 so zero means empty
+        std::vector<std::uint32_t> table(std::size_t{1} << HASH_BITS, 0);
+        const std::size_t matchLimit = sourceSize - LAST_LITERALS;
+        const std::size_t searchLimit = sourceSize - MATCH_SAFE_DISTANCE;
+        std::size_t position = 0;
+        while (position < searchLimit) {
+            const auto sequence = read32(source + position);
+            auto& slot = table[hashSequence(sequence)];
+            const std::size_t candidate = slot;
+            slot = static_cast<std::uint32_t>(position + 1);
+            if (!candidate || position - (candidate - 1) > MAX_OFFSET || read32(source + candidate - 1) != sequence) {
+                position++;
+                continue;
+            }
+            std::size_t match = candidate - 1;
+            // Extend backwards into the pending literals, then forwards
+            while (position > anchor && match > 0 && source[position - 1] == source[match - 1]) {
+                position--;
+                match--;
+            }
+            std::size_t length = MIN_MATCH;
+            while (position + length < matchLimit && source[position + length] == source[match + length])
+                length++;
+
+            writeSequence(out, source + anchor, position - anchor, position - match, length);
+            position += length;
+            anchor = position;
+        }
+    }
+    writeSequence(out, source + anchor, sourceSize - anchor, 0, 0);
+    return out;
+}
+
+bool Compression::decompress(const byte* source, std::size_t sourceSize, byte* destination, std::size_t destinationSize) {
+    const byte* in = source;
+    const byte* const inEnd = source + sourceSize;
+    byte* out = destination;
+    byte* const outEnd = destination + destinationSize;
+
+    const auto readLength = [&in, inEnd](std::size_t& length) {
+        byte next;
+        do {
+            if (in >= inEnd)
+                return false;
+            next = *in++;
+            length += next;
+        } while (next == 255);
+        return true;
+    };
+
+    while (in < inEnd) {
+        const byte token = *in++;
+
+        std::size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(literalLength))
+            return false;
+        if (literalLength > static_cast<std::size_t>(inEnd - in) || literalLength > static_cast<std::size_t>(outEnd - out))
+            return false;
+        std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        // The last sequence has no match
+        if (in == inEnd)
+            break;
+
+        if (inEnd - in < 2)
+            return false;
+        const std::size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if (!offset || offset > static_cast<std::size_t>(out - destination))
+            return false;
+
+        std::size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(matchLength))
+            return false;
+        matchLength += MIN_MATCH;
+        if (matchLength > static_cast<std::size_t>(outEnd - out))
+            return false;
+        // Matches can overlap their own output, so copy byte by byte
+        const byte* match = out - offset;
+        for (std::size_t i = 0; i < matchLength; i++)
+            out[i] = match[i];
+        out += matchLength;
+    }
+    return out == outEnd;
+}
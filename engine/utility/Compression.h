@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <math/Types.h>
+
+/// LZ4-style block compression, fast enough to decompress while loading resources.
+/// Blocks have no header, so the caller needs to store the uncompressed size.
+namespace chira::Compression {
+
+/// Returns the compressed block. It can be larger than the input if the input is incompressible.
+[[nodiscard]] std::vector<byte> compress(const byte* source, std::size_t sourceSize);
+
+/// Each compressed byte expands to at most this many bytes, so larger claimed sizes can be rejected before allocating.
+constexpr std::size_t MAX_EXPANSION = 255;
+
+/// Decompresses directly into destination, which must be exactly as large as the uncompressed data.
+/// Returns false if the block is malformed or doesn't decompress to exactly destinationSize bytes.
+[[nodiscard]] bool decompress(const byte* source, std::size_t sourceSize, byte* destination, std::size_t destinationSize);
+
+} // namespace chira::Compression
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <functional>
 #include <type_traits>
 
 namespace chira {
@@ -11,4 +12,9 @@ concept CArithmetic = std::is_arithmetic_v<T>;
 template<typename T>
 concept CNonArithmetic = !std::is_arithmetic_v<T>;
 
+template<typename T>
+concept CHashable = requires(const T& value) {
+    { std::hash<T>{}(value) } -> std::convertible_to<std::size_t>;
+};
+
 } // namespace chira
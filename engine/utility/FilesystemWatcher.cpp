@@ -0,0 +1,121 @@
+#include "FilesystemWatcher.h"
+
+#include <utility>
+
+#ifdef CHIRA_PLATFORM_LINUX
+    #include <climits>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+using namespace chira;
+
+#ifdef CHIRA_PLATFORM_LINUX
+
+namespace {
+
+constexpr std::uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_ONLYDIR;
+
+} // namespace
+
+FilesystemWatcher::FilesystemWatcher(std::filesystem::path root_) : root(std::move(root_)) {
+    if (!std::filesystem::is_directory(this->root))
+        return;
+    this->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->fd < 0)
+        return;
+    this->addWatch("");
+}
+
+FilesystemWatcher::~FilesystemWatcher() {
+    if (this->fd >= 0)
+        close(this->fd);
+}
+
+bool FilesystemWatcher::isWatching() const {
+    return this->fd >= 0 && !this->missingWatches;
+}
+
+void FilesystemWatcher::addWatch(const std::string& relativePath) {
+    const auto absolutePath = relativePath.empty() ? this->root : this->root / relativePath;
+    const int wd = inotify_add_watch(this->fd, absolutePath.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        this->missingWatches = true;
+        return;
+    }
+    this->watches[wd] = relativePath;
+
+    // inotify isn't recursive, every directory needs its own watch
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator{absolutePath, error}) {
+        if (entry.is_directory() && !entry.is_symlink())
+            this->addWatch(relativePath.empty() ? entry.path().filename().string() : relativePath + '/' + entry.path().filename().string());
+    }
+}
+
+std::vector<FilesystemEvent> FilesystemWatcher::poll() {
+    std::vector<FilesystemEvent> events;
+    if (this->fd < 0)
+        return events;
+
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        const auto length = read(this->fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+        for (char* p = buffer; p < buffer + length; p += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(p)->len) {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            if (event->mask & IN_Q_OVERFLOW) {
+                // The queue filled up and dropped events, it isn't tied to a watch
+                events.push_back({FilesystemChange::RESCAN, std::string{}, true});
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                this->watches.erase(event->wd);
+                continue;
+            }
+            auto watch = this->watches.find(event->wd);
+            if (watch == this->watches.end() || !event->len)
+                continue;
+
+            std::string path = watch->second.empty() ? std::string{event->name} : watch->second + '/' + event->name;
+            const bool isDirectory = event->mask & IN_ISDIR;
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                if (isDirectory)
+                    this->addWatch(path);
+                events.push_back({FilesystemChange::ADDED, std::move(path), isDirectory});
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                if (isDirectory) {
+                    // Moved directories keep their watches, but the paths we have for them are stale now
+                    std::erase_if(this->watches, [this, &path](const auto& pair) {
+                        if (pair.second == path || pair.second.starts_with(path + '/')) {
+                            inotify_rm_watch(this->fd, pair.first);
+                            return true;
+                        }
+                        return false;
+                    });
+                }
+                events.push_back({FilesystemChange::REMOVED, std::move(path), isDirectory});
+            } else if (event->mask & IN_CLOSE_WRITE) {
+                events.push_back({FilesystemChange::MODIFIED, std::move(path), false});
+            }
+        }
+    }
+    return events;
+}
+
+#else
+
+FilesystemWatcher::FilesystemWatcher(std::filesystem::path root_) : root(std::move(root_)) {}
+
+FilesystemWatcher::~FilesystemWatcher() = default;
+
+bool FilesystemWatcher::isWatching() const {
+    return false;
+}
+
+std::vector<FilesystemEvent> FilesystemWatcher::poll() {
+    return {};
+}
+
+#endif
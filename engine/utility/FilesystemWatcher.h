@@ -0,0 +1,56 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <core/Platform.h>
+#include "NoCopyOrMove.h"
+
+namespace chira {
+
+enum class FilesystemChange {
+    ADDED,
+    REMOVED,
+    MODIFIED,
+    /// Events were lost, anything under the root may have changed.
+    RESCAN,
+};
+
+struct FilesystemEvent {
+    FilesystemChange change;
+    /// Relative to the watched folder, with forward slashes.
+    std::string path;
+    bool isDirectory = false;
+};
+
+/// Watches a folder and everything under it for changes.
+/// Only implemented with inotify on Linux, elsewhere isWatching() is false and poll() never reports anything.
+class FilesystemWatcher : public NoCopyOrMove {
+public:
+    explicit FilesystemWatcher(std::filesystem::path root_);
+    ~FilesystemWatcher();
+
+    /// Never blocks. Files inside a directory that was added or removed are not reported individually.
+    [[nodiscard]] std::vector<FilesystemEvent> poll();
+
+    /// False if any folder couldn't be watched, so changes to it would go unnoticed.
+    [[nodiscard]] bool isWatching() const;
+    [[nodiscard]] const std::filesystem::path& getRoot() const {
+        return this->root;
+    }
+private:
+    std::filesystem::path root;
+
+#ifdef CHIRA_PLATFORM_LINUX
+    int fd = -1;
+    /// Watch descriptor to the watched directory, relative to the root.
+    std::unordered_map<int, std::string> watches;
+    /// Set if inotify_add_watch failed, usually from running out of watches.
+    bool missingWatches = false;
+
+    void addWatch(const std::string& relativePath);
+#endif
+};
+
+} // namespace chira
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace chira::Hash {
+
+namespace detail {
+
+constexpr std::uint64_t XXH64_PRIME_1 = 0x9e3779b185ebca87ull;
+constexpr std::uint64_t XXH64_PRIME_2 = 0xc2b2ae3d27d4eb4full;
+constexpr std::uint64_t XXH64_PRIME_3 = 0x165667b19e3779f9ull;
+constexpr std::uint64_t XXH64_PRIME_4 = 0x85ebca77c2b2ae63ull;
+constexpr std::uint64_t XXH64_PRIME_5 = 0x27d4eb2f165667c5ull;
+
+// Assembled byte by byte so it works at compile time, compilers turn this into a single load
+template<typename Char>
+constexpr std::uint64_t readLE64(const Char* p) {
+    std::uint64_t out = 0;
+    for (int i = 7; i >= 0; i--) {
+        out = (out << 8) | static_cast<std::uint8_t>(p[i]);
+    }
+    return out;
+}
+
+template<typename Char>
+constexpr std::uint32_t readLE32(const Char* p) {
+    std::uint32_t out = 0;
+    for (int i = 3; i >= 0; i--) {
+        out = (out << 8) | static_cast<std::uint8_t>(p[i]);
+    }
+    return out;
+}
+
+constexpr std::uint64_t xxh64Round(std::uint64_t acc, std::uint64_t input) {
+    acc += input * XXH64_PRIME_2;
+    acc = std::rotl(acc, 31);
+    return acc * XXH64_PRIME_1;
+}
+
+constexpr std::uint64_t xxh64MergeRound(std::uint64_t acc, std::uint64_t value) {
+    acc ^= xxh64Round(0, value);
+    return acc * XXH64_PRIME_1 + XXH64_PRIME_4;
+}
+
+template<typename Char>
+constexpr std::uint64_t xxh64(const Char* data, std::size_t length, std::uint64_t seed) {
+    const Char* p = data;
+    const Char* const end = data + length;
+    std::uint64_t hash;
+
+    if (length >= 32) {
+        std::uint64_t v1 = seed + XXH64_PRIME_1 + XXH64_PRIME_2;
+        std::uint64_t v2 = seed + XXH64_PRIME_2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - XXH64_PRIME_1;
+        for (; p + 32 <= end; p += 32) {
+            v1 = xxh64Round(v1, readLE64(p));
+            v2 = xxh64Round(v2, readLE64(p + 8));
+            v3 = xxh64Round(v3, readLE64(p + 16));
+            v4 = xxh64Round(v4, readLE64(p + 24));
+        }
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = xxh64MergeRound(hash, v1);
+        hash = xxh64MergeRound(hash, v2);
+        hash = xxh64MergeRound(hash, v3);
+        hash = xxh64MergeRound(hash, v4);
+    } else {
+        hash = seed + XXH64_PRIME_5;
+    }
+    hash += static_cast<std::uint64_t>(length);
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= xxh64Round(0, readLE64(p));
+        hash = std::rotl(hash, 27) * XXH64_PRIME_1 + XXH64_PRIME_4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<std::uint64_t>(readLE32(p)) * XXH64_PRIME_1;
+        hash = std::rotl(hash, 23) * XXH64_PRIME_2 + XXH64_PRIME_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= static_cast<std::uint8_t>(*p) * XXH64_PRIME_5;
+        hash = std::rotl(hash, 11) * XXH64_PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH64_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= XXH64_PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+} // namespace detail
+
+/// 64-bit xxHash (XXH64). Fast on long inputs and usable at compile time.
+[[nodiscard]] constexpr std::uint64_t xxh64(std::string_view str, std::uint64_t seed = 0) {
+    return detail::xxh64(str.data(), str.size(), seed);
+}
+
+[[nodiscard]] constexpr std::uint64_t xxh64(const std::uint8_t* data, std::size_t length, std::uint64_t seed = 0) {
+    return detail::xxh64(data, length, seed);
+}
+
+} // namespace chira::Hash
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <core/Assertions.h>
 
 namespace chira {
@@ -12,86 +14,120 @@ enum class CastType {
     C_CAST
 };
 
-struct SharedPointerMetadata {
-    unsigned int refCount = 1;
-    /// If the refcount is less than or equal to this number in the destructor (after it is subtracted once),
-    /// this is the last holder of the pointer and sharedPointer::ptr will be deleted.\n
-    /// 1 is the regular value, because this class is intended to be used as a resource, and the resource
-    /// manager always holds 1 copy of the pointer.
-    unsigned int holderAmountForDelete = 1;
-    SharedPointerMetadata() = default;
-    explicit SharedPointerMetadata(unsigned int refCount_) : refCount(refCount_) {}
-    SharedPointerMetadata(unsigned int refCount_, unsigned int holderAmountForDelete_) : refCount(refCount_), holderAmountForDelete(holderAmountForDelete_) {}
-    SharedPointerMetadata(const SharedPointerMetadata& other) = delete;
-    SharedPointerMetadata& operator=(const SharedPointerMetadata& other) = delete;
-    SharedPointerMetadata(SharedPointerMetadata&& other) = delete;
-    SharedPointerMetadata& operator=(SharedPointerMetadata&& other) = delete;
+class ReferenceCounted;
+template<typename T> class SharedPointer;
+template<typename T> class WeakPointer;
+
+/// Only allocated once something takes a weak reference to an object. Outlives the object until the last
+/// weak reference is gone, so weak references can tell whether the object is still alive.
+struct WeakReferenceBlock {
+    explicit WeakReferenceBlock(const ReferenceCounted* object_) : object(object_) {}
+
+    /// Held while turning a weak reference into a strong one, and while the object is being destroyed.
+    std::mutex mutex;
+    /// Null once the object is destroyed
+    std::atomic<const ReferenceCounted*> object;
+    /// Every weak reference counts once, and the object counts once while it's alive
+    std::atomic<unsigned int> weakCount{1};
+
+    void release() {
+        if (this->weakCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+};
+
+/// Base class of anything held by a SharedPointer. The reference count lives in the object itself,
+/// so sharing an object never allocates, and it's atomic, so handles can be copied and dropped on any thread.
+/// The object is deleted when the last SharedPointer to it is destroyed.
+class ReferenceCounted {
+    template<typename T> friend class SharedPointer;
+    template<typename T> friend class WeakPointer;
+public:
+    ReferenceCounted() = default;
+    // The count belongs to the object, not to its contents
+    ReferenceCounted(const ReferenceCounted& /*other*/) : ReferenceCounted() {}
+    ReferenceCounted& operator=(const ReferenceCounted& /*other*/) {
+        return *this;
+    }
+    virtual ~ReferenceCounted() = default;
+
+    [[nodiscard]] unsigned int getReferenceCount() const {
+        return this->strongCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    mutable std::atomic<unsigned int> strongCount{0};
+    mutable std::atomic<WeakReferenceBlock*> weakBlock{nullptr};
+
+    void retain() const {
+        this->strongCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() const {
+        if (this->strongCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (auto* block = this->weakBlock.load(std::memory_order_acquire)) {
+            {
+                // Waits for anyone in the middle of WeakPointer::lock(), who will see the count is zero
+                std::scoped_lock lock{block->mutex};
+                block->object.store(nullptr, std::memory_order_release);
+            }
+            block->release();
+        }
+        delete this;
+    }
+
+    /// Only called while the caller holds a strong reference, so the object can't be destroyed meanwhile.
+    [[nodiscard]] WeakReferenceBlock* getWeakBlock() const {
+        auto* block = this->weakBlock.load(std::memory_order_acquire);
+        if (block)
+            return block;
+        auto* created = new WeakReferenceBlock{this};
+        if (this->weakBlock.compare_exchange_strong(block, created, std::memory_order_acq_rel, std::memory_order_acquire))
+            return created;
+        // Another thread got there first
+        delete created;
+        return block;
+    }
 };
 
 template<typename T> class SharedPointer {
+    template<typename U> friend class WeakPointer;
 public:
     SharedPointer() = default;
-    explicit SharedPointer(T* inputPtr) : ptr(inputPtr), data(new SharedPointerMetadata{1}) {}
-    SharedPointer(T* inputPtr, SharedPointerMetadata* data_) : ptr(inputPtr), data(data_) {
-        if (this->data) {
-            this->data->refCount++;
-        }
+    /// The object can already be held by other SharedPointers, the count is kept in the object.
+    explicit SharedPointer(T* inputPtr) : ptr(inputPtr) {
+        if (this->ptr)
+            SharedPointer::counted(this->ptr)->retain();
+    }
+    SharedPointer(const SharedPointer<T>& other) noexcept : ptr(other.ptr) {
+        if (this->ptr)
+            SharedPointer::counted(this->ptr)->retain();
     }
     SharedPointer<T>& operator=(const SharedPointer<T>& other) noexcept {
-        if (this == &other)
-            return *this;
-
-        if ((this->data) && (this->data->refCount <= this->data->holderAmountForDelete)) {
-            delete this->ptr;
-            delete this->data;
-        }
+        // Retain first, in case both point to the same object
+        if (other.ptr)
+            SharedPointer::counted(other.ptr)->retain();
+        if (this->ptr)
+            SharedPointer::counted(this->ptr)->release();
         this->ptr = other.ptr;
-        this->data = other.data;
-        if (this->data) {
-            this->data->refCount++;
-        }
         return *this;
     }
-    SharedPointer(const SharedPointer<T>& other) noexcept {
-        if (this == &other)
-            return;
-
-        if ((this->data) && (this->data->refCount <= this->data->holderAmountForDelete)) {
-            delete this->ptr;
-            delete this->data;
-        }
-        this->ptr = other.ptr;
-        this->data = other.data;
-        if (this->data) {
-            this->data->refCount++;
-        }
+    SharedPointer(SharedPointer<T>&& other) noexcept : ptr(other.ptr) {
+        other.ptr = nullptr;
     }
     SharedPointer<T>& operator=(SharedPointer<T>&& other) noexcept {
-        if ((this->data) && (this->data->refCount <= this->data->holderAmountForDelete)) {
-            delete this->ptr;
-            delete this->data;
-        }
+        if (this == &other)
+            return *this;
+        if (this->ptr)
+            SharedPointer::counted(this->ptr)->release();
         this->ptr = other.ptr;
-        this->data = other.data;
         other.ptr = nullptr;
-        other.data = nullptr;
         return *this;
     }
-    SharedPointer(SharedPointer<T>&& other) noexcept {
-        *this = std::move(other);
-    }
     ~SharedPointer() {
-        if (!this->data) {
-            delete this->ptr;
-            return;
-        }
-        this->data->refCount--;
-        if (this->data->refCount == this->data->holderAmountForDelete) {
-            delete this->ptr;
-        }
-        if (this->data->refCount == 0) {
-            delete this->data;
-        }
+        if (this->ptr)
+            SharedPointer::counted(this->ptr)->release();
     }
     T* get() const noexcept {
         return this->ptr;
@@ -109,38 +145,26 @@ public:
         return !(bool(this->ptr));
     }
     [[nodiscard]] unsigned int useCount() const {
-        if (this->data)
-            return this->data->refCount;
+        if (this->ptr)
+            return SharedPointer::counted(this->ptr)->getReferenceCount();
         else
             return 0;
     }
-    [[nodiscard]] unsigned int getHolderAmountForDelete() const {
-        if (this->data) {
-            return this->data->holderAmountForDelete;
-        } else {
-            return 0;
-        }
-    }
-    void setHolderAmountForDelete(unsigned int newHolderAmountForDelete) const {
-        if (this->data) {
-            this->data->holderAmountForDelete = newHolderAmountForDelete;
-        }
-    }
     template<typename U>
     SharedPointer<U> castStatic() const {
-        return SharedPointer<U>(static_cast<U*>(this->ptr), this->data);
+        return SharedPointer<U>(static_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> castDynamic() const {
-        return SharedPointer<U>(dynamic_cast<U*>(this->ptr), this->data);
+        return SharedPointer<U>(dynamic_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> castAssert() const {
-        return SharedPointer<U>(assert_cast<U*>(this->ptr), this->data);
+        return SharedPointer<U>(assert_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> castReinterpret() const {
-        return SharedPointer<U>(reinterpret_cast<U*>(this->ptr), this->data);
+        return SharedPointer<U>(reinterpret_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> cast(CastType type = CastType::ASSERT_CAST) const {
@@ -155,13 +179,89 @@ public:
             case ASSERT_CAST:
                 return this->castAssert<U>();
             case C_CAST:
-                return SharedPointer<U>((U*)(this->ptr), this->data);
+                return SharedPointer<U>((U*)(this->ptr));
             CHIRA_NO_DEFAULT;
         }
     }
 protected:
     T* ptr = nullptr;
-    SharedPointerMetadata* data = nullptr;
+
+    static const ReferenceCounted* counted(const T* object) {
+        return static_cast<const ReferenceCounted*>(object);
+    }
+};
+
+/// Refers to an object held by SharedPointers without keeping it alive.
+template<typename T> class WeakPointer {
+public:
+    WeakPointer() = default;
+    explicit WeakPointer(const SharedPointer<T>& shared) : ptr(shared.ptr) {
+        if (this->ptr) {
+            this->block = SharedPointer<T>::counted(this->ptr)->getWeakBlock();
+            this->block->weakCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    WeakPointer(const WeakPointer<T>& other) noexcept : ptr(other.ptr), block(other.block) {
+        if (this->block)
+            this->block->weakCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    WeakPointer<T>& operator=(const WeakPointer<T>& other) noexcept {
+        if (other.block)
+            other.block->weakCount.fetch_add(1, std::memory_order_relaxed);
+        if (this->block)
+            this->block->release();
+        this->ptr = other.ptr;
+        this->block = other.block;
+        return *this;
+    }
+    WeakPointer(WeakPointer<T>&& other) noexcept : ptr(other.ptr), block(other.block) {
+        other.ptr = nullptr;
+        other.block = nullptr;
+    }
+    WeakPointer<T>& operator=(WeakPointer<T>&& other) noexcept {
+        if (this == &other)
+            return *this;
+        if (this->block)
+            this->block->release();
+        this->ptr = other.ptr;
+        this->block = other.block;
+        other.ptr = nullptr;
+        other.block = nullptr;
+        return *this;
+    }
+    ~WeakPointer() {
+        if (this->block)
+            this->block->release();
+    }
+
+    /// Returns true if the object was destroyed. A false result can be outdated by the time it's checked,
+    /// use lock() to get a handle to the object.
+    [[nodiscard]] bool expired() const {
+        return !this->block || !this->block->object.load(std::memory_order_acquire);
+    }
+
+    /// Returns a handle to the object, or an empty handle if it was destroyed.
+    [[nodiscard]] SharedPointer<T> lock() const {
+        if (!this->block)
+            return {};
+        std::scoped_lock lock{this->block->mutex};
+        const auto* object = this->block->object.load(std::memory_order_acquire);
+        if (!object)
+            return {};
+        // The object stays alive while the mutex is held, but its last strong reference might be gone already
+        auto count = object->strongCount.load(std::memory_order_relaxed);
+        do {
+            if (count == 0)
+                return {};
+        } while (!object->strongCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+        SharedPointer<T> shared;
+        shared.ptr = this->ptr;
+        return shared;
+    }
+
+private:
+    T* ptr = nullptr;
+    WeakReferenceBlock* block = nullptr;
 };
 
 } // namespace chira
@@ -0,0 +1,50 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace chira;
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+    this->workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        this->workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::scoped_lock lock{this->tasksMutex};
+        this->stopping = true;
+        this->tasks.clear();
+    }
+    this->tasksAvailable.notify_all();
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::scoped_lock lock{this->tasksMutex};
+        this->tasks.push_back(std::move(task));
+    }
+    this->tasksAvailable.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{this->tasksMutex};
+            this->tasksAvailable.wait(lock, [this] { return this->stopping || !this->tasks.empty(); });
+            if (this->stopping)
+                return;
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "NoCopyOrMove.h"
+
+namespace chira {
+
+/// A fixed set of worker threads that run submitted tasks in FIFO order.
+class ThreadPool : public NoCopyOrMove {
+public:
+    /// A thread count of zero picks one less than the number of hardware threads (at least one).
+    explicit ThreadPool(unsigned int threadCount = 0);
+    /// Tasks that have not started yet are dropped, running tasks are waited on.
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+
+    [[nodiscard]] unsigned int getThreadCount() const {
+        return static_cast<unsigned int>(this->workers.size());
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksAvailable;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+} // namespace chira
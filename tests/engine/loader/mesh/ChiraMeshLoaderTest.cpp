@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <loader/mesh/ChiraMeshLoader.h>
+
+using namespace chira;
+
+namespace {
+
+std::vector<Vertex> makeVertices() {
+    return {
+            {{-1.f, 0.f, 2.f}, {0.f, 1.f, 0.f}, {1.f, 0.5f, 0.f}, {0.f, 0.f}},
+            {{3.f, 0.5f, 2.f}, {0.f, 0.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 0.f}},
+            {{3.f, 4.f, -2.f}, {0.6f, 0.8f, 0.f}, {0.f, 0.f, 1.f}, {1.f, 0.25f}},
+            {{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}, {1.f, 1.f, 1.f}, {0.5f, 1.f}},
+    };
+}
+
+const std::vector<Index> INDICES{0, 1, 2, 2, 3, 0};
+
+} // namespace
+
+TEST(ChiraMeshLoader, roundTrip) {
+    const auto vertices = makeVertices();
+    const auto data = ChiraMeshLoader{}.createMesh(vertices, INDICES);
+
+    ChiraMeshHeaderV2 header;
+    ASSERT_GE(data.size(), sizeof(header));
+    std::memcpy(&header, data.data(), sizeof(header));
+    EXPECT_EQ(header.version, 2);
+    EXPECT_EQ(header.vertexCount, vertices.size());
+    EXPECT_EQ(header.indexSize, 2);
+    EXPECT_EQ(header.vertexDataOffset % CHIRA_MESH_V2_ALIGNMENT, 0);
+    EXPECT_EQ(header.indexDataOffset % CHIRA_MESH_V2_ALIGNMENT, 0);
+    EXPECT_EQ(data.size() % CHIRA_MESH_V2_ALIGNMENT, 0);
+    EXPECT_FLOAT_EQ(header.boundsMin[0], -1.f);
+    EXPECT_FLOAT_EQ(header.boundsMax[1], 4.f);
+    EXPECT_FLOAT_EQ(header.boundsMin[2], -2.f);
+    EXPECT_FLOAT_EQ(header.sphereCenter[0], 1.f);
+    EXPECT_FLOAT_EQ(header.sphereRadius, std::sqrt(12.f));
+
+    std::vector<Vertex> loadedVertices;
+    std::vector<Index> loadedIndices;
+    ASSERT_TRUE(ChiraMeshLoader::parse(data.data(), data.size(), loadedVertices, loadedIndices));
+    EXPECT_EQ(loadedVertices, vertices);
+    EXPECT_EQ(loadedIndices, INDICES);
+
+    // Loading again appends, with the indices offset
+    ASSERT_TRUE(ChiraMeshLoader::parse(data.data(), data.size(), loadedVertices, loadedIndices));
+    EXPECT_EQ(loadedVertices.size(), vertices.size() * 2);
+    EXPECT_EQ(loadedIndices[INDICES.size() + 1], INDICES[1] + vertices.size());
+}
+
+TEST(ChiraMeshLoader, quantizedRoundTrip) {
+    const auto vertices = makeVertices();
+    const auto data = ChiraMeshLoader{{true, true, true, true}}.createMesh(vertices, INDICES);
+    EXPECT_LT(data.size(), ChiraMeshLoader{}.createMesh(vertices, INDICES).size());
+
+    std::vector<Vertex> loadedVertices;
+    std::vector<Index> loadedIndices;
+    ASSERT_TRUE(ChiraMeshLoader::parse(data.data(), data.size(), loadedVertices, loadedIndices));
+    ASSERT_EQ(loadedVertices.size(), vertices.size());
+    EXPECT_EQ(loadedIndices, INDICES);
+    for (std::size_t i = 0; i < vertices.size(); i++) {
+        EXPECT_NEAR(loadedVertices[i].position.x, vertices[i].position.x, 0.001f);
+        EXPECT_NEAR(loadedVertices[i].position.y, vertices[i].position.y, 0.001f);
+        EXPECT_NEAR(loadedVertices[i].position.z, vertices[i].position.z, 0.001f);
+        EXPECT_NEAR(loadedVertices[i].normal.r, vertices[i].normal.r, 0.001f);
+        EXPECT_NEAR(loadedVertices[i].normal.g, vertices[i].normal.g, 0.001f);
+        EXPECT_NEAR(loadedVertices[i].normal.b, vertices[i].normal.b, 0.001f);
+        EXPECT_NEAR(loadedVertices[i].color.g, vertices[i].color.g, 1.f / 255);
+        EXPECT_NEAR(loadedVertices[i].uv.g, vertices[i].uv.g, 0.001f);
+    }
+}
+
+TEST(ChiraMeshLoader, loadVersion1) {
+    const auto vertices = makeVertices();
+    ChiraMeshHeader header;
+    header.version = 1;
+    header.vertexCount = static_cast<unsigned int>(vertices.size());
+    header.indexCount = static_cast<unsigned int>(INDICES.size());
+    std::vector<byte> data(CHIRA_MESH_HEADER_SIZE + vertices.size() * sizeof(Vertex) + INDICES.size() * sizeof(Index));
+    std::memcpy(data.data(), &header, CHIRA_MESH_HEADER_SIZE);
+    std::memcpy(data.data() + CHIRA_MESH_HEADER_SIZE, vertices.data(), vertices.size() * sizeof(Vertex));
+    std::memcpy(data.data() + CHIRA_MESH_HEADER_SIZE + vertices.size() * sizeof(Vertex), INDICES.data(), INDICES.size() * sizeof(Index));
+
+    std::vector<Vertex> loadedVertices;
+    std::vector<Index> loadedIndices;
+    ASSERT_TRUE(ChiraMeshLoader::parse(data.data(), data.size(), loadedVertices, loadedIndices));
+    EXPECT_EQ(loadedVertices, vertices);
+    EXPECT_EQ(loadedIndices, INDICES);
+}
+
+TEST(ChiraMeshLoader, rejectInvalidData) {
+    auto data = ChiraMeshLoader{}.createMesh(makeVertices(), INDICES);
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    EXPECT_FALSE(ChiraMeshLoader::parse(data.data(), 8, vertices, indices));
+    EXPECT_FALSE(ChiraMeshLoader::parse(data.data(), data.size() - CHIRA_MESH_V2_ALIGNMENT, vertices, indices));
+    data[0] = 3;
+    EXPECT_FALSE(ChiraMeshLoader::parse(data.data(), data.size(), vertices, indices));
+    EXPECT_TRUE(vertices.empty());
+}
+
+TEST(ChiraMeshLoader, rejectOutOfRangeIndices) {
+    const auto vertices = makeVertices();
+    auto badIndices = INDICES;
+    badIndices[4] = static_cast<Index>(vertices.size());
+    const auto data = ChiraMeshLoader{}.createMesh(vertices, badIndices);
+
+    std::vector<Vertex> loadedVertices;
+    std::vector<Index> loadedIndices;
+    EXPECT_FALSE(ChiraMeshLoader::parse(data.data(), data.size(), loadedVertices, loadedIndices));
+    EXPECT_TRUE(loadedVertices.empty());
+    EXPECT_TRUE(loadedIndices.empty());
+
+    // Appending to existing data widens the indices instead of copying them, and leaves the old data alone
+    loadedVertices.push_back(Vertex{});
+    loadedIndices.push_back(0);
+    EXPECT_FALSE(ChiraMeshLoader::parse(data.data(), data.size(), loadedVertices, loadedIndices));
+    EXPECT_EQ(loadedVertices.size(), 1);
+    EXPECT_EQ(loadedIndices.size(), 1);
+
+    ChiraMeshHeader header;
+    header.version = 1;
+    header.vertexCount = static_cast<unsigned int>(vertices.size());
+    header.indexCount = static_cast<unsigned int>(badIndices.size());
+    std::vector<byte> dataV1(CHIRA_MESH_HEADER_SIZE + vertices.size() * sizeof(Vertex) + badIndices.size() * sizeof(Index));
+    std::memcpy(dataV1.data(), &header, CHIRA_MESH_HEADER_SIZE);
+    std::memcpy(dataV1.data() + CHIRA_MESH_HEADER_SIZE, vertices.data(), vertices.size() * sizeof(Vertex));
+    std::memcpy(dataV1.data() + CHIRA_MESH_HEADER_SIZE + vertices.size() * sizeof(Vertex), badIndices.data(), badIndices.size() * sizeof(Index));
+    EXPECT_FALSE(ChiraMeshLoader::parse(dataV1.data(), dataV1.size(), loadedVertices, loadedIndices));
+    EXPECT_EQ(loadedVertices.size(), 1);
+    EXPECT_EQ(loadedIndices.size(), 1);
+}
+
+TEST(ChiraMeshLoader, roundTripLODs) {
+    const auto vertices = makeVertices();
+    auto indices = INDICES;
+    indices.insert(indices.end(), {0, 1, 2});
+    const std::vector<MeshLOD> lods{{0, 6, 0.f}, {6, 3, 0.25f}};
+    const auto data = ChiraMeshLoader{}.createMeshWithLODs(vertices, indices, lods);
+
+    std::vector<Vertex> loadedVertices{Vertex{}};
+    std::vector<Index> loadedIndices{0, 0, 0};
+    std::vector<MeshLOD> loadedLODs;
+    ASSERT_TRUE(ChiraMeshLoader::parse(data.data(), data.size(), loadedVertices, loadedIndices, &loadedLODs));
+    ASSERT_EQ(loadedLODs.size(), 2);
+    EXPECT_EQ(loadedLODs[0].firstIndex, 3);
+    EXPECT_EQ(loadedLODs[0].indexCount, 6);
+    EXPECT_EQ(loadedLODs[1].firstIndex, 9);
+    EXPECT_EQ(loadedLODs[1].indexCount, 3);
+    EXPECT_FLOAT_EQ(loadedLODs[1].error, 0.25f);
+    EXPECT_EQ(loadedIndices.size(), 12);
+    EXPECT_EQ(loadedIndices[9], 1);
+
+    // Without asking for LODs, only the full mesh is read
+    std::vector<Vertex> fullVertices;
+    std::vector<Index> fullIndices;
+    ASSERT_TRUE(ChiraMeshLoader::parse(data.data(), data.size(), fullVertices, fullIndices));
+    EXPECT_EQ(fullIndices, INDICES);
+}
+
+TEST(ChiraMeshLoader, rejectInvalidLODs) {
+    const std::vector<MeshLOD> lods{{0, 6, 0.f}, {4, 3, 0.25f}};
+    auto data = ChiraMeshLoader{}.createMeshWithLODs(makeVertices(), INDICES, lods);
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    std::vector<MeshLOD> loadedLODs;
+    EXPECT_FALSE(ChiraMeshLoader::parse(data.data(), data.size(), vertices, indices, &loadedLODs));
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <loader/mesh/OBJMeshLoader.h>
+
+using namespace chira;
+
+TEST(OBJMeshLoader, parseTriangle) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    const auto skipped = OBJMeshLoader::parse(
+            "# A comment\n"
+            "o triangle\n"
+            "v 0 0 0\n"
+            "v 1.5 0 0\r\n"
+            "v 0 +1 -2e-1\n"
+            "vt 0 0\n"
+            "vt 1 0\n"
+            "vt 0 1\n"
+            "vn 0 1 0\n"
+            "f 1/1/1 2/2/1 3/3/1\n",
+            vertices, indices);
+    EXPECT_EQ(skipped, 0);
+    ASSERT_EQ(vertices.size(), 3);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2}));
+    EXPECT_EQ(vertices[1].position, glm::vec3(1.5f, 0.f, 0.f));
+    EXPECT_EQ(vertices[2].position, glm::vec3(0.f, 1.f, -0.2f));
+    EXPECT_EQ(vertices[2].uv, ColorRG(0.f, 1.f));
+    EXPECT_EQ(vertices[0].normal, ColorRGB(0.f, 1.f, 0.f));
+}
+
+TEST(OBJMeshLoader, triangulatesPolygons) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    const auto skipped = OBJMeshLoader::parse(
+            "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0.5 1.5 0\n"
+            "f 1 2 3 4\n"
+            "f 4 3 5\n",
+            vertices, indices);
+    EXPECT_EQ(skipped, 0);
+    EXPECT_EQ(vertices.size(), 5);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2, 0, 2, 3, 3, 2, 4}));
+}
+
+TEST(OBJMeshLoader, parseRelativeAndPartialIndices) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    const auto skipped = OBJMeshLoader::parse(
+            "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+            "vt 0.25 0.75\n"
+            "vn 0 0 1\n"
+            // Positions and normals only, and the same with relative indices
+            "f 1//1 2//1 3//1\n"
+            "f -3//-1 -2//-1 -1//-1\n"
+            // Positions and UVs only
+            "f -3/1 -2/1 -1/1\n",
+            vertices, indices);
+    EXPECT_EQ(skipped, 0);
+    ASSERT_EQ(vertices.size(), 6);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2, 0, 1, 2, 3, 4, 5}));
+    EXPECT_EQ(vertices[0].normal, ColorRGB(0.f, 0.f, 1.f));
+    EXPECT_EQ(vertices[0].uv, ColorRG(0.f, 0.f));
+    EXPECT_EQ(vertices[3].normal, ColorRGB(0.f, 0.f, 0.f));
+    EXPECT_EQ(vertices[3].uv, ColorRG(0.25f, 0.75f));
+}
+
+TEST(OBJMeshLoader, skipsInvalidFaces) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    const auto skipped = OBJMeshLoader::parse(
+            "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+            "f 1 2 4\n"
+            "f 0 1 2\n"
+            "f 1/1 2/1 3/1\n"
+            "f 1 2\n"
+            "f 1 2 3\n",
+            vertices, indices);
+    EXPECT_EQ(skipped, 4);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2}));
+}
+
+namespace {
+
+/// A grid of squares with positions, UVs and normals. Each row of faces refers back to the vertices of the
+/// two rows defined before it with relative indices, like an exporter streaming out a large mesh would.
+std::string makeGridOBJ(int size) {
+    std::string obj = "vn 0.0 1.0 0.0\n";
+    const auto addRow = [&obj, size](int y) {
+        for (int x = 0; x <= size; x++) {
+            obj += "v " + std::to_string(x) + ".0 0.0 " + std::to_string(y) + ".0\n";
+            obj += "vt " + std::to_string(static_cast<float>(x) / static_cast<float>(size)) + ' '
+                         + std::to_string(static_cast<float>(y) / static_cast<float>(size)) + '\n';
+        }
+    };
+    addRow(0);
+    for (int y = 0; y < size; y++) {
+        addRow(y + 1);
+        for (int x = 0; x < size; x++) {
+            const auto previous = std::to_string(x - 2 * (size + 1));
+            const auto previousNext = std::to_string(x + 1 - 2 * (size + 1));
+            const auto current = std::to_string(x - (size + 1));
+            const auto currentNext = std::to_string(x + 1 - (size + 1));
+            obj += "f " + previous + '/' + previous + "/1 " + previousNext + '/' + previousNext + "/1 "
+                        + currentNext + '/' + currentNext + "/1 " + current + '/' + current + "/1\n";
+        }
+    }
+    return obj;
+}
+
+} // namespace
+
+TEST(OBJMeshLoader, parseInChunks) {
+    // Big enough to be split
+    const auto obj = makeGridOBJ(300);
+    ASSERT_GT(obj.size(), 4u << 20);
+
+    std::vector<Vertex> serialVertices;
+    std::vector<Index> serialIndices;
+    EXPECT_EQ(OBJMeshLoader::parse(obj, serialVertices, serialIndices, 1), 0);
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    EXPECT_EQ(OBJMeshLoader::parse(obj, vertices, indices, 4), 0);
+
+    EXPECT_EQ(vertices.size(), 301 * 301);
+    EXPECT_EQ(indices.size(), 300 * 300 * 6);
+    EXPECT_EQ(vertices, serialVertices);
+    EXPECT_EQ(indices, serialIndices);
+}
+
+TEST(OBJMeshLoader, DISABLED_benchmarkParse) {
+    const auto obj = makeGridOBJ(1500);
+    const auto megabytes = static_cast<double>(obj.size()) / (1024 * 1024);
+    for (unsigned int threadCount : {1u, 0u}) {
+        std::vector<Vertex> vertices;
+        std::vector<Index> indices;
+        const auto start = std::chrono::steady_clock::now();
+        OBJMeshLoader::parse(obj, vertices, indices, threadCount);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << megabytes << " MB, " << (threadCount ? "1 thread" : "all threads") << ": "
+                  << elapsed.count() * 1000 << " ms, " << megabytes / elapsed.count() << " MB/s\n";
+    }
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <render/RenderQueue.h>
+
+using namespace chira;
+
+namespace {
+
+// Only used for their addresses
+int shaderA, shaderB, materialA, materialB, meshA, meshB;
+
+} // namespace
+
+TEST(RenderQueue, keyFieldOrder) {
+    EXPECT_EQ(RenderQueue::makeKey(0, 0, nullptr, nullptr, nullptr, 0.f), 0);
+
+    // Earlier fields win no matter what comes after them
+    EXPECT_LT(RenderQueue::makeKey(0, 63, &shaderA, &materialA, &meshA, 1000.f), RenderQueue::makeKey(1, 0, nullptr, nullptr, nullptr, 0.f));
+    EXPECT_LT(RenderQueue::makeKey(2, 0, &shaderA, &materialA, &meshA, 1000.f), RenderQueue::makeKey(2, 1, nullptr, nullptr, nullptr, 0.f));
+    // Out of range layers and views are clamped instead of spilling into the field before them
+    EXPECT_LT(RenderQueue::makeKey(0, 1000, nullptr, nullptr, nullptr, 0.f), RenderQueue::makeKey(1, 0, nullptr, nullptr, nullptr, 0.f));
+    EXPECT_EQ(RenderQueue::makeKey(100, 0, nullptr, nullptr, nullptr, 0.f), RenderQueue::makeKey(15, 0, nullptr, nullptr, nullptr, 0.f));
+}
+
+TEST(RenderQueue, keyGroupsState) {
+    const auto key = RenderQueue::makeKey(3, 1, &shaderA, &materialA, &meshA, 5.f);
+    EXPECT_EQ(key, RenderQueue::makeKey(3, 1, &shaderA, &materialA, &meshA, 5.f));
+
+    // Draws with the same state only differ in the depth bits
+    constexpr auto depthMask = (1ull << RenderQueue::DEPTH_BITS) - 1;
+    EXPECT_EQ(key & ~depthMask, RenderQueue::makeKey(3, 1, &shaderA, &materialA, &meshA, 50.f) & ~depthMask);
+    EXPECT_NE(key, RenderQueue::makeKey(3, 1, &shaderB, &materialA, &meshA, 5.f));
+    EXPECT_NE(key, RenderQueue::makeKey(3, 1, &shaderA, &materialB, &meshA, 5.f));
+    EXPECT_NE(key, RenderQueue::makeKey(3, 1, &shaderA, &materialA, &meshB, 5.f));
+}
+
+TEST(RenderQueue, keyDepth) {
+    const auto getKey = [](float depth) {
+        return RenderQueue::makeKey(0, 0, &shaderA, &materialA, &meshA, depth);
+    };
+    // Closer first
+    EXPECT_LT(getKey(0.5f), getKey(1.f));
+    EXPECT_LT(getKey(1.f), getKey(2.f));
+    EXPECT_LT(getKey(10.f), getKey(1000.f));
+    EXPECT_LT(getKey(1000.f), getKey(1e9f));
+    // Behind or on the camera
+    EXPECT_EQ(getKey(-1.f), getKey(0.f));
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <render/backend/ShaderUniformTable.h>
+
+using namespace chira;
+
+TEST(ShaderUniformTable, find) {
+    ShaderUniformTable table;
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.find("m"), ShaderUniformTable::INVALID_LOCATION);
+
+    table.add("m", 0);
+    table.add("material.shininess", 4);
+    table.add("material.lambertFactor", 5);
+    EXPECT_EQ(table.size(), 3);
+    EXPECT_EQ(table.find("m"), 0);
+    EXPECT_EQ(table.find("material.shininess"), 4);
+    EXPECT_EQ(table.find("material.lambertFactor"), 5);
+    EXPECT_EQ(table.find("material.diffuse"), ShaderUniformTable::INVALID_LOCATION);
+
+    constexpr auto hash = Hash::xxh64("material.shininess");
+    EXPECT_EQ(table.find("material.shininess", hash), 4);
+    // The name still has to match
+    EXPECT_EQ(table.find("material.lambertFactor", hash), ShaderUniformTable::INVALID_LOCATION);
+}
+
+TEST(ShaderUniformTable, replace) {
+    ShaderUniformTable table;
+    table.add("texture0", 1);
+    table.add("texture0", 2);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.find("texture0"), 2);
+
+    table.clear();
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.find("texture0"), ShaderUniformTable::INVALID_LOCATION);
+}
+
+TEST(ShaderUniformTable, manyUniforms) {
+    ShaderUniformTable table;
+    for (int i = 0; i < 256; i++)
+        table.add("lights[" + std::to_string(i) + "].color", i);
+    for (int i = 0; i < 256; i++)
+        EXPECT_EQ(table.find("lights[" + std::to_string(i) + "].color"), i);
+}
+
+TEST(ShaderUniformTable, DISABLED_benchmarkDraws) {
+    constexpr int DRAW_COUNT = 10000;
+    constexpr int PASSES = 100;
+
+    // About what the lit shaders have outside of their uniform blocks
+    ShaderUniformTable table;
+    std::unordered_map<std::string, int> map;
+    std::vector<std::string> names{"m", "material.diffuse", "material.specular", "material.shininess", "material.lambertFactor", "texture0"};
+    for (int i = 0; i < 16; i++)
+        names.push_back("bones[" + std::to_string(i) + "]");
+    for (int i = 0; i < static_cast<int>(names.size()); i++) {
+        table.add(names[i], i);
+        map[names[i]] = i;
+    }
+    const int m = table.find("m"), shininess = table.find("material.shininess"), lambertFactor = table.find("material.lambertFactor");
+
+    // Each draw sets the model matrix, shininess and lambert factor, like a Phong mesh
+    auto benchmark = [](std::string_view name, auto&& lookup) {
+        long long sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < PASSES; pass++) {
+            for (int i = 0; i < DRAW_COUNT; i++) {
+                sum += lookup(i);
+            }
+        }
+        std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << time.count() / PASSES << " us per " << DRAW_COUNT << " draws (checksum " << sum << ")\n";
+    };
+    benchmark("std::string map", [&](int i) {
+        return map.find("m")->second + map.find("material.shininess")->second + map.find("material.lambertFactor")->second + (i & 1);
+    });
+    benchmark("table by name", [&](int i) {
+        return table.find("m") + table.find("material.shininess") + table.find("material.lambertFactor") + (i & 1);
+    });
+    benchmark("resolved handles", [&](int i) {
+        return m + shininess + lambertFactor + (i & 1);
+    });
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <render/backend/UniformBufferSlices.h>
+
+using namespace chira;
+
+namespace {
+
+struct Parameters {
+    float shininess;
+    float lambertFactor;
+    float padding[2];
+};
+
+Parameters readSlice(const UniformBufferSlices& slices, UniformBufferSlices::Slice slice) {
+    Parameters out{};
+    std::memcpy(&out, slices.getData() + slices.getOffset(slice), sizeof(Parameters));
+    return out;
+}
+
+} // namespace
+
+TEST(UniformBufferSlices, alignsSlices) {
+    UniformBufferSlices slices{sizeof(Parameters), 256, 4};
+    EXPECT_EQ(slices.getDataSize(), 16);
+    EXPECT_EQ(slices.getSliceSize(), 256);
+    EXPECT_EQ(slices.getCapacity(), 4);
+    EXPECT_EQ(slices.getSize(), 4 * 256);
+
+    const Parameters parameters{32.f, 1.f, {}};
+    const auto acquired = slices.acquire(&parameters);
+    EXPECT_EQ(acquired.slice, 0);
+    EXPECT_EQ(slices.getOffset(acquired.slice), 0);
+    EXPECT_EQ(readSlice(slices, acquired.slice).shininess, 32.f);
+
+    UniformBufferSlices packed{sizeof(Parameters), 4, 4};
+    EXPECT_EQ(packed.getSliceSize(), 16);
+}
+
+TEST(UniformBufferSlices, sharesEqualContents) {
+    UniformBufferSlices slices{sizeof(Parameters), 64, 4};
+    const Parameters shiny{64.f, 1.f, {}};
+    const Parameters dull{8.f, 0.5f, {}};
+
+    const auto first = slices.acquire(&shiny);
+    EXPECT_TRUE(first.written);
+    const auto second = slices.acquire(&shiny);
+    EXPECT_FALSE(second.written);
+    EXPECT_EQ(first.slice, second.slice);
+    EXPECT_EQ(slices.getUsers(first.slice), 2);
+
+    const auto third = slices.acquire(&dull);
+    EXPECT_TRUE(third.written);
+    EXPECT_NE(third.slice, first.slice);
+    EXPECT_EQ(readSlice(slices, third.slice).lambertFactor, 0.5f);
+
+    // Changing one owner leaves the shared slice alone
+    const auto changed = slices.acquire(&dull);
+    slices.release(second.slice);
+    EXPECT_EQ(changed.slice, third.slice);
+    EXPECT_EQ(slices.getUsers(first.slice), 1);
+    EXPECT_EQ(readSlice(slices, first.slice).shininess, 64.f);
+
+    // Released slices are reused, and can't be matched anymore
+    slices.release(first.slice);
+    EXPECT_EQ(slices.getUsers(first.slice), 0);
+    const Parameters other{2.f, 0.f, {}};
+    const auto reused = slices.acquire(&other);
+    EXPECT_TRUE(reused.written);
+    EXPECT_EQ(reused.slice, first.slice);
+    const auto fresh = slices.acquire(&shiny);
+    EXPECT_TRUE(fresh.written);
+    EXPECT_NE(fresh.slice, first.slice);
+}
+
+TEST(UniformBufferSlices, growsWhenFull) {
+    UniformBufferSlices slices{sizeof(Parameters), 16, 2};
+    for (int i = 0; i < 2; i++) {
+        const Parameters parameters{static_cast<float>(i), 1.f, {}};
+        EXPECT_FALSE(slices.acquire(&parameters).grew);
+    }
+    const Parameters parameters{2.f, 1.f, {}};
+    const auto acquired = slices.acquire(&parameters);
+    EXPECT_TRUE(acquired.grew);
+    EXPECT_EQ(acquired.slice, 2);
+    EXPECT_EQ(slices.getCapacity(), 4);
+    EXPECT_EQ(slices.getSize(), 4 * 16);
+    // Old contents survive growing
+    EXPECT_EQ(readSlice(slices, 0).shininess, 0.f);
+    EXPECT_EQ(readSlice(slices, 1).shininess, 1.f);
+    EXPECT_EQ(readSlice(slices, 2).shininess, 2.f);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <render/backend/VertexLayout.h>
+
+using namespace chira;
+
+namespace {
+
+template<typename T>
+T read(const std::vector<byte>& data, std::size_t offset) {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+TEST(VertexLayout, strides) {
+    EXPECT_EQ(VertexLayout{}.getStride(), sizeof(Vertex));
+    EXPECT_TRUE(VertexLayout{}.matchesVertex());
+    EXPECT_EQ(VertexLayout{VertexLayoutType::COMPACT}.getStride(), 28);
+    EXPECT_EQ(VertexLayout{VertexLayoutType::COMPACT_NO_COLOR}.getStride(), 24);
+    EXPECT_FALSE(VertexLayout{VertexLayoutType::COMPACT}.matchesVertex());
+    EXPECT_FALSE(VertexLayout{VertexLayoutType::COMPACT_NO_COLOR}.has(VertexAttribute::COLOR));
+
+    const VertexLayout custom{{VertexAttribute::POSITION, VertexAttributeFormat::FLOAT3}, {VertexAttribute::UV, VertexAttributeFormat::FLOAT2}};
+    EXPECT_EQ(custom.getStride(), 20);
+    EXPECT_EQ(custom.getElements()[1].offset, 12);
+    EXPECT_FALSE(custom.has(VertexAttribute::NORMAL));
+    EXPECT_EQ(custom, (VertexLayout{{VertexAttribute::POSITION, VertexAttributeFormat::FLOAT3}, {VertexAttribute::UV, VertexAttributeFormat::FLOAT2}}));
+    EXPECT_FALSE(custom == VertexLayout{});
+}
+
+TEST(VertexLayout, packFull) {
+    const std::vector<Vertex> vertices{
+            Vertex{{1, 2, 3}, {0, 1, 0}, {0.5f, 0.25f, 1}, {0.5f, 1}},
+            Vertex{{4, 5, 6}},
+    };
+    const auto packed = VertexLayout{}.pack(vertices);
+    ASSERT_EQ(packed.size(), sizeof(Vertex) * 2);
+    EXPECT_EQ(std::memcmp(packed.data(), vertices.data(), packed.size()), 0);
+    EXPECT_TRUE(VertexLayout{}.pack({}).empty());
+}
+
+TEST(VertexLayout, packCompact) {
+    Vertex vertex{{1, 2, 3}, {0, 0, 0}, {1, 0, 0.5f}, {0.5f, 0.25f}};
+    // Set directly, the constructors clamp them like colors
+    vertex.normal.r = 1.f;
+    vertex.normal.g = -1.f;
+    vertex.uv.r = 2.f;
+    const VertexLayout layout{VertexLayoutType::COMPACT};
+    const auto packed = layout.pack({vertex, vertex});
+    ASSERT_EQ(packed.size(), 56);
+
+    EXPECT_EQ(read<float>(packed, 0), 1.f);
+    EXPECT_EQ(read<float>(packed, 4), 2.f);
+    EXPECT_EQ(read<float>(packed, 8), 3.f);
+    EXPECT_EQ(read<std::int16_t>(packed, 12), 32767);
+    EXPECT_EQ(read<std::int16_t>(packed, 14), -32767);
+    EXPECT_EQ(read<std::int16_t>(packed, 16), 0);
+    EXPECT_EQ(read<std::uint8_t>(packed, 20), 255);
+    EXPECT_EQ(read<std::uint8_t>(packed, 21), 0);
+    EXPECT_EQ(read<std::uint8_t>(packed, 22), 128);
+    EXPECT_EQ(read<std::uint8_t>(packed, 23), 255);
+    // 2, 0.25 as half floats
+    EXPECT_EQ(read<std::uint16_t>(packed, 24), 0x4000);
+    EXPECT_EQ(read<std::uint16_t>(packed, 26), 0x3400);
+    EXPECT_EQ(std::memcmp(packed.data(), packed.data() + 28, 28), 0);
+}
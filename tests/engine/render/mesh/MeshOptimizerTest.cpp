@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <render/mesh/MeshOptimizer.h>
+
+using namespace chira;
+
+namespace {
+
+/// A grid of squares made of two triangles each, in a random order.
+void makeShuffledGrid(int size, std::vector<Vertex>& vertices, std::vector<Index>& indices) {
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++)
+            vertices.push_back(Vertex{{static_cast<float>(x), 0.f, static_cast<float>(y)}, {0, 1, 0}});
+    }
+    std::vector<std::array<Index, 3>> triangles;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const auto corner = static_cast<Index>(y * (size + 1) + x);
+            const auto below = corner + static_cast<Index>(size + 1);
+            triangles.push_back({corner, below, corner + 1});
+            triangles.push_back({corner + 1, below, below + 1});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937{1234});
+    for (const auto& triangle : triangles)
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+}
+
+/// The positions of every triangle, rotated to start at the smallest one so the winding is kept, in a fixed order.
+std::vector<std::array<float, 9>> getTriangles(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) {
+    std::vector<std::array<float, 9>> triangles;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::array<float, 9> smallest{};
+        for (std::size_t rotation = 0; rotation < 3; rotation++) {
+            std::array<float, 9> triangle{};
+            for (std::size_t corner = 0; corner < 3; corner++) {
+                const auto& position = vertices[indices[i + (corner + rotation) % 3]].position;
+                triangle[corner * 3] = position.x;
+                triangle[corner * 3 + 1] = position.y;
+                triangle[corner * 3 + 2] = position.z;
+            }
+            if (rotation == 0 || triangle < smallest)
+                smallest = triangle;
+        }
+        triangles.push_back(smallest);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+} // namespace
+
+TEST(MeshOptimizer, analyzeVertexCache) {
+    // Two triangles sharing an edge, then one that shares nothing
+    const std::vector<Index> indices{0, 1, 2, 2, 1, 3, 4, 5, 6};
+    const auto statistics = MeshOptimizer::analyzeVertexCache(indices, 7);
+    EXPECT_FLOAT_EQ(statistics.acmr, 7.f / 3.f);
+    EXPECT_FLOAT_EQ(statistics.atvr, 1.f);
+
+    // With a cache of 3, the first vertex falls out before it's used again
+    const auto small = MeshOptimizer::analyzeVertexCache({0, 1, 2, 3, 4, 0}, 5, 3);
+    EXPECT_FLOAT_EQ(small.acmr, 3.f);
+    EXPECT_FLOAT_EQ(small.atvr, 6.f / 5.f);
+
+    EXPECT_FLOAT_EQ(MeshOptimizer::analyzeVertexCache({}, 0).acmr, 0.f);
+}
+
+TEST(MeshOptimizer, optimizeVertexCache) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeShuffledGrid(64, vertices, indices);
+    const auto triangles = getTriangles(vertices, indices);
+    const auto before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+
+    MeshOptimizer::optimizeVertexCache(indices, vertices.size());
+    const auto after = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+    EXPECT_EQ(getTriangles(vertices, indices), triangles);
+    EXPECT_LT(after.acmr, 1.f);
+    EXPECT_LT(after.acmr, before.acmr / 2);
+}
+
+TEST(MeshOptimizer, optimizeOverdraw) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeShuffledGrid(64, vertices, indices);
+    MeshOptimizer::optimizeVertexCache(indices, vertices.size());
+    const auto triangles = getTriangles(vertices, indices);
+    const auto before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+
+    MeshOptimizer::optimizeOverdraw(indices, vertices);
+    const auto after = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+    EXPECT_EQ(getTriangles(vertices, indices), triangles);
+    // Splitting clusters costs some reuse, but not much
+    EXPECT_LT(after.acmr, before.acmr * 1.25f);
+}
+
+TEST(MeshOptimizer, optimizeVertexFetch) {
+    std::vector<Vertex> vertices{
+            Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{2, 0, 0}}, Vertex{{3, 0, 0}}, Vertex{{4, 0, 0}},
+    };
+    std::vector<Index> indices{3, 1, 4, 4, 1, 0};
+    const auto triangles = getTriangles(vertices, indices);
+
+    MeshOptimizer::optimizeVertexFetch(vertices, indices);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2, 2, 1, 3}));
+    ASSERT_EQ(vertices.size(), 4);
+    EXPECT_EQ(vertices[0].position, glm::vec3(3, 0, 0));
+    EXPECT_EQ(getTriangles(vertices, indices), triangles);
+}
+
+TEST(MeshOptimizer, optimize) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeShuffledGrid(16, vertices, indices);
+    // Not used by any triangle
+    vertices.push_back(Vertex{{-1, -1, -1}});
+    const auto triangles = getTriangles(vertices, indices);
+
+    MeshOptimizer::optimize(vertices, indices);
+    EXPECT_EQ(vertices.size(), 17 * 17);
+    EXPECT_EQ(getTriangles(vertices, indices), triangles);
+    EXPECT_LT(MeshOptimizer::analyzeVertexCache(indices, vertices.size()).acmr, 1.f);
+}
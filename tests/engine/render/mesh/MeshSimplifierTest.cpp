@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <render/mesh/MeshSimplifier.h>
+
+using namespace chira;
+
+namespace {
+
+/// A flat grid of squares from (0, 0) to (size, size). With a seam, the vertices in the middle column are
+/// split in two with different UVs.
+void makeGrid(int size, std::vector<Vertex>& vertices, std::vector<Index>& indices, bool seam = false) {
+    const auto columns = size + 1 + (seam ? 1 : 0);
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            vertices.push_back(Vertex{{static_cast<float>(x), 0.f, static_cast<float>(y)}, {0, 1, 0}, {0.f, 0.f}});
+            if (seam && x == size / 2)
+                vertices.push_back(Vertex{{static_cast<float>(x), 0.f, static_cast<float>(y)}, {0, 1, 0}, {1.f, 0.f}});
+        }
+    }
+    const auto getIndex = [columns, size, seam](int x, int y, bool right) {
+        return static_cast<Index>(y * columns + x + (seam && (x > size / 2 || (x == size / 2 && right)) ? 1 : 0));
+    };
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const bool right = x >= size / 2;
+            indices.insert(indices.end(), {getIndex(x, y, right), getIndex(x, y + 1, right), getIndex(x + 1, y, right)});
+            indices.insert(indices.end(), {getIndex(x + 1, y, right), getIndex(x, y + 1, right), getIndex(x + 1, y + 1, right)});
+        }
+    }
+}
+
+bool usesPosition(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, glm::vec3 position) {
+    return std::any_of(indices.begin(), indices.end(), [&](Index index) {
+        return vertices[index].position == position;
+    });
+}
+
+} // namespace
+
+TEST(MeshSimplifier, keepsMeshesAtTarget) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(2, vertices, indices);
+    float error = -1.f;
+    EXPECT_EQ(MeshSimplifier::simplify(vertices, indices, indices.size(), 1.f, &error), indices);
+    EXPECT_EQ(error, 0.f);
+}
+
+TEST(MeshSimplifier, simplifyPlane) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(16, vertices, indices);
+    float error = -1.f;
+    const auto simplified = MeshSimplifier::simplify(vertices, indices, 24, 0.001f, &error);
+    EXPECT_LE(simplified.size(), 24);
+    EXPECT_GT(simplified.size(), 0);
+    EXPECT_LT(error, 0.001f);
+    EXPECT_EQ(simplified.size() % 3, 0);
+
+    // The corners can't move without changing the outline
+    EXPECT_TRUE(usesPosition(vertices, simplified, {0, 0, 0}));
+    EXPECT_TRUE(usesPosition(vertices, simplified, {16, 0, 0}));
+    EXPECT_TRUE(usesPosition(vertices, simplified, {0, 0, 16}));
+    EXPECT_TRUE(usesPosition(vertices, simplified, {16, 0, 16}));
+    // Nothing flipped over
+    for (std::size_t i = 0; i < simplified.size(); i += 3) {
+        const auto& p0 = vertices[simplified[i]].position;
+        const auto normal = glm::cross(vertices[simplified[i + 1]].position - p0, vertices[simplified[i + 2]].position - p0);
+        EXPECT_GT(normal.y, 0.f);
+    }
+}
+
+TEST(MeshSimplifier, keepsSeams) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(8, vertices, indices, true);
+    const auto simplified = MeshSimplifier::simplify(vertices, indices, 0, 0.001f);
+    EXPECT_LT(simplified.size(), indices.size() / 2);
+    for (int y = 0; y <= 8; y++)
+        EXPECT_TRUE(usesPosition(vertices, simplified, {4, 0, static_cast<float>(y)}));
+}
+
+TEST(MeshSimplifier, simplifySphere) {
+    constexpr int rings = 32;
+    constexpr float pi = 3.14159265f;
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    // Without UV seams or pole duplicates, so the whole surface can be simplified
+    vertices.push_back(Vertex{{0, 1, 0}});
+    for (int ring = 1; ring < rings; ring++) {
+        for (int segment = 0; segment < rings; segment++) {
+            const auto theta = pi * static_cast<float>(ring) / rings, phi = 2 * pi * static_cast<float>(segment) / rings;
+            vertices.push_back(Vertex{{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)}});
+        }
+    }
+    vertices.push_back(Vertex{{0, -1, 0}});
+    const auto getIndex = [](int ring, int segment) {
+        return static_cast<Index>(1 + (ring - 1) * rings + segment % rings);
+    };
+    for (int segment = 0; segment < rings; segment++) {
+        indices.insert(indices.end(), {0, getIndex(1, segment + 1), getIndex(1, segment)});
+        for (int ring = 1; ring + 1 < rings; ring++) {
+            indices.insert(indices.end(), {getIndex(ring, segment), getIndex(ring, segment + 1), getIndex(ring + 1, segment)});
+            indices.insert(indices.end(), {getIndex(ring + 1, segment), getIndex(ring, segment + 1), getIndex(ring + 1, segment + 1)});
+        }
+        indices.insert(indices.end(), {getIndex(rings - 1, segment), getIndex(rings - 1, segment + 1), static_cast<Index>(vertices.size() - 1)});
+    }
+
+    float error = 0.f;
+    const auto simplified = MeshSimplifier::simplify(vertices, indices, indices.size() / 4, 1.f, &error);
+    EXPECT_LE(simplified.size(), indices.size() / 4);
+    EXPECT_GT(error, 0.f);
+    EXPECT_LT(error, 0.05f);
+    for (std::size_t i = 0; i < simplified.size(); i += 3) {
+        const auto& p0 = vertices[simplified[i]].position;
+        const auto& p1 = vertices[simplified[i + 1]].position;
+        const auto& p2 = vertices[simplified[i + 2]].position;
+        EXPECT_GT(glm::dot(glm::cross(p1 - p0, p2 - p0), p0 + p1 + p2), 0.f);
+    }
+
+    // Stops before going over the error it was given
+    float limitedError = 0.f;
+    const auto limited = MeshSimplifier::simplify(vertices, indices, 0, error / 2, &limitedError);
+    EXPECT_GT(limited.size(), simplified.size());
+    EXPECT_LE(limitedError, error / 2);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include <render/mesh/VertexWelder.h>
+
+using namespace chira;
+
+TEST(VertexWelder, weldsIdenticalVertices) {
+    VertexWelder welder;
+    std::vector<Vertex> vertices;
+    const Vertex a{{0, 0, 0}, {0, 1, 0}, {0.5f, 0.5f}};
+    const Vertex b{{1, 0, 0}, {0, 1, 0}, {0.5f, 0.5f}};
+
+    EXPECT_EQ(welder.weld(a, vertices), 0);
+    EXPECT_EQ(welder.weld(b, vertices), 1);
+    EXPECT_EQ(welder.weld(a, vertices), 0);
+    EXPECT_EQ(vertices.size(), 2);
+
+    // -0 and 0 compare equal
+    EXPECT_EQ(welder.weld(Vertex{{-0.f, 0, 0}, {0, 1, 0}, {0.5f, 0.5f}}, vertices), 0);
+    // Every component counts, not just the position
+    EXPECT_EQ(welder.weld(Vertex{{0, 0, 0}, {0, 1, 0}, {0.5f, 0.25f}}, vertices), 2);
+}
+
+TEST(VertexWelder, picksUpVerticesAddedDirectly) {
+    VertexWelder welder;
+    std::vector<Vertex> vertices;
+    const Vertex a{{0, 0, 0}};
+    const Vertex b{{1, 0, 0}};
+    welder.weld(a, vertices);
+
+    // Added without looking them up, like duplicates in MeshDataBuilder
+    vertices.push_back(b);
+    vertices.push_back(b);
+    EXPECT_EQ(welder.weld(b, vertices), 1);
+    EXPECT_EQ(vertices.size(), 3);
+
+    // The list was cleared behind its back
+    vertices.clear();
+    EXPECT_EQ(welder.weld(b, vertices), 0);
+    EXPECT_EQ(welder.weld(a, vertices), 1);
+}
+
+TEST(VertexWelder, weldsWithinEpsilon) {
+    VertexWelder welder{0.01f};
+    std::vector<Vertex> vertices;
+    EXPECT_EQ(welder.weld(Vertex{{1.f, 2.f, 3.f}}, vertices), 0);
+    EXPECT_EQ(welder.weld(Vertex{{1.001f, 2.f, 2.999f}}, vertices), 0);
+    EXPECT_EQ(welder.weld(Vertex{{1.1f, 2.f, 3.f}}, vertices), 1);
+    EXPECT_EQ(vertices.size(), 2);
+}
+
+namespace {
+
+/// A grid of squares made of two triangles each, sharing vertices with their neighbours.
+template<typename AddVertex>
+void buildGrid(int size, AddVertex&& addVertex) {
+    const auto vertex = [size](int x, int y) {
+        return Vertex{{static_cast<float>(x), 0.f, static_cast<float>(y)}, {0, 1, 0},
+                      {static_cast<float>(x) / static_cast<float>(size), static_cast<float>(y) / static_cast<float>(size)}};
+    };
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            addVertex(vertex(x, y));
+            addVertex(vertex(x + 1, y));
+            addVertex(vertex(x + 1, y + 1));
+            addVertex(vertex(x + 1, y + 1));
+            addVertex(vertex(x, y + 1));
+            addVertex(vertex(x, y));
+        }
+    }
+}
+
+} // namespace
+
+TEST(VertexWelder, DISABLED_benchmarkGrid) {
+    const auto benchmark = [](std::string_view name, int size, auto&& addVertex) {
+        const auto start = std::chrono::steady_clock::now();
+        buildGrid(size, addVertex);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << " (" << size * size * 2 << " triangles): " << elapsed.count() << " ms\n";
+    };
+
+    for (int size : {32, 64, 128, 256}) {
+        std::vector<Vertex> vertices;
+        std::vector<Index> indices;
+        VertexWelder welder;
+        benchmark("VertexWelder", size, [&](const Vertex& vertex) {
+            indices.push_back(welder.weld(vertex, vertices));
+        });
+        EXPECT_EQ(vertices.size(), static_cast<std::size_t>((size + 1) * (size + 1)));
+
+        // The linear search it replaced takes too long past this
+        if (size > 128)
+            continue;
+        std::vector<Vertex> linearVertices;
+        std::vector<Index> linearIndices;
+        benchmark("Linear search", size, [&](const Vertex& vertex) {
+            if (auto position = std::find(linearVertices.begin(), linearVertices.end(), vertex); position != linearVertices.end()) {
+                linearIndices.push_back(static_cast<Index>(position - linearVertices.begin()));
+            } else {
+                linearIndices.push_back(static_cast<Index>(linearVertices.size()));
+                linearVertices.push_back(vertex);
+            }
+        });
+        EXPECT_EQ(indices, linearIndices);
+    }
+}
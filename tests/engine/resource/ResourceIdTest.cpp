@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <resource/ResourceId.h>
+
+using namespace chira;
+
+TEST(ResourceId, split) {
+    ResourceId id{"file://textures/missing.png"};
+    EXPECT_TRUE(id.isValid());
+    EXPECT_EQ(id.getProvider(), "file");
+    EXPECT_EQ(id.getName(), "textures/missing.png");
+    EXPECT_STREQ(id.getName().data(), "textures/missing.png");
+
+    ResourceId invalid{"textures/missing.png"};
+    EXPECT_FALSE(invalid.isValid());
+    EXPECT_EQ(invalid.getName(), "");
+}
+
+TEST(ResourceId, literal) {
+    constexpr auto id = "file://textures/missing.png"_rid;
+    static_assert(id.getProvider() == "file");
+    static_assert(id.getName() == "textures/missing.png");
+    static_assert(id.getHash() == Hash::xxh64("file://textures/missing.png"));
+    EXPECT_EQ(id, ResourceId{std::string{"file://textures/missing.png"}});
+}
+
+TEST(ResourceId, interning) {
+    std::string first = "file://textures/interned.png";
+    std::string second = first;
+    ResourceId firstId{first}, secondId{second};
+    EXPECT_EQ(firstId, secondId);
+    // Both should view the same interned string, not the strings they were made from
+    EXPECT_EQ(firstId.getString().data(), secondId.getString().data());
+    EXPECT_NE(firstId.getString().data(), first.data());
+}
+
+TEST(ResourceId, DISABLED_benchmarkLookup) {
+    constexpr int RESOURCE_COUNT = 1000;
+    constexpr int LOOKUP_COUNT = 1000000;
+
+    std::vector<std::string> identifiers;
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        identifiers.push_back("file://textures/benchmark/texture_" + std::to_string(i) + ".json");
+    }
+
+    // The old way: split into two strings, then two nested string-keyed maps
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> nested;
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        const auto& identifier = identifiers[i];
+        auto pos = identifier.find(RESOURCE_ID_SEPARATOR);
+        nested[identifier.substr(0, pos)][identifier.substr(pos + RESOURCE_ID_SEPARATOR.length())] = i;
+    }
+    // The new way: one map keyed by pre-hashed identifiers
+    std::unordered_map<ResourceId, int> flat;
+    std::vector<ResourceId> ids;
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        ids.emplace_back(identifiers[i]);
+        flat[ids.back()] = i;
+    }
+
+    auto benchmark = [](std::string_view name, auto&& lookup) {
+        long long sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < LOOKUP_COUNT; i++) {
+            sum += lookup(i % RESOURCE_COUNT);
+        }
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << static_cast<long long>(LOOKUP_COUNT / seconds.count()) << " lookups/s (checksum " << sum << ")\n";
+    };
+    benchmark("split + nested string maps", [&](int i) {
+        const auto& identifier = identifiers[i];
+        auto pos = identifier.find(RESOURCE_ID_SEPARATOR);
+        return nested[identifier.substr(0, pos)][identifier.substr(pos + RESOURCE_ID_SEPARATOR.length())];
+    });
+    benchmark("ResourceId from string", [&](int i) {
+        return flat.find(ResourceId{identifiers[i]})->second;
+    });
+    benchmark("ResourceId held", [&](int i) {
+        return flat.find(ids[i])->second;
+    });
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <TestHelpers.h>
+#include <resource/ResourceLoadProfiler.h>
+#include <resource/StringResource.h>
+
+using namespace chira;
+
+namespace {
+
+/// Loads the resource it names while it compiles.
+class NestingResource : public Resource {
+public:
+    explicit NestingResource(std::string identifier_) : Resource(std::move(identifier_)) {}
+    void compile(const byte buffer[], std::size_t /*bufferLength*/) override {
+        this->child = Resource::getResource<StringResource>(reinterpret_cast<const char*>(buffer));
+    }
+    SharedPointer<StringResource> child;
+};
+
+} // namespace
+
+TEST(ResourceLoadProfiler, attributesNestedLoads) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_load_profiler_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::ofstream{folder / "parent.txt"} << "profile://child.txt";
+    std::ofstream{folder / "child.txt"} << "child";
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "profile"});
+
+    ResourceLoadProfiler::clearRecords();
+    {
+        auto parent = Resource::getResource<NestingResource>("profile://parent.txt");
+
+        const auto records = ResourceLoadProfiler::getRecords();
+        ASSERT_EQ(records.size(), 2);
+        EXPECT_EQ(records[0].identifier, ResourceId{"profile://parent.txt"});
+        EXPECT_EQ(records[0].parent, -1);
+        EXPECT_EQ(records[0].depth, 0);
+        EXPECT_EQ(records[1].identifier, ResourceId{"profile://child.txt"});
+        EXPECT_EQ(records[1].parent, 0);
+        EXPECT_EQ(records[1].depth, 1);
+
+        // The child's time is only counted once
+        EXPECT_DOUBLE_EQ(records[0].children, records[1].total);
+        EXPECT_GE(records[0].total, records[0].read + records[0].children);
+        EXPECT_GE(records[1].compile(), 0.0);
+
+        const auto csv = ResourceLoadProfiler::getReportCSV();
+        EXPECT_EQ(std::count(csv.begin(), csv.end(), '\n'), 3);
+        EXPECT_NE(csv.find("\"profile://child.txt\",0,1,"), std::string::npos);
+        EXPECT_NE(ResourceLoadProfiler::getReportJSON().find("profile://parent.txt"), std::string::npos);
+
+        Resource::removeResource("profile://child.txt");
+        Resource::removeResource("profile://parent.txt");
+    }
+    ResourceLoadProfiler::clearRecords();
+    EXPECT_TRUE(ResourceLoadProfiler::getRecords().empty());
+
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
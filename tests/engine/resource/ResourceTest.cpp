@@ -0,0 +1,421 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <TestHelpers.h>
+#include <config/ConEntry.h>
+#include <resource/BinaryResource.h>
+#include <resource/ResourceLoadProfiler.h>
+#include <resource/StringResource.h>
+
+using namespace chira;
+
+TEST(Resource, getResourceAsync) {
+    PREINIT_ENGINE();
+
+    auto handle = Resource::getResourceAsync<StringResource>("file://string_resource_test.txt");
+    for (int frames = 0; !handle.isReady() && frames < 10000; frames++) {
+        Resource::update();
+    }
+    ASSERT_TRUE(handle.isReady());
+    EXPECT_STREQ(handle.get()->getString().c_str(), "test");
+
+    // Now that it's cached, the handle should be ready immediately
+    auto cached = Resource::getResourceAsync<StringResource>("file://string_resource_test.txt");
+    EXPECT_TRUE(cached.isReady());
+    EXPECT_EQ(cached.get().get(), handle.get().get());
+    Resource::discardAll();
+}
+
+TEST(Resource, getResourceWhileLoadingAsync) {
+    PREINIT_ENGINE();
+
+    auto handle = Resource::getResourceAsync<StringResource>("file://string_resource_test.txt");
+    // Requesting it synchronously should wait for the background load instead of loading it twice
+    auto resource = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_TRUE(handle.isReady());
+    EXPECT_EQ(handle.get().get(), resource.get());
+    EXPECT_STREQ(resource->getString().c_str(), "test");
+    Resource::discardAll();
+}
+
+namespace {
+
+/// Refuses to compile anything saying "corrupt", and falls back to string_resource_test.txt.
+class CorruptibleResource : public Resource {
+public:
+    explicit CorruptibleResource(std::string identifier_) : Resource(std::move(identifier_)) {}
+    void compile(const byte buffer[], std::size_t bufferLength) override {
+        this->contents.assign(reinterpret_cast<const char*>(buffer), bufferLength);
+        // The terminator the buffer is read with is part of the length
+        if (!this->contents.empty() && this->contents.back() == '\0')
+            this->contents.pop_back();
+        if (this->contents == "corrupt")
+            throw std::runtime_error{"corrupt resource"};
+    }
+    [[nodiscard]] bool supportsAsyncCompile() const override {
+        return true;
+    }
+    static void createDefaultResource() {
+        Resource::getDefaultResourceConstructors()[typeHash<CorruptibleResource>()]();
+    }
+    std::string contents;
+private:
+    CHIRA_REGISTER_DEFAULT_RESOURCE(CorruptibleResource, "file://string_resource_test.txt");
+};
+
+} // namespace
+
+TEST(Resource, failedAsyncLoadUsesDefaultResource) {
+    PREINIT_ENGINE();
+    CorruptibleResource::createDefaultResource();
+    ASSERT_TRUE(Resource::hasDefaultResource<CorruptibleResource>());
+    const auto fallback = Resource::getDefaultResource<CorruptibleResource>();
+    EXPECT_EQ(fallback->contents, "test");
+
+    auto handle = Resource::getResourceAsync<CorruptibleResource>("file://corrupt_resource_test.txt");
+    for (int frames = 0; !handle.isReady() && frames < 10000; frames++) {
+        Resource::update();
+    }
+    ASSERT_TRUE(handle.isReady());
+    EXPECT_EQ(handle.get().get(), fallback.get());
+    EXPECT_EQ(handle.wait().get(), fallback.get());
+
+    // Waiting on a load that hasn't finished yet gives the same result
+    auto waited = Resource::getResourceAsync<CorruptibleResource>("file://corrupt_resource_test.txt");
+    EXPECT_EQ(waited.wait().get(), fallback.get());
+
+    // Files that don't exist aren't loaded at all
+    auto missing = Resource::getResourceAsync<CorruptibleResource>("file://missing_resource_test.txt");
+    EXPECT_TRUE(missing.isReady());
+    EXPECT_EQ(missing.get().get(), fallback.get());
+    Resource::discardAll();
+}
+
+namespace {
+
+/// Holds the contents of the resource it names, and counts how often it was compiled.
+class ForwardingResource : public Resource {
+public:
+    explicit ForwardingResource(std::string identifier_) : Resource(std::move(identifier_)) {}
+    void compile(const byte buffer[], std::size_t /*bufferLength*/) override {
+        this->child = Resource::getResource<StringResource>(reinterpret_cast<const char*>(buffer));
+        this->contents = this->child->getString();
+        this->compileCount++;
+    }
+    SharedPointer<StringResource> child;
+    std::string contents;
+    int compileCount = 0;
+};
+
+} // namespace
+
+TEST(Resource, hotReloadDependents) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_hot_reload_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::ofstream{folder / "parent.txt"} << "reload://child.txt";
+    std::ofstream{folder / "child.txt"} << "before";
+    std::ofstream{folder / "unrelated.txt"} << "unrelated";
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "reload"});
+
+    {
+        auto parent = Resource::getResource<ForwardingResource>("reload://parent.txt");
+        auto* child = parent->child.get();
+        EXPECT_STREQ(parent->contents.c_str(), "before");
+        ASSERT_EQ(Resource::getResourceDependents("reload://child.txt").size(), 1);
+        EXPECT_EQ(Resource::getResourceDependents("reload://child.txt")[0], ResourceId{"reload://parent.txt"});
+
+        // Changing something nothing depends on shouldn't recompile anything
+        std::ofstream{folder / "unrelated.txt"} << "changed";
+        Resource::update();
+        EXPECT_EQ(parent->compileCount, 1);
+
+        // The child is recompiled in place, then the parent picks up the new contents
+        std::ofstream{folder / "child.txt"} << "after";
+        Resource::reloadResource("reload://child.txt");
+        Resource::update();
+        EXPECT_EQ(parent->child.get(), child);
+        EXPECT_STREQ(parent->child->getString().c_str(), "after");
+        EXPECT_STREQ(parent->contents.c_str(), "after");
+        EXPECT_EQ(parent->compileCount, 2);
+
+        Resource::removeResource("reload://child.txt");
+        Resource::removeResource("reload://parent.txt");
+    }
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+TEST(Resource, evictLeastRecentlyUsed) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_eviction_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    for (const auto* name : {"a.bin", "b.bin", "c.bin"}) {
+        std::ofstream{folder / name} << std::string(1023, 'x');
+    }
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "evict"});
+
+    auto held = Resource::getResource<BinaryResource>("evict://b.bin");
+    Resource::precacheResource<BinaryResource>("evict://a.bin");
+    Resource::precacheResource<BinaryResource>("evict://c.bin");
+    // Nothing holds a or c anymore, but they stay cached
+    EXPECT_EQ(Resource::getCachedMemoryUsage().cpu, 3 * 1024);
+    // Use c so a is the least recently used
+    const auto* c = Resource::getResource<BinaryResource>("evict://c.bin").get();
+
+    Resource::evictUnusedResources(2 * 1024);
+    EXPECT_EQ(Resource::getCachedMemoryUsage().cpu, 2 * 1024);
+    EXPECT_EQ(Resource::getResource<BinaryResource>("evict://c.bin").get(), c);
+
+    // Held resources are never evicted
+    Resource::evictUnusedResources(0);
+    EXPECT_EQ(Resource::getCachedMemoryUsage().cpu, 1024);
+    EXPECT_EQ(held->getBufferLength(), 1023);
+
+    // Removed resources stop counting towards the cache even while something still holds them
+    Resource::removeResource("evict://b.bin");
+    Resource::cleanup();
+    EXPECT_EQ(Resource::getCachedMemoryUsage().cpu, 0);
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+namespace {
+
+/// Requests the resource it names while compiling, and can be constructed from a manifest.
+class ManifestParentResource : public Resource {
+public:
+    explicit ManifestParentResource(std::string identifier_) : Resource(std::move(identifier_)) {}
+    void compile(const byte buffer[], std::size_t /*bufferLength*/) override {
+        this->child = Resource::getResource<StringResource>(reinterpret_cast<const char*>(buffer));
+    }
+    SharedPointer<StringResource> child;
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(ManifestParentResource);
+};
+
+} // namespace
+
+TEST(Resource, precacheManifest) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_manifest_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::ofstream{folder / "parent.txt"} << "manifest://child.txt";
+    std::ofstream{folder / "child.txt"} << "child";
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "manifest"});
+
+    Resource::startRecordingManifest();
+    {
+        auto parent = Resource::getResource<ManifestParentResource>("manifest://parent.txt");
+        EXPECT_STREQ(parent->child->getString().c_str(), "child");
+        Resource::removeResource("manifest://child.txt");
+        Resource::removeResource("manifest://parent.txt");
+    }
+    ASSERT_TRUE(Resource::saveManifest((folder / "level.json").string()));
+    // Picks up the new manifest file
+    Resource::update();
+    Resource::cleanup();
+    Resource::evictUnusedResources(0);
+    ASSERT_EQ(Resource::getCachedMemoryUsage().cpu, 0);
+
+    ResourceLoadProfiler::clearRecords();
+    ASSERT_TRUE(Resource::precacheManifest("manifest://level.json"));
+    // The child was recorded first, so it was compiled on its own before the parent asked for it
+    const auto records = ResourceLoadProfiler::getRecords();
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].identifier, ResourceId{"manifest://child.txt"});
+    EXPECT_EQ(records[1].identifier, ResourceId{"manifest://parent.txt"});
+    EXPECT_EQ(records[1].children, 0.0);
+
+    {
+        auto parent = Resource::getResource<ManifestParentResource>("manifest://parent.txt");
+        EXPECT_STREQ(parent->child->getString().c_str(), "child");
+        EXPECT_EQ(ResourceLoadProfiler::getRecords().size(), 2);
+        Resource::removeResource("manifest://child.txt");
+        Resource::removeResource("manifest://parent.txt");
+    }
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+namespace {
+
+/// Takes a constructor parameter, so a manifest can only prefetch it.
+class ParameterizedResource : public Resource {
+public:
+    ParameterizedResource(std::string identifier_, int repeat_) : Resource(std::move(identifier_)), repeat(repeat_) {}
+    void compile(const byte buffer[], std::size_t /*bufferLength*/) override {
+        for (int i = 0; i < this->repeat; i++)
+            this->contents += reinterpret_cast<const char*>(buffer);
+    }
+    int repeat;
+    std::string contents;
+};
+
+} // namespace
+
+TEST(Resource, precacheManifestKeepsPrefetchedReads) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_manifest_prefetch_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    for (const auto* name : {"claimed.txt", "kept.txt", "dropped.txt"}) {
+        std::ofstream{folder / name} << "text";
+    }
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "prefetch"});
+
+    Resource::startRecordingManifest();
+    for (const auto* identifier : {"prefetch://claimed.txt", "prefetch://kept.txt", "prefetch://dropped.txt"}) {
+        EXPECT_STREQ(Resource::getResource<ParameterizedResource>(identifier, 2)->contents.c_str(), "texttext");
+        Resource::removeResource(identifier);
+    }
+    ASSERT_TRUE(Resource::saveManifest((folder / "level.json").string()));
+    // Picks up the new manifest file
+    Resource::update();
+    Resource::cleanup();
+
+    // None of them can be compiled by the manifest, but all of them are read, and survive the next update()
+    ASSERT_TRUE(Resource::precacheManifest("prefetch://level.json"));
+    Resource::update();
+    EXPECT_STREQ(Resource::getResource<ParameterizedResource>("prefetch://claimed.txt", 2)->contents.c_str(), "texttext");
+    EXPECT_FALSE(Resource::takePrefetchedBuffer("prefetch://claimed.txt"));
+    const auto kept = Resource::takePrefetchedBuffer("prefetch://kept.txt");
+    ASSERT_TRUE(kept);
+    EXPECT_STREQ(reinterpret_cast<const char*>(kept->data()), "text");
+
+    // Whatever nothing claimed by the end of the frame is dropped
+    Resource::update();
+    EXPECT_FALSE(Resource::takePrefetchedBuffer("prefetch://dropped.txt"));
+
+    Resource::removeResource("prefetch://claimed.txt");
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+TEST(Resource, removedResourceStaysShared) {
+    PREINIT_ENGINE();
+
+    auto held = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    Resource::removeResource("file://string_resource_test.txt");
+    Resource::cleanup();
+    // Only the handle holds it now
+    EXPECT_EQ(held.useCount(), 1);
+
+    // Still alive, so it's handed out again instead of being loaded twice
+    auto again = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_EQ(again.get(), held.get());
+    EXPECT_EQ(held.useCount(), 3);
+
+    Resource::removeResource("file://string_resource_test.txt");
+    Resource::discardAll();
+}
+
+TEST(Resource, collectGarbageWithinBudget) {
+    PREINIT_ENGINE();
+
+    auto* cached = Resource::getResource<StringResource>("file://string_resource_test.txt").get();
+    Resource::removeResource("file://string_resource_test.txt");
+    // Lookups don't collect anything, it's still cached until the end of the frame
+    EXPECT_EQ(Resource::getResource<StringResource>("file://string_resource_test.txt").get(), cached);
+
+    int destroyed = 0;
+    for (int i = 0; i < 3; i++) {
+        Resource::deferDestruction([&destroyed] {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            destroyed++;
+        });
+    }
+    // Each destruction takes longer than the default budget, so every frame only gets through one of them
+    Resource::collectGarbage();
+    EXPECT_EQ(destroyed, 1);
+    Resource::collectGarbage();
+    EXPECT_EQ(destroyed, 2);
+    Resource::cleanup();
+    EXPECT_EQ(destroyed, 3);
+
+    Resource::discardAll();
+}
+
+TEST(Resource, missingResourcesAreRemembered) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_missing_test";
+    const auto otherFolder = std::filesystem::temp_directory_path() / "chira_missing_test_other";
+    for (const auto& path : {folder, otherFolder}) {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "missing"});
+
+    for (int i = 0; i < 5; i++) {
+        EXPECT_FALSE(Resource::getResource<StringResource>("missing://a.txt"));
+    }
+    EXPECT_EQ(Resource::getErrorCount("missing://a.txt"), 5);
+
+    // Not looked up again until the watcher says it was added
+    std::ofstream{folder / "a.txt"} << "a";
+    EXPECT_FALSE(Resource::hasResource("missing://a.txt"));
+    Resource::update();
+    EXPECT_TRUE(Resource::hasResource("missing://a.txt"));
+    EXPECT_EQ(Resource::getErrorCount("missing://a.txt"), 0);
+
+    // Or until another provider is added under the same name
+    EXPECT_FALSE(Resource::hasResource("missing://b.txt"));
+    std::ofstream{otherFolder / "b.txt"} << "b";
+    Resource::addResourceProvider(new FilesystemResourceProvider{otherFolder.string(), true, "missing"});
+    EXPECT_STREQ(Resource::getResource<StringResource>("missing://b.txt")->getString().c_str(), "b");
+
+    for (const auto& path : {folder, otherFolder}) {
+        std::filesystem::remove_all(path);
+    }
+    Resource::discardAll();
+}
+
+TEST(Resource, identicalResourcesAreDeduplicated) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_dedup_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::ofstream{folder / "a.txt"} << "same";
+    std::ofstream{folder / "b.txt"} << "same";
+    std::ofstream{folder / "c.txt"} << "different";
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "dedup"});
+    auto* dedup = ConEntryRegistry::getConVar("res_dedup_content");
+    dedup->setValue(true);
+
+    {
+        auto a = Resource::getResource<StringResource>("dedup://a.txt");
+        auto b = Resource::getResource<StringResource>("dedup://b.txt");
+        auto c = Resource::getResource<StringResource>("dedup://c.txt");
+        EXPECT_EQ(a.get(), b.get());
+        EXPECT_NE(a.get(), c.get());
+        EXPECT_EQ(Resource::getResource<StringResource>("dedup://b.txt").get(), a.get());
+        EXPECT_EQ(Resource::getDeduplicatedCount(), 1);
+        EXPECT_EQ(Resource::getDeduplicatedMemoryUsage().total(), a->getMemoryUsage().total());
+    }
+    Resource::discardAll();
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "dedup"});
+
+    dedup->setValue(false);
+    {
+        auto a = Resource::getResource<StringResource>("dedup://a.txt");
+        auto b = Resource::getResource<StringResource>("dedup://b.txt");
+        EXPECT_NE(a.get(), b.get());
+        EXPECT_EQ(Resource::getDeduplicatedCount(), 0);
+    }
+
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <TestHelpers.h>
+#include <resource/BinaryResource.h>
+#include <resource/StringResource.h>
+#include <resource/provider/ArchiveResourceProvider.h>
+#include <utility/Compression.h>
+
+using namespace chira;
+
+class ArchiveResourceProviderTest : public testing::Test {
+protected:
+    void SetUp() override {
+        this->folder = std::filesystem::temp_directory_path() / "chira_archive_test";
+        std::filesystem::create_directories(this->folder / "input" / "nested");
+        {
+            std::ofstream file{this->folder / "input" / "string_resource_test.txt", std::ios::binary};
+            file << "archived";
+        }
+        {
+            std::ofstream file{this->folder / "input" / "nested" / "repetitive.txt", std::ios::binary};
+            for (int i = 0; i < 4096; i++)
+                file << "line " << i % 16 << '\n';
+        }
+        {
+            std::ofstream file{this->folder / "input" / "empty.bin", std::ios::binary};
+        }
+        this->archive = this->folder / "test.cpak";
+    }
+
+    void TearDown() override {
+        Resource::discardAll();
+        std::filesystem::remove_all(this->folder);
+    }
+
+    std::filesystem::path folder;
+    std::filesystem::path archive;
+};
+
+TEST_F(ArchiveResourceProviderTest, readEntries) {
+    ASSERT_TRUE(ArchiveResourceProvider::packFolder(this->folder / "input", this->archive));
+    ArchiveResourceProvider provider{this->archive.string(), "archive"};
+    ASSERT_TRUE(provider.isValid());
+    EXPECT_EQ(provider.getEntryCount(), 3);
+
+    EXPECT_TRUE(provider.hasResource("string_resource_test.txt"));
+    EXPECT_TRUE(provider.hasResource("nested/repetitive.txt"));
+    EXPECT_FALSE(provider.hasResource("nested"));
+    EXPECT_FALSE(provider.hasResource("missing.txt"));
+
+    auto text = provider.readResource("string_resource_test.txt");
+    ASSERT_EQ(text.size(), 9);
+    EXPECT_STREQ(reinterpret_cast<const char*>(text.data()), "archived");
+
+    auto repetitive = provider.readResource("nested/repetitive.txt");
+    EXPECT_EQ(repetitive.data()[repetitive.size() - 1], '\0');
+    EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(repetitive.data()), 14), "line 0\nline 1\n");
+    EXPECT_LT(std::filesystem::file_size(this->archive), repetitive.size() / 4);
+
+    auto empty = provider.readResource("empty.bin");
+    ASSERT_EQ(empty.size(), 1);
+    EXPECT_EQ(empty.data()[0], '\0');
+}
+
+TEST_F(ArchiveResourceProviderTest, uncompressedMatchesCompressed) {
+    ASSERT_TRUE(ArchiveResourceProvider::packFolder(this->folder / "input", this->archive, false));
+    ArchiveResourceProvider provider{this->archive.string(), "archive"};
+    ASSERT_TRUE(provider.isValid());
+    auto repetitive = provider.readResource("nested/repetitive.txt");
+    EXPECT_GT(std::filesystem::file_size(this->archive), repetitive.size());
+    EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(repetitive.data()), 14), "line 0\nline 1\n");
+}
+
+TEST_F(ArchiveResourceProviderTest, overridesLooseFiles) {
+    PREINIT_ENGINE();
+    ASSERT_TRUE(ArchiveResourceProvider::packFolder(this->folder / "input", this->archive));
+
+    // Mounted after the loose files, so it takes priority for anything it contains
+    Resource::addResourceProvider(new ArchiveResourceProvider{this->archive.string()});
+    auto archived = Resource::getUniqueUncachedResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_STREQ(archived->getString().c_str(), "archived");
+    auto nested = Resource::getUniqueUncachedResource<BinaryResource>("file://nested/repetitive.txt");
+    EXPECT_EQ(nested->getBufferLength(), std::filesystem::file_size(this->folder / "input" / "nested" / "repetitive.txt"));
+}
+
+TEST_F(ArchiveResourceProviderTest, invalidArchive) {
+    {
+        std::ofstream file{this->archive, std::ios::binary};
+        file << "definitely not an archive, but long enough to have a header";
+    }
+    ArchiveResourceProvider provider{this->archive.string(), "archive"};
+    EXPECT_FALSE(provider.isValid());
+    EXPECT_FALSE(provider.hasResource("string_resource_test.txt"));
+
+    ArchiveResourceProvider missing{(this->folder / "missing.cpak").string(), "archive"};
+    EXPECT_FALSE(missing.isValid());
+}
+
+TEST_F(ArchiveResourceProviderTest, dropsEntriesWithBadSizes) {
+    for (bool compress : {true, false}) {
+        ASSERT_TRUE(ArchiveResourceProvider::packFolder(this->folder / "input", this->archive, compress));
+        {
+            // Uncompressed entries can't grow, and compressed entries can't claim more than decompression can produce
+            std::fstream file{this->archive, std::ios::binary | std::ios::in | std::ios::out};
+            for (std::uint32_t i = 0; i < 3; i++) {
+                const auto entryOffset = static_cast<std::streamoff>(sizeof(ArchiveHeader) + i * sizeof(ArchiveEntry));
+                ArchiveEntry entry;
+                file.seekg(entryOffset);
+                file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+                entry.size = entry.storedSize * Compression::MAX_EXPANSION + 1;
+                file.seekp(entryOffset);
+                file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            }
+        }
+        ArchiveResourceProvider provider{this->archive.string(), "archive"};
+        ASSERT_TRUE(provider.isValid());
+        EXPECT_EQ(provider.getEntryCount(), 0);
+        EXPECT_FALSE(provider.hasResource("nested/repetitive.txt"));
+    }
+}
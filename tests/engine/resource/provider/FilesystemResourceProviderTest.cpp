@@ -1,10 +1,26 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
 #include <TestHelpers.h>
+#include <core/Platform.h>
+#include <resource/BinaryResource.h>
 #include <resource/StringResource.h>
 
+#ifdef CHIRA_PLATFORM_LINUX
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 using namespace chira;
 
+
 TEST(FilesystemResourceProvider, getStringResource) {
     PREINIT_ENGINE();
 
@@ -28,3 +44,195 @@ TEST(FilesystemResourceProvider, getResourceIdentifier) {
     auto path4 = FilesystemResourceProvider::getResourceIdentifier("/this/is/not/a/valid/path/file.txt");
     EXPECT_STREQ(path4.c_str(), "");
 }
+
+TEST(FilesystemResourceProvider, getMappedBinaryResource) {
+    PREINIT_ENGINE();
+
+    // One size that ends mid-page and one that ends exactly on a page boundary
+    const auto folder = std::filesystem::temp_directory_path() / "chira_mapped_resource_test";
+    std::filesystem::create_directories(folder);
+    for (std::size_t size : {FILESYSTEM_MAP_THRESHOLD + 123, FILESYSTEM_MAP_THRESHOLD * 2}) {
+        {
+            std::ofstream file{folder / "large.bin", std::ios::binary | std::ios::trunc};
+            for (std::size_t i = 0; i < size; i++) {
+                file.put(static_cast<char>('a' + i % 26));
+            }
+        }
+        Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "mapped"});
+
+        auto buffer = Resource::getLatestResourceProvider("mapped")->readResource("large.bin");
+        ASSERT_EQ(buffer.size(), size + 1);
+        EXPECT_EQ(buffer.data()[0], 'a');
+        EXPECT_EQ(buffer.data()[size - 1], 'a' + (size - 1) % 26);
+        EXPECT_EQ(buffer.data()[size], '\0');
+        // Loose files can be rewritten while mapped, so nothing should hold onto the mapping itself
+        EXPECT_TRUE(buffer.isVolatile());
+        const auto kept = buffer.keep();
+        EXPECT_FALSE(kept.isVolatile());
+        EXPECT_NE(kept.data(), buffer.data());
+        EXPECT_EQ(kept.size(), buffer.size());
+
+        auto binary = Resource::getUniqueUncachedResource<BinaryResource>("mapped://large.bin");
+        ASSERT_EQ(binary->getBufferLength(), size);
+        EXPECT_EQ(binary->getBuffer()[size - 1], 'a' + (size - 1) % 26);
+    }
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+TEST(FilesystemResourceProvider, indexTracksChanges) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_index_resource_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder / "nested");
+    std::ofstream{folder / "nested" / "existing.txt"} << "existing";
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "indexed"});
+
+    EXPECT_TRUE(Resource::hasResource("indexed://nested/existing.txt"));
+    EXPECT_FALSE(Resource::hasResource("indexed://nested"));
+    EXPECT_FALSE(Resource::hasResource("indexed://added.txt"));
+
+    std::ofstream{folder / "added.txt"} << "added";
+    std::filesystem::create_directories(folder / "new_folder");
+    std::ofstream{folder / "new_folder" / "inside.txt"} << "inside";
+    std::filesystem::remove_all(folder / "nested");
+    Resource::update();
+
+    EXPECT_TRUE(Resource::hasResource("indexed://added.txt"));
+    EXPECT_TRUE(Resource::hasResource("indexed://new_folder/inside.txt"));
+    // Without a watcher the index never forgets files, it only falls back to the disk on a miss
+    if (assert_cast<FilesystemResourceProvider*>(Resource::getLatestResourceProvider("indexed"))->hasResource("nested/existing.txt"))
+        GTEST_SKIP() << "No filesystem watcher on this platform";
+    EXPECT_FALSE(Resource::hasResource("indexed://nested/existing.txt"));
+
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+TEST(FilesystemResourceProvider, renameOverFileIsModified) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_rename_resource_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::ofstream{folder / "existing.txt"} << "before";
+    FilesystemResourceProvider provider{folder.string(), true, "renamed"};
+
+    // How most editors save: write a temporary file, then rename it over the original
+    std::ofstream{folder / "existing.txt.tmp"} << "after";
+    std::filesystem::rename(folder / "existing.txt.tmp", folder / "existing.txt");
+    std::vector<std::pair<std::string, ResourceChange>> changes;
+    provider.pollChanges([&changes](std::string_view name, ResourceChange change) {
+        changes.emplace_back(name, change);
+    });
+    if (changes.empty())
+        GTEST_SKIP() << "No filesystem watcher on this platform";
+
+    EXPECT_NE(std::find(changes.begin(), changes.end(), std::pair<std::string, ResourceChange>{"existing.txt", ResourceChange::MODIFIED}), changes.end());
+    EXPECT_TRUE(provider.hasResource("existing.txt"));
+    EXPECT_FALSE(provider.hasResource("existing.txt.tmp"));
+
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+TEST(FilesystemResourceProvider, readResourcesInBatch) {
+    PREINIT_ENGINE();
+
+    const auto folder = std::filesystem::temp_directory_path() / "chira_batch_resource_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::ofstream{folder / "a.txt"} << "a";
+    std::ofstream{folder / "b.txt"} << "bb";
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "batch"});
+
+    std::vector<std::promise<ResourceBuffer>> reads(3);
+    Resource::getLatestResourceProvider("batch")->readResources({"a.txt", "missing.txt", "b.txt"}, [&reads](std::size_t index, ResourceBuffer buffer, std::exception_ptr error) {
+        if (error)
+            reads[index].set_exception(error);
+        else
+            reads[index].set_value(std::move(buffer));
+    });
+    EXPECT_STREQ(reinterpret_cast<const char*>(reads[0].get_future().get().data()), "a");
+    EXPECT_THROW(reads[1].get_future().get(), std::filesystem::filesystem_error);
+    EXPECT_STREQ(reinterpret_cast<const char*>(reads[2].get_future().get().data()), "bb");
+
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+#ifdef CHIRA_PLATFORM_LINUX
+
+namespace {
+
+/// Written to so the reads aren't optimized out
+const void* volatile benchmarkSink = nullptr;
+
+} // namespace
+
+TEST(FilesystemResourceProvider, DISABLED_benchmarkBatchRead) {
+    PREINIT_ENGINE();
+
+    // Roughly what a level precaches: lots of small JSON files and some textures
+    constexpr int FILE_COUNT = 500;
+    const auto folder = std::filesystem::temp_directory_path() / "chira_batch_read_benchmark";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::vector<std::string> names;
+    for (int i = 0; i < FILE_COUNT; i++) {
+        names.push_back(std::to_string(i) + ".bin");
+        std::ofstream file{folder / names.back(), std::ios::binary};
+        file << std::string(i % 10 == 0 ? 48 * 1024 : 2 * 1024, static_cast<char>('a' + i % 26));
+    }
+    Resource::addResourceProvider(new FilesystemResourceProvider{folder.string(), true, "benchmark"});
+    const auto* provider = assert_cast<FilesystemResourceProvider*>(Resource::getLatestResourceProvider("benchmark"));
+
+    auto evictFromPageCache = [&folder, &names] {
+        for (const auto& name : names) {
+            const int fd = open((folder / name).c_str(), O_RDONLY);
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    };
+    auto benchmark = [&evictFromPageCache](std::string_view name, auto&& readAll) {
+        evictFromPageCache();
+        const auto start = std::chrono::steady_clock::now();
+        readAll();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << elapsed.count() << " ms\n";
+    };
+    auto readBatch = [&names](auto&& startBatch) {
+        std::vector<std::promise<ResourceBuffer>> reads(names.size());
+        startBatch(names, [&reads](std::size_t index, ResourceBuffer buffer, std::exception_ptr /*error*/) {
+            reads[index].set_value(std::move(buffer));
+        });
+        for (auto& read : reads) {
+            read.get_future().wait();
+        }
+    };
+
+    for (int run = 0; run < 3; run++) {
+        benchmark("Serial readResource", [provider, &names] {
+            for (const auto& name : names) {
+                benchmarkSink = provider->readResource(name).data();
+            }
+        });
+        benchmark("Loader thread per file", [provider, &readBatch] {
+            readBatch([provider](std::vector<std::string> batch, ResourceReadCallback callback) {
+                provider->IResourceProvider::readResources(std::move(batch), std::move(callback));
+            });
+        });
+        benchmark("Batch (io_uring where available)", [provider, &readBatch] {
+            readBatch([provider](std::vector<std::string> batch, ResourceReadCallback callback) {
+                provider->readResources(std::move(batch), std::move(callback));
+            });
+        });
+    }
+
+    std::filesystem::remove_all(folder);
+    Resource::discardAll();
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <utility/BatchFileReader.h>
+
+using namespace chira;
+
+TEST(BatchFileReader, readsEveryFile) {
+    const auto folder = std::filesystem::temp_directory_path() / "chira_batch_read_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+
+    // More files than reads in flight, so slots get reused
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < 10; i++) {
+        paths.push_back(folder / (std::to_string(i) + ".txt"));
+        std::ofstream{paths.back()} << std::string(static_cast<std::size_t>(i) * 1000, static_cast<char>('a' + i));
+    }
+    paths.push_back(folder / "missing.txt");
+
+    BatchFileReader reader{2};
+    std::vector<int> calls(paths.size(), 0);
+    reader.read(paths, [&calls](std::size_t index, std::vector<byte> contents, std::error_code error) {
+        calls[index]++;
+        if (index == 10) {
+            EXPECT_TRUE(error);
+            return;
+        }
+        ASSERT_FALSE(error);
+        ASSERT_EQ(contents.size(), index * 1000 + 1);
+        EXPECT_EQ(contents.back(), '\0');
+        if (index > 0) {
+            EXPECT_EQ(contents.front(), 'a' + index);
+            EXPECT_EQ(contents[contents.size() - 2], 'a' + index);
+        }
+    });
+    for (int count : calls) {
+        EXPECT_EQ(count, 1);
+    }
+
+    std::filesystem::remove_all(folder);
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <utility/Compression.h>
+
+using namespace chira;
+
+static void expectRoundTrip(const std::vector<byte>& input) {
+    auto compressed = Compression::compress(input.data(), input.size());
+    std::vector<byte> output(input.size());
+    ASSERT_TRUE(Compression::decompress(compressed.data(), compressed.size(), output.data(), output.size()));
+    EXPECT_EQ(input, output);
+}
+
+TEST(Compression, roundTripEmpty) {
+    expectRoundTrip({});
+}
+
+TEST(Compression, roundTripShort) {
+    std::string text = "tiny";
+    expectRoundTrip({text.begin(), text.end()});
+}
+
+TEST(Compression, roundTripRepetitive) {
+    std::string text;
+    for (int i = 0; i < 1000; i++) {
+        text += "{\"shader\": \"file://shaders/unlit.json\", \"index\": " + std::to_string(i) + "}\n";
+    }
+    std::vector<byte> input{text.begin(), text.end()};
+    EXPECT_LT(Compression::compress(input.data(), input.size()).size(), input.size() / 4);
+    expectRoundTrip(input);
+}
+
+TEST(Compression, roundTripRunsAndNoise) {
+    std::mt19937 random{1234};
+    std::vector<byte> input;
+    for (int block = 0; block < 64; block++) {
+        // Long runs exercise overlapping matches and extended lengths, noise exercises long literals
+        input.insert(input.end(), random() % 600, static_cast<byte>(random()));
+        for (int i = static_cast<int>(random() % 600); i > 0; i--)
+            input.push_back(static_cast<byte>(random()));
+    }
+    expectRoundTrip(input);
+}
+
+TEST(Compression, rejectsMalformedInput) {
+    std::string text = "abcdabcdabcdabcdabcdabcdabcdabcd";
+    auto compressed = Compression::compress(reinterpret_cast<const byte*>(text.data()), text.size());
+    std::vector<byte> output(text.size());
+    // Wrong output size
+    EXPECT_FALSE(Compression::decompress(compressed.data(), compressed.size(), output.data(), output.size() - 1));
+    // Truncated input
+    EXPECT_FALSE(Compression::decompress(compressed.data(), compressed.size() - 3, output.data(), output.size()));
+    // Match offset pointing before the start of the output
+    const byte badOffset[] = {0x10, 'a', 0x09, 0x00, 0x00};
+    EXPECT_FALSE(Compression::decompress(badOffset, sizeof(badOffset), output.data(), 5));
+}
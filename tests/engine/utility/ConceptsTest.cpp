@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <string>
 #include <utility/Concepts.h>
 
 using namespace chira;
@@ -13,3 +14,11 @@ TEST(Concepts, arithmetic) {
     EXPECT_FALSE(CNonArithmetic<int>);
     EXPECT_FALSE(CNonArithmetic<float>);
 }
+
+TEST(Concepts, hashable) {
+    EXPECT_TRUE(CHashable<bool>);
+    EXPECT_TRUE(CHashable<std::string>);
+
+    struct NotHashable {};
+    EXPECT_FALSE(CHashable<NotHashable>);
+}
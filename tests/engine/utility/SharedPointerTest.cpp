@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <utility/SharedPointer.h>
+
+using namespace chira;
+
+namespace {
+
+struct Counted : public ReferenceCounted {
+    explicit Counted(std::atomic<int>* destroyed_ = nullptr) : destroyed(destroyed_) {}
+    ~Counted() override {
+        if (this->destroyed)
+            (*this->destroyed)++;
+    }
+    std::atomic<int>* destroyed;
+    int value = 0;
+};
+
+struct CountedChild : public Counted {
+    using Counted::Counted;
+};
+
+} // namespace
+
+TEST(SharedPointer, sharesOneCount) {
+    std::atomic<int> destroyed = 0;
+    auto* object = new Counted{&destroyed};
+    {
+        SharedPointer<Counted> first{object};
+        EXPECT_EQ(first.useCount(), 1);
+        // The count lives in the object, so wrapping the raw pointer again is fine
+        SharedPointer<Counted> second{object};
+        EXPECT_EQ(first.useCount(), 2);
+        {
+            auto copy = first;
+            auto cast = copy.cast<Counted>(CastType::STATIC_CAST);
+            EXPECT_EQ(first.useCount(), 4);
+        }
+        EXPECT_EQ(first.useCount(), 2);
+    }
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(SharedPointer, assignmentReleasesPrevious) {
+    std::atomic<int> destroyed = 0;
+    SharedPointer<Counted> pointer{new Counted{&destroyed}};
+    pointer = SharedPointer<Counted>{new Counted{&destroyed}};
+    EXPECT_EQ(destroyed, 1);
+    const auto other = SharedPointer<Counted>{new Counted{&destroyed}};
+    pointer = other;
+    EXPECT_EQ(destroyed, 2);
+    EXPECT_EQ(other.useCount(), 2);
+    pointer = pointer;
+    EXPECT_EQ(other.useCount(), 2);
+}
+
+TEST(SharedPointer, castKeepsObjectAlive) {
+    std::atomic<int> destroyed = 0;
+    SharedPointer<Counted> base;
+    {
+        SharedPointer<CountedChild> child{new CountedChild{&destroyed}};
+        base = child.cast<Counted>(CastType::DYNAMIC_CAST);
+    }
+    EXPECT_EQ(destroyed, 0);
+    EXPECT_EQ(base.useCount(), 1);
+    EXPECT_TRUE(base.castDynamic<CountedChild>());
+}
+
+TEST(WeakPointer, expiresWithLastStrongReference) {
+    std::atomic<int> destroyed = 0;
+    WeakPointer<Counted> weak;
+    EXPECT_TRUE(weak.expired());
+    {
+        SharedPointer<Counted> strong{new Counted{&destroyed}};
+        weak = WeakPointer<Counted>{strong};
+        EXPECT_FALSE(weak.expired());
+        // Weak references don't count
+        EXPECT_EQ(strong.useCount(), 1);
+        auto locked = weak.lock();
+        EXPECT_EQ(locked.get(), strong.get());
+        EXPECT_EQ(strong.useCount(), 2);
+    }
+    EXPECT_EQ(destroyed, 1);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.lock());
+}
+
+TEST(SharedPointer, concurrentCopies) {
+    std::atomic<int> destroyed = 0;
+    SharedPointer<Counted> shared{new Counted{&destroyed}};
+    WeakPointer<Counted> weak{shared};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&shared, &weak] {
+            for (int i = 0; i < 20000; i++) {
+                auto copy = shared;
+                auto locked = weak.lock();
+                EXPECT_TRUE(locked);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(shared.useCount(), 1);
+    EXPECT_EQ(destroyed, 0);
+}
+
+TEST(WeakPointer, concurrentLockAndRelease) {
+    // Locking has to either get a live object or nothing, while another thread drops the last reference
+    for (int i = 0; i < 2000; i++) {
+        std::atomic<int> destroyed = 0;
+        auto shared = std::make_unique<SharedPointer<Counted>>(new Counted{&destroyed});
+        WeakPointer<Counted> weak{*shared};
+        std::thread locker{[&weak] {
+            if (auto locked = weak.lock()) {
+                locked->value++;
+            }
+        }};
+        shared.reset();
+        locker.join();
+        EXPECT_EQ(destroyed, 1);
+        EXPECT_TRUE(weak.expired());
+    }
+}
+
+namespace {
+
+/// The previous SharedPointer, reduced to what the benchmark uses: a separately allocated, non-atomic count.
+template<typename T>
+class LegacySharedPointer {
+public:
+    explicit LegacySharedPointer(T* inputPtr) : ptr(inputPtr), refCount(new unsigned int{1}) {}
+    LegacySharedPointer(const LegacySharedPointer& other) : ptr(other.ptr), refCount(other.refCount) {
+        (*this->refCount)++;
+    }
+    LegacySharedPointer& operator=(const LegacySharedPointer&) = delete;
+    ~LegacySharedPointer() {
+        if (--(*this->refCount) == 0) {
+            delete this->ptr;
+            delete this->refCount;
+        }
+    }
+    T* get() const {
+        return this->ptr;
+    }
+private:
+    T* ptr;
+    unsigned int* refCount;
+};
+
+/// Written to so the copies aren't optimized out
+thread_local const void* volatile benchmarkSink = nullptr;
+
+} // namespace
+
+TEST(SharedPointer, DISABLED_benchmarkContention) {
+    constexpr int COPY_COUNT = 2000000;
+
+    auto benchmark = [](std::string_view name, int threadCount, auto&& copy) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back([&copy] {
+                for (int i = 0; i < COPY_COUNT; i++) {
+                    copy();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << " (" << threadCount << " threads): "
+                  << elapsed.count() / (static_cast<double>(COPY_COUNT) * threadCount) << " ns per copy\n";
+    };
+
+    // The old implementation isn't thread-safe, so it can only be measured on one thread
+    LegacySharedPointer<Counted> legacy{new Counted{}};
+    benchmark("Legacy SharedPointer", 1, [&legacy] {
+        LegacySharedPointer<Counted> copy{legacy};
+        benchmarkSink = copy.get();
+    });
+
+    SharedPointer<Counted> intrusive{new Counted{}};
+    auto shared = std::make_shared<Counted>();
+    for (int threadCount : {1, 2, 4, 8}) {
+        benchmark("Intrusive SharedPointer", threadCount, [&intrusive] {
+            auto copy = intrusive;
+            benchmarkSink = copy.get();
+        });
+        benchmark("std::shared_ptr", threadCount, [&shared] {
+            auto copy = shared;
+            benchmarkSink = copy.get();
+        });
+    }
+}
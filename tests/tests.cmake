@@ -2,11 +2,27 @@ list(APPEND CHIRA_TEST_SOURCES
         ${CMAKE_CURRENT_LIST_DIR}/TestHelpers.h
         ${CMAKE_CURRENT_LIST_DIR}/engine/config/ConEntryTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/core/CommandLine.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/loader/mesh/ChiraMeshLoaderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/loader/mesh/OBJMeshLoaderTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/math/GraphTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/backend/ShaderUniformTableTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/backend/UniformBufferSlicesTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/backend/VertexLayoutTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/mesh/MeshOptimizerTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/mesh/MeshSimplifierTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/mesh/VertexWelderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/RenderQueueTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/provider/ArchiveResourceProviderTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/resource/provider/FilesystemResourceProviderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/ResourceIdTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/ResourceLoadProfilerTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/ResourceTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/ui/debug/ConsolePanelTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/BatchFileReaderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/CompressionTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/ConceptsTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/DependencyGraphTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/SharedPointerTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/StringTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/TypeStringTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/UUIDGeneratorTest.cpp)
@@ -1,6 +1,7 @@
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <string>
 
 #include <core/CommandLine.h>
 #include <core/Engine.h>
@@ -20,7 +21,15 @@ CHIRA_SETUP_CLI_TOOL(CMDLTOOL, "1.0",
                      "-s <type>        : Type of the input file (cmdl, obj, etc.)"  "\n"
                      "-t <type>        : Type of the output file (cmdl, obj, etc.)" "\n"
                      "                   The default is cmdl"                       "\n"
-                     "-o <output file> : Destination for the converted file"        "\n");
+                     "-o <output file> : Destination for the converted file"        "\n"
+                     "-q               : Quantize vertices when writing cmdl files" "\n"
+                     "                   (16-bit positions, octahedral normals,"    "\n"
+                     "                   half float UVs and 8-bit colors)"          "\n"
+                     "-l <count>       : Generate up to this many simpler LODs,"    "\n"
+                     "                   each with half the triangles of the last"  "\n"
+                     "                   (only cmdl files can store them)"          "\n"
+                     "-O               : Optimize the mesh for the vertex cache,"   "\n"
+                     "                   overdraw and vertex fetch"                 "\n");
 
 int main(int argc, const char* argv[]) {
     Engine::preinit(argc, argv);
@@ -68,7 +77,10 @@ int main(int argc, const char* argv[]) {
 
     // todo: populate these through some kind of registry
     IMeshLoader::addMeshLoader("obj", new OBJMeshLoader{});
-    IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{});
+    ChiraMeshWriteOptions cmdlOptions;
+    if (CommandLine::has("-q"))
+        cmdlOptions = {true, true, true, true};
+    IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{cmdlOptions});
 
     LOG_CMDLTOOL.info("Attempting to convert mesh file \"{}\"...", inputPath.filename().string());
 
@@ -76,6 +88,19 @@ int main(int argc, const char* argv[]) {
     Resource::addResourceProvider(new FilesystemResourceProvider{inputPath.parent_path().string()});
     mesh.appendMeshData(inputType, FilesystemResourceProvider::getResourceIdentifier(inputPath.string()));
 
+    if (auto lodCount = CommandLine::get("-l"); !lodCount.empty()) {
+        mesh.generateLODs(std::stoul(std::string{lodCount}));
+        for (const auto& lod : mesh.getLODs())
+            LOG_CMDLTOOL.info("LOD with {} triangles, error {:.4f} of the mesh radius", lod.indexCount / 3, lod.error);
+    }
+
+    if (CommandLine::has("-O")) {
+        const auto before = mesh.getVertexCacheStatistics();
+        mesh.optimizeMeshData();
+        const auto after = mesh.getVertexCacheStatistics();
+        LOG_CMDLTOOL.info("Optimized mesh: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", before.acmr, after.acmr, before.atvr, after.atvr);
+    }
+
     std::ofstream file{outputPath.string(), std::ios::binary};
     std::vector<byte> meshData = mesh.getMeshData(outputType);
     file.write(reinterpret_cast<const char*>(meshData.data()), static_cast<std::streamsize>(meshData.size()));
@@ -112,7 +112,8 @@ void ControlsPanel::addResourceFolderSelected() {
 
     bool resourceExists = false;
     for (const auto& fileProvider : Resource::getResourceProviders(FILESYSTEM_PROVIDER_NAME)) {
-        if (resourceFolderPath == assert_cast<FilesystemResourceProvider*>(fileProvider.get())->getFolder()) {
+        auto* filesystemProvider = dynamic_cast<FilesystemResourceProvider*>(fileProvider.get());
+        if (filesystemProvider && resourceFolderPath == filesystemProvider->getFolder()) {
             resourceExists = true;
             break;
         }
@@ -0,0 +1,65 @@
+#include <cstdlib>
+#include <filesystem>
+
+#include <core/CommandLine.h>
+#include <core/Engine.h>
+#include <resource/provider/ArchiveResourceProvider.h>
+
+#include "../ToolHelpers.h"
+
+using namespace chira;
+
+CHIRA_SETUP_CLI_TOOL(PACKTOOL, "1.0",
+                     "Parameters:"                                                     "\n"
+                     "-h                : Display this help message"                   "\n"
+                     "-i <input folder> : Path of the resource folder to pack"         "\n"
+                     "-o <output file>  : Destination for the archive"                 "\n"
+                     "-u                : Store every file uncompressed"               "\n");
+
+int main(int argc, const char* argv[]) {
+    Engine::preinit(argc, argv);
+
+    if (argc == 0) {
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    if (CommandLine::has("-h")) {
+        printHelp();
+        return EXIT_SUCCESS;
+    }
+
+    std::filesystem::path inputPath;
+    if (auto input = CommandLine::get("-i"); !input.empty()) {
+        inputPath = input;
+    } else {
+        LOG_PACKTOOL.error("No input folder provided!\n");
+        printHelp();
+        return EXIT_FAILURE;
+    }
+    if (!std::filesystem::is_directory(inputPath)) {
+        LOG_PACKTOOL.error("Input folder \"{}\" does not exist!\n", inputPath.string());
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path outputPath;
+    if (auto output = CommandLine::get("-o"); !output.empty()) {
+        outputPath = output;
+    } else {
+        LOG_PACKTOOL.error("No output file provided!\n");
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    LOG_PACKTOOL.info("Packing resource folder \"{}\"...", inputPath.string());
+
+    if (!ArchiveResourceProvider::packFolder(inputPath, outputPath, !CommandLine::has("-u"))) {
+        LOG_PACKTOOL.error("Could not write archive to \"{}\"!", outputPath.string());
+        return EXIT_FAILURE;
+    }
+
+    ArchiveResourceProvider archive{outputPath.string()};
+    LOG_PACKTOOL.infoImportant("Packed {} files! Archive written to \"{}\"", archive.getEntryCount(), outputPath.string());
+
+    return EXIT_SUCCESS;
+}